@@ -0,0 +1,94 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * Micro-benchmark that passes PDUs from one producer to one consumer thread
+ * through the mutex-based Buffer and the lock-free SpscBuffer.
+ */
+
+#include <iostream>
+#include <boost/program_options.hpp>
+#include <boost/format.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include "buffer.h"
+#include "spsc_buffer.h"
+#include "pdu.h"
+
+namespace po = boost::program_options;
+using namespace libgdtp;
+
+template<class BufferType>
+double run_benchmark(const uint32_t capacity, const uint32_t num_items)
+{
+    BufferType buffer(capacity);
+    Pdu pdu(std::make_shared<Data>(100, 0xaa));
+
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::local_time();
+    boost::thread consumer([&] {
+        Pdu tmp;
+        for (uint32_t i = 0; i < num_items; i++) {
+            buffer.popFront(tmp);
+        }
+    });
+    for (uint32_t i = 0; i < num_items; i++) {
+        buffer.pushBack(pdu);
+    }
+    consumer.join();
+    boost::posix_time::time_duration duration = boost::posix_time::microsec_clock::local_time() - start;
+
+    return duration.total_nanoseconds() / double(num_items);
+}
+
+
+int main(int argc, char *argv[])
+{
+    uint32_t num_items, capacity, num_runs;
+
+    //setup the program options
+    po::options_description desc("Allowed options");
+    desc.add_options()
+            ("help", "help message")
+            ("num_items", po::value<uint32_t>(&num_items)->default_value(1000000), "number of PDUs to pass through the buffer")
+            ("capacity", po::value<uint32_t>(&capacity)->default_value(10), "buffer capacity")
+            ("num_runs", po::value<uint32_t>(&num_runs)->default_value(3), "number of runs per buffer type")
+            ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    // print the help message
+    if (vm.count("help")) {
+        std::cout << boost::format("Buffer benchmark %s") % desc << std::endl;
+        return ~0;
+    }
+
+    std::cout << boost::format("%-12s %10s %10s") % "buffer" % "capacity" % "ns/PDU" << std::endl;
+    for (uint32_t run = 0; run < num_runs; run++) {
+        std::cout << boost::format("%-12s %10d %10.1f") % "Buffer" % capacity %
+                     run_benchmark<Buffer<Pdu> >(capacity, num_items) << std::endl;
+        std::cout << boost::format("%-12s %10d %10.1f") % "SpscBuffer" % capacity %
+                     run_benchmark<SpscBuffer<Pdu> >(capacity, num_items) << std::endl;
+    }
+
+    return 0;
+}
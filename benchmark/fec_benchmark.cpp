@@ -0,0 +1,209 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * Benchmark of the FEC stage on the simulated lossy channel. SDUs are sent
+ * over a broadcast flow and over a reliable Selective-Repeat flow, without
+ * FEC and with different numbers of repair PDUs per block, for a range of
+ * frame error rates. Reported are the share of SDUs delivered and the
+ * goodput, i.e. the delivered payload bytes per byte sent over the channel
+ * (including repairs and retransmissions). The throughput of the GF(256)
+ * region operation is measured for each implementation the CPU supports.
+ */
+
+#include <iostream>
+#include <chrono>
+#include <boost/program_options.hpp>
+#include <boost/format.hpp>
+#include <boost/thread.hpp>
+#include "libgdtp.h"
+#include "gf256.h"
+#include "../examples/channel.h"
+
+namespace po = boost::program_options;
+using namespace libgdtp;
+
+#define BELOW_PORT_ID 0
+#define UPPER_PORT_ID 1
+#define FEC_DATA_PDUS 8
+
+typedef struct
+{
+    float delivered; ///< share of the SDUs
+    float goodput; ///< delivered payload bytes per channel byte
+    uint32_t rtx_pdus;
+} Result;
+
+
+double run_region_benchmark(const Gf256::Impl impl, const size_t len, const uint32_t num_runs)
+{
+    Data src(len, 0x5a), dst(len, 0);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < num_runs; i++) {
+        Gf256::mul_add_region(dst.data(), src.data(), 2 + i % 250, len, impl);
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return len * double(num_runs) / seconds / 1e6;
+}
+
+
+/**
+ * Pass all frames waiting at a port into the channel.
+ * @return the number of bytes
+ */
+size_t transmit(Gdtp& prot, Channel& channel)
+{
+    size_t num_bytes = 0;
+    Data frame;
+    while (prot.try_get_data_for_below(BELOW_PORT_ID, frame)) {
+        prot.set_data_transmitted(BELOW_PORT_ID);
+        channel.pushBack(frame);
+        num_bytes += frame.size();
+    }
+    return num_bytes;
+}
+
+
+size_t receive(Gdtp& prot, Channel& channel)
+{
+    size_t num_frames = 0;
+    Data frame;
+    while (channel.tryPop(frame)) {
+        prot.handle_data_from_below(BELOW_PORT_ID, frame);
+        num_frames++;
+    }
+    return num_frames;
+}
+
+
+Result run_benchmark(const bool reliable, const uint32_t num_repair, const float fer, const float ack_fer,
+                     const uint32_t num_sdus, const uint32_t sdu_size)
+{
+    Gdtp tx_prot, rx_prot;
+    tx_prot.set_codec_type("binary");
+    tx_prot.set_default_source_address(1);
+    tx_prot.set_default_destination_address(reliable ? 2 : 127);
+    tx_prot.initialize();
+    rx_prot.set_codec_type("binary");
+    rx_prot.set_default_source_address(2);
+    rx_prot.set_default_destination_address(1);
+    rx_prot.initialize();
+
+    FlowProperties props(reliable ? RELIABLE : UNRELIABLE);
+    props.set_arq_type(SELECTIVE_REPEAT);
+    props.set_window_size(16);
+    props.set_ack_timeout(20);
+    props.set_max_retransmissions(100);
+    if (num_repair > 0)
+        props.set_fec(FEC_DATA_PDUS, num_repair);
+    FlowId id = tx_prot.allocate_flow(UPPER_PORT_ID, props);
+    // lets the receiver use FEC from the first block on
+    rx_prot.allocate_flow(UPPER_PORT_ID, props);
+
+    uint32_t received = 0;
+    rx_prot.register_receive_handler(UPPER_PORT_ID, [&received](std::shared_ptr<Data>) {
+        received++;
+    });
+
+    // the feeder blocks while the ARQ buffer is full
+    boost::thread feeder([&tx_prot, id, num_sdus, sdu_size]() {
+        for (uint32_t i = 0; i < num_sdus; i++) {
+            tx_prot.handle_data_from_above(std::make_shared<Data>(sdu_size, i % 256), id);
+        }
+    });
+
+    Channel forward(100000, fer), backward(100000, ack_fer);
+    size_t num_bytes = 0;
+    const boost::system_time end = boost::get_system_time() + boost::posix_time::seconds(60);
+    // a broadcast is done once nothing is left to send, the repairs of the last block come after the FEC delay
+    uint32_t idle_rounds = 0;
+    while (received < num_sdus && boost::get_system_time() < end && (reliable || idle_rounds < 100)) {
+        const size_t sent = transmit(tx_prot, forward);
+        num_bytes += sent;
+        size_t num_frames = sent + receive(rx_prot, forward);
+        num_frames += transmit(rx_prot, backward) + receive(tx_prot, backward);
+        if (num_frames == 0) {
+            idle_rounds++;
+            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+        } else {
+            idle_rounds = 0;
+        }
+    }
+    feeder.join();
+
+    ArqStats tx_stats = tx_prot.get_stats(id).arq;
+    Result result;
+    result.delivered = received / float(num_sdus);
+    result.goodput = num_bytes > 0 ? received * float(sdu_size) / num_bytes : 0;
+    result.rtx_pdus = tx_stats.rtx_pdus;
+    return result;
+}
+
+
+int main(int argc, char *argv[])
+{
+    uint32_t num_sdus, sdu_size;
+    float ack_fer;
+
+    //setup the program options
+    po::options_description desc("Allowed options");
+    desc.add_options()
+            ("help", "help message")
+            ("num_sdus", po::value<uint32_t>(&num_sdus)->default_value(2000), "number of SDUs per run")
+            ("sdu_size", po::value<uint32_t>(&sdu_size)->default_value(500), "size of each SDU")
+            ("ack_fer", po::value<float>(&ack_fer)->default_value(0), "frame error rate of the reverse channel")
+            ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    // print the help message
+    if (vm.count("help")) {
+        std::cout << boost::format("FEC benchmark %s") % desc << std::endl;
+        return ~0;
+    }
+
+    const Gf256::Impl impls[] = { Gf256::SCALAR, Gf256::SSSE3, Gf256::AVX2 };
+    std::cout << boost::format("%-8s %10s") % "GF(256)" % "MB/s" << std::endl;
+    for (auto impl : impls) {
+        if (Gf256::is_supported(impl))
+            std::cout << boost::format("%-8s %10.0f") % Gf256::get_impl_as_string(impl) % run_region_benchmark(impl, 1500, 200000) << std::endl;
+    }
+    std::cout << std::endl;
+
+    const float fers[] = { 0, 0.05, 0.1, 0.2, 0.3 };
+    const uint32_t repairs[] = { 0, 1, 2, 4 };
+    std::cout << boost::format("%-10s %-6s %5s %10s %8s %8s") % "flow" % "FEC" % "FER" % "delivered" % "goodput" % "rtx" << std::endl;
+    for (int reliable = 0; reliable < 2; reliable++) {
+        for (uint32_t num_repair : repairs) {
+            const std::string fec = num_repair > 0 ? (boost::format("%d+%d") % FEC_DATA_PDUS % num_repair).str() : "none";
+            for (float fer : fers) {
+                Result result = run_benchmark(reliable, num_repair, fer, ack_fer, num_sdus, sdu_size);
+                std::cout << boost::format("%-10s %-6s %5.2f %9.1f%% %8.3f %8d")
+                             % (reliable ? "reliable" : "broadcast") % fec % fer
+                             % (100 * result.delivered) % result.goodput % result.rtx_pdus << std::endl;
+            }
+        }
+    }
+
+    return 0;
+}
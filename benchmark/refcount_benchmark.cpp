@@ -0,0 +1,142 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * Benchmark that passes SDUs through a transmitting and a receiving GDTP
+ * instance and reports the time and the number of payload reference count
+ * operations per SDU. The latter are only counted if the library has been
+ * built with -DENABLE_REFCOUNT_STATS=ON.
+ */
+
+#include <iostream>
+#include <boost/program_options.hpp>
+#include <boost/format.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include "libgdtp.h"
+#include "pdu.h"
+
+namespace po = boost::program_options;
+using namespace libgdtp;
+
+#define BELOW_PORT_ID 0
+
+struct Result
+{
+    double ns_per_sdu;
+    double ref_ops_per_sdu;
+};
+
+Result run_benchmark(Gdtp& tx_prot, Gdtp& rx_prot, const FlowId tx_id, const FlowId rx_id,
+                     const bool reliable, const bool move_sdus, const uint32_t num_sdus, const uint32_t sdu_size)
+{
+    const uint64_t ref_ops = Pdu::get_ref_ops();
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::local_time();
+    for (uint32_t i = 0; i < num_sdus; i++) {
+        std::shared_ptr<Data> sdu = std::make_shared<Data>(sdu_size, 0xaa);
+        if (move_sdus) {
+            tx_prot.handle_data_from_above(std::move(sdu), tx_id);
+        } else {
+            tx_prot.handle_data_from_above(sdu, tx_id);
+        }
+
+        Data frame;
+        tx_prot.get_data_for_below(BELOW_PORT_ID, frame);
+        tx_prot.set_data_transmitted(BELOW_PORT_ID);
+        rx_prot.handle_data_from_below(BELOW_PORT_ID, std::make_shared<Data>(std::move(frame)));
+
+        if (reliable) {
+            Data ack;
+            rx_prot.get_data_for_below(BELOW_PORT_ID, ack);
+            rx_prot.set_data_transmitted(BELOW_PORT_ID);
+            tx_prot.handle_data_from_below(BELOW_PORT_ID, ack);
+        }
+        rx_prot.get_data_for_above(rx_id);
+    }
+    boost::posix_time::time_duration duration = boost::posix_time::microsec_clock::local_time() - start;
+
+    Result result;
+    result.ns_per_sdu = duration.total_nanoseconds() / double(num_sdus);
+    result.ref_ops_per_sdu = (Pdu::get_ref_ops() - ref_ops) / double(num_sdus);
+    return result;
+}
+
+
+int main(int argc, char *argv[])
+{
+    uint32_t num_sdus, sdu_size, num_runs;
+
+    //setup the program options
+    po::options_description desc("Allowed options");
+    desc.add_options()
+            ("help", "help message")
+            ("num_sdus", po::value<uint32_t>(&num_sdus)->default_value(100000), "number of SDUs per run")
+            ("sdu_size", po::value<uint32_t>(&sdu_size)->default_value(100), "size of each SDU")
+            ("num_runs", po::value<uint32_t>(&num_runs)->default_value(3), "number of runs per mode")
+            ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    // print the help message
+    if (vm.count("help")) {
+        std::cout << boost::format("Reference count benchmark %s") % desc << std::endl;
+        return ~0;
+    }
+
+    // both instances live for the whole benchmark and carry one flow per mode
+    Gdtp tx_prot;
+    tx_prot.set_codec_type("binary");
+    tx_prot.set_default_source_address(1);
+    tx_prot.set_default_destination_address(2);
+    tx_prot.initialize();
+
+    Gdtp rx_prot;
+    rx_prot.set_codec_type("binary");
+    rx_prot.set_default_source_address(2);
+    rx_prot.set_default_destination_address(1);
+    rx_prot.initialize();
+
+    const FlowId UNRELIABLE_ID = 1, RELIABLE_ID = 2;
+    FlowProperties unreliable(UNRELIABLE);
+    FlowProperties reliable(RELIABLE);
+    FlowId unreliable_id = tx_prot.allocate_flow(UNRELIABLE_ID, unreliable);
+    FlowId reliable_id = tx_prot.allocate_flow(RELIABLE_ID, reliable);
+    rx_prot.allocate_flow(UNRELIABLE_ID, unreliable);
+    rx_prot.allocate_flow(RELIABLE_ID, reliable);
+
+#ifndef GDTP_COUNT_REF_OPS
+    std::cout << "Reference count operations are not counted, rebuild with -DENABLE_REFCOUNT_STATS=ON." << std::endl;
+#endif
+    std::cout << boost::format("%-12s %-6s %10s %10s") % "flow" % "sdus" % "ns/SDU" % "refops/SDU" << std::endl;
+    for (uint32_t run = 0; run < num_runs; run++) {
+        for (int move = 0; move < 2; move++) {
+            Result r = run_benchmark(tx_prot, rx_prot, unreliable_id, UNRELIABLE_ID, false, move, num_sdus, sdu_size);
+            std::cout << boost::format("%-12s %-6s %10.1f %10.2f") % "unreliable" % (move ? "moved" : "copied") %
+                         r.ns_per_sdu % r.ref_ops_per_sdu << std::endl;
+            r = run_benchmark(tx_prot, rx_prot, reliable_id, RELIABLE_ID, true, move, num_sdus, sdu_size);
+            std::cout << boost::format("%-12s %-6s %10.1f %10.2f") % "reliable" % (move ? "moved" : "copied") %
+                         r.ns_per_sdu % r.ref_ops_per_sdu << std::endl;
+        }
+    }
+
+    return 0;
+}
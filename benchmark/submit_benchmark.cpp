@@ -0,0 +1,115 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * Benchmark that submits SDUs to an unreliable Go-Back-N flow either one by
+ * one or in bursts via handle_data_from_above_batch(). After each burst, the
+ * frames are drained like a lower layer would do. Only the time spent in
+ * the submission calls is reported, per SDU and for different batch sizes.
+ */
+
+#include <iostream>
+#include <chrono>
+#include <boost/program_options.hpp>
+#include <boost/format.hpp>
+#include "libgdtp.h"
+
+namespace po = boost::program_options;
+using namespace libgdtp;
+
+#define BELOW_PORT_ID 0
+#define WINDOW_SIZE 63 // together with the ARQ buffer large enough for a whole burst
+
+
+double run_benchmark(Gdtp& prot, const FlowId id, const uint32_t batch_size, const uint32_t num_sdus, const uint32_t sdu_size)
+{
+    // the calls are timed individually, so use a cheap monotonic clock
+    std::chrono::steady_clock::duration duration(0);
+    std::vector<std::shared_ptr<Data> > batch;
+    Data frame;
+    for (uint32_t i = 0; i < num_sdus; i += batch_size) {
+        const uint32_t num = std::min(batch_size, num_sdus - i);
+        for (uint32_t j = 0; j < num; j++) {
+            batch.push_back(std::make_shared<Data>(sdu_size, 0xaa));
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (batch_size == 1) {
+            prot.handle_data_from_above(std::move(batch.front()), id);
+            batch.clear();
+        } else {
+            prot.handle_data_from_above_batch(std::move(batch), id);
+        }
+        duration += std::chrono::steady_clock::now() - start;
+
+        for (uint32_t j = 0; j < num; j++) {
+            prot.get_data_for_below(BELOW_PORT_ID, frame);
+            prot.set_data_transmitted(BELOW_PORT_ID);
+        }
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() / double(num_sdus);
+}
+
+
+int main(int argc, char *argv[])
+{
+    uint32_t num_sdus, sdu_size, num_runs;
+
+    //setup the program options
+    po::options_description desc("Allowed options");
+    desc.add_options()
+            ("help", "help message")
+            ("num_sdus", po::value<uint32_t>(&num_sdus)->default_value(100000), "number of SDUs per run")
+            ("sdu_size", po::value<uint32_t>(&sdu_size)->default_value(100), "size of each SDU")
+            ("num_runs", po::value<uint32_t>(&num_runs)->default_value(3), "number of runs per batch size")
+            ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    // print the help message
+    if (vm.count("help")) {
+        std::cout << boost::format("Submission benchmark %s") % desc << std::endl;
+        return ~0;
+    }
+
+    Gdtp prot;
+    prot.set_codec_type("binary");
+    prot.set_default_source_address(1);
+    prot.set_default_destination_address(2);
+    prot.initialize();
+
+    FlowProperties props(UNRELIABLE);
+    props.set_arq_type(GO_BACK_N);
+    props.set_window_size(WINDOW_SIZE);
+    FlowId id = prot.allocate_flow(1, props);
+
+    const uint32_t batch_sizes[] = { 1, 8, 64 };
+    std::cout << boost::format("%-6s %10s") % "batch" % "ns/SDU" << std::endl;
+    for (uint32_t run = 0; run < num_runs; run++) {
+        for (uint32_t batch_size : batch_sizes) {
+            std::cout << boost::format("%-6d %10.1f") % batch_size % run_benchmark(prot, id, batch_size, num_sdus, sdu_size) << std::endl;
+        }
+    }
+
+    return 0;
+}
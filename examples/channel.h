@@ -59,6 +59,11 @@ public:
         buffer_.popFront(sdu);
     }
 
+    bool tryPop(Data& sdu)
+    {
+        return buffer_.tryPop(sdu);
+    }
+
 private:
     Buffer<Data> buffer_;
     float fer_;
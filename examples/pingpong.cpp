@@ -115,6 +115,11 @@ int main(int argc, char *argv[])
     uint64_t max_seq_no;
     uint32_t max_num_rtx;
     std::string scheduler;
+    std::string codec;
+    std::string arq;
+    uint32_t window_size;
+    bool adaptive_rto;
+    bool nack;
 
     //setup the program options
     po::options_description desc("Allowed options");
@@ -132,6 +137,11 @@ int main(int argc, char *argv[])
             ("max_seq_no", po::value<uint64_t>(&max_seq_no)->default_value(127), "maximum sequence number")
             ("max_num_rtx", po::value<uint32_t>(&max_num_rtx)->default_value(3), "maximum number of retransmissions")
             ("scheduler", po::value<std::string>(&scheduler)->default_value("fifo"), "scheduler")
+            ("codec", po::value<std::string>(&codec)->default_value("protobuf"), "codec (protobuf or binary)")
+            ("arq", po::value<std::string>(&arq)->default_value("stopwait"), "ARQ type (stopwait, selectiverepeat or gobackn)")
+            ("window_size", po::value<uint32_t>(&window_size)->default_value(8), "ARQ window size")
+            ("adaptive_rto", po::value<bool>(&adaptive_rto)->default_value(false), "Whether to derive the ACK timeout from the measured RTT")
+            ("nack", po::value<bool>(&nack)->default_value(false), "Whether receivers request missing PDUs with NACKs (windowed ARQs only)")
             ;
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -156,18 +166,27 @@ int main(int argc, char *argv[])
                        max_seq_no,
                        TIMEOUT,
                        max_num_rtx);
+    if (arq == "selectiverepeat")
+        props.set_arq_type(SELECTIVE_REPEAT);
+    else if (arq == "gobackn")
+        props.set_arq_type(GO_BACK_N);
+    props.set_window_size(window_size);
+    props.set_adaptive_rto(adaptive_rto);
+    props.set_nack(nack);
 
     // creating protocol instances
     Gdtp node1_prot;
     node1_prot.set_default_source_address(node1_addr);
     node1_prot.set_default_destination_address(node2_addr);
     node1_prot.set_scheduler_type(scheduler);
+    node1_prot.set_codec_type(codec);
     node1_prot.initialize();
 
     Gdtp node2_prot;
     node2_prot.set_default_source_address(node2_addr);
     node2_prot.set_default_destination_address(node1_addr);
     node2_prot.set_scheduler_type(scheduler);
+    node2_prot.set_codec_type(codec);
     node2_prot.initialize();
 
     // create a thread-safe buffer that both lower layer handler can use to exchange data
@@ -0,0 +1,201 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * Stripe a single reliable flow over several emulated channels and measure
+ * the throughput the receiving application sees. Each port has its own
+ * pair of channels and tx thread, the tx thread holds a frame for as long
+ * as the channel needs to send it at the given rate.
+ */
+
+#include <iostream>
+#include "boost/date_time/posix_time/posix_time.hpp"
+#include "boost/thread.hpp"
+#include "boost/format.hpp"
+#include <boost/program_options.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include "libgdtp.h"
+#include "channel.h"
+
+namespace po = boost::program_options;
+using namespace libgdtp;
+
+#define UPPER_PORT 1
+
+void tx_app_handler(Gdtp& prot, const FlowId id, const uint32_t num_tx_frames, const uint32_t sdu_size)
+{
+    for (uint32_t i = 0; i < num_tx_frames; i++) {
+        prot.handle_data_from_above(std::make_shared<Data>(sdu_size, i % 256), id);
+    }
+}
+
+void rx_app_handler(Gdtp& prot, const uint32_t num_rx_frames, bool& in_order)
+{
+    for (uint32_t i = 0; i < num_rx_frames; i++) {
+        std::shared_ptr<Data> data = prot.get_data_for_above(UPPER_PORT);
+        in_order = in_order && (data->at(0) == i % 256);
+    }
+}
+
+void tx_handler(Gdtp& prot, Channel &channel, const PortId id, const uint32_t rate)
+{
+    try
+    {
+        Data frame;
+        while (true) {
+            // this call may block if no frames are present
+            prot.get_data_for_below(id, frame);
+            // occupy the channel as long as the transmission takes
+            boost::this_thread::sleep(boost::posix_time::microseconds(frame.size() * 8 * 1000 / rate));
+            channel.pushBack(frame);
+            prot.set_data_transmitted(id);
+        }
+    }
+    catch(boost::thread_interrupted)
+    {
+    }
+}
+
+void rx_handler(Gdtp& prot, Channel &channel, const PortId id)
+{
+    try
+    {
+        while (true) {
+            Data frame;
+            channel.popFront(frame);
+            prot.handle_data_from_below(id, frame);
+        }
+    }
+    catch(boost::thread_interrupted)
+    {
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t num_ports;
+    uint32_t rate;
+    float fer;
+    std::string mode;
+    uint32_t num_tx_frames;
+    uint32_t sdu_size;
+    uint32_t window_size;
+    uint32_t ack_timeout;
+
+    //setup the program options
+    po::options_description desc("Allowed options");
+    desc.add_options()
+            ("help", "help message")
+            ("ports", po::value<uint32_t>(&num_ports)->default_value(2), "Number of lower layer ports to stripe over")
+            ("rate", po::value<uint32_t>(&rate)->default_value(1000), "Rate of each channel in kbit/s")
+            ("fer", po::value<float>(&fer)->default_value(float(0.0)), "FER of each channel")
+            ("mode", po::value<std::string>(&mode)->default_value("wrr"), "Striping mode (wrr or shortest)")
+            ("num_frames", po::value<uint32_t>(&num_tx_frames)->default_value(1000), "number of frames to transmit")
+            ("sdu_size", po::value<uint32_t>(&sdu_size)->default_value(1000), "SDU size")
+            ("window_size", po::value<uint32_t>(&window_size)->default_value(16), "ARQ window size")
+            ("ack_timeout", po::value<uint32_t>(&ack_timeout)->default_value(500), "ACK timeout in ms")
+            ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    // print the help message
+    if (vm.count("help")) {
+        std::cout << boost::format("GDTP multipath striping example %s") % desc << std::endl;
+        return ~0;
+    }
+
+    // check for bogus parameter settings
+    if (num_ports < 1 || rate == 0 || sdu_size == 0) {
+        std::cout << boost::format("At least one port, a rate and an SDU size are required.") << std::endl;
+        return ~0;
+    }
+
+    // one reliable flow striped over all ports
+    FlowProperties props;
+    props.set_arq_type(SELECTIVE_REPEAT);
+    props.set_window_size(window_size);
+    props.set_max_seqno(4 * window_size);
+    props.set_ack_timeout(ack_timeout);
+    props.set_striping_mode(mode == "shortest" ? SHORTEST_QUEUE : WEIGHTED_ROUND_ROBIN);
+    for (PortId port = 0; port < num_ports; port++) {
+        props.add_stripe_port(port);
+    }
+
+    // creating protocol instances, each with a scheduler per port
+    Gdtp node1_prot, node2_prot;
+    node1_prot.set_default_source_address(1);
+    node1_prot.set_default_destination_address(2);
+    node2_prot.set_default_source_address(2);
+    node2_prot.set_default_destination_address(1);
+    for (PortId port = 0; port < num_ports; port++) {
+        node1_prot.set_scheduler_type("fifo", port);
+        node2_prot.set_scheduler_type("fifo", port);
+    }
+    node1_prot.set_codec_type("binary");
+    node2_prot.set_codec_type("binary");
+    node1_prot.initialize();
+    node2_prot.initialize();
+
+    FlowId id = node1_prot.allocate_flow(UPPER_PORT, props);
+    FlowProperties rx_props = props;
+    rx_props.set_striping_mode(NO_STRIPING);
+    node2_prot.allocate_flow(UPPER_PORT, rx_props);
+
+    // a pair of channels per port
+    boost::ptr_vector<Channel> channels_n1_to_n2, channels_n2_to_n1;
+    boost::ptr_vector<boost::thread> threads;
+    for (PortId port = 0; port < num_ports; port++) {
+        channels_n1_to_n2.push_back(new Channel(num_tx_frames, fer));
+        channels_n2_to_n1.push_back(new Channel(num_tx_frames, fer));
+        threads.push_back(new boost::thread(boost::bind(tx_handler, boost::ref(node1_prot), boost::ref(channels_n1_to_n2[port]), port, rate)));
+        threads.push_back(new boost::thread(boost::bind(rx_handler, boost::ref(node2_prot), boost::ref(channels_n1_to_n2[port]), port)));
+        threads.push_back(new boost::thread(boost::bind(tx_handler, boost::ref(node2_prot), boost::ref(channels_n2_to_n1[port]), port, rate)));
+        threads.push_back(new boost::thread(boost::bind(rx_handler, boost::ref(node1_prot), boost::ref(channels_n2_to_n1[port]), port)));
+    }
+
+    // measure the time until the receiving application got all SDUs
+    bool in_order = true;
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    boost::thread rx_app(boost::bind(rx_app_handler, boost::ref(node2_prot), num_tx_frames, boost::ref(in_order)));
+    tx_app_handler(node1_prot, id, num_tx_frames, sdu_size);
+    rx_app.join();
+    double elapsed = (boost::posix_time::microsec_clock::universal_time() - start).total_microseconds() / 1e6;
+
+    boost::ptr_vector<boost::thread>::iterator it;
+    for (it = threads.begin(); it != threads.end(); ++it) {
+        it->interrupt();
+        it->join();
+    }
+
+    if (not in_order) {
+        std::cout << "Error during transmission!" << std::endl;
+        return ~1;
+    }
+
+    FlowStats stats = node1_prot.get_stats(id);
+    double goodput = num_tx_frames * sdu_size * 8 / elapsed / 1000;
+    std::cout << boost::format("ports\trate\tgoodput\tutil\trtx") << std::endl;
+    std::cout << boost::format("%d\t%d\t%.1f\t%.2f\t%d") % num_ports % rate % goodput
+                 % (goodput / (num_ports * rate)) % stats.arq.rtx_pdus << std::endl;
+    return 0;
+}
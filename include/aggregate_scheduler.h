@@ -0,0 +1,77 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*! \brief Aggregating scheduler.
+ *
+ * Flows are served in the order they became ready, like the FifoScheduler,
+ * but PDUs of several flows are packed into the same frame until the byte
+ * budget of the port is exhausted. If a frame isn't full yet, the scheduler
+ * may wait up to max_wait milliseconds for further PDUs before handing it out.
+ * The byte budget only accounts for payload, the codec adds its headers on top.
+ */
+
+#ifndef AGGREGATE_SCHEDULER_H
+#define AGGREGATE_SCHEDULER_H
+
+#include "scheduler_base.h"
+#include "logger.h"
+#include <queue>
+#include <vector>
+
+namespace libgdtp
+{
+
+const size_t default_aggregation_bytes = 1400;
+const uint32_t default_aggregation_wait = 0;
+
+class AggregateScheduler : public SchedulerBase
+{
+public:
+    AggregateScheduler() :
+        max_bytes_(default_aggregation_bytes),
+        max_wait_(default_aggregation_wait)
+    {}
+    void add_flow(FlowBase* flow);
+    void get_pdus_for_below(PduVector &pdus);
+    bool try_get_pdus_for_below(PduVector &pdus);
+    bool has_waiting_flow(void);
+    void set_pdus_transmitted(void);
+    void set_aggregation_limits(const size_t max_bytes, const uint32_t max_wait);
+
+private:
+    FlowBase* get_next_flow();
+    FlowBase* get_next_flow(const size_t used, const boost::system_time& deadline);
+    void fill_frame(FlowBase* flow, const bool wait, PduVector &pdus);
+    static std::string get_name(void) { return "AggregateScheduler"; }
+
+    // This queue holds pointers to all flows that are ready
+    // to be served in the order they have been inserted (FIFO)
+    std::queue<FlowBase*> queue_;
+    std::vector<FlowBase*> frame_flows_; ///< flow of each PDU in the frame handed out last
+    size_t max_bytes_; ///< payload bytes per frame
+    uint32_t max_wait_; ///< time in ms to wait for more PDUs if a frame isn't full
+    DECLARE_LOGPTR(logger_)
+};
+
+} // namespace libgdtp
+
+#endif // AGGREGATE_SCHEDULER_H
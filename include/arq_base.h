@@ -28,10 +28,15 @@
 #include <assert.h>
 #include <thread>
 #include <mutex>
+#include <deque>
+#include <boost/thread/thread_time.hpp>
 #include "exceptions.h"
 #include "logger.h"
 #include "buffer.h"
+#include "spsc_buffer.h"
 #include "pdu.h"
+#include "rtt_estimator.h"
+#include "arq_executor.h"
 
 namespace libgdtp {
 
@@ -59,6 +64,10 @@ class ArqBase : boost::noncopyable
 {
     friend class StopWaitArqRx;
     friend class StopWaitArqTx;
+    friend class SelectiveRepeatArqRx;
+    friend class SelectiveRepeatArqTx;
+    friend class GoBackNArqRx;
+    friend class GoBackNArqTx;
 public:
     /**
      * The constructor of the base class requires to pass
@@ -68,26 +77,75 @@ public:
 
     virtual ~ArqBase() {}
 
-    virtual void handle_pdu_from_above(Pdu& pdu);
+    void handle_pdu_from_above(Pdu&& pdu);
 
-    virtual void handle_pdu_from_below(Pdu& pdu) = 0;
+    /**
+     * Queue a burst of PDUs. The buffer is filled as far as possible before
+     * the ARQ is serviced, so locking and notification happen once per run
+     * of free slots instead of once per PDU.
+     */
+    void handle_pdus_from_above(PduVector&& pdus);
+
+    virtual void handle_pdu_from_below(Pdu&& pdu) = 0;
 
     virtual void frame_transmitted() = 0;
 
+    /**
+     * Called once all PDUs of a frame from below have been handled. NACKs for
+     * missing PDUs are sent right away. A pending ACK is sent now, or after the
+     * ACK delay of the flow unless DATA of the reverse direction takes it along before.
+     */
+    void frame_received();
+
+    /**
+     * Attach the pending ACK, if any, to a DATA PDU of the reverse direction.
+     * @return true if the PDU carries the ACK now
+     */
+    bool piggyback_ack(Pdu& pdu);
+
     ArqStats get_stats(StatsMode mode);
 
 private:
     // member functions
-    const FlowProperties get_props(void);
+    virtual void service_buffer(void) {} ///< called after new PDUs have been queued in buffer_
+    PduVector::iterator queue_pdus(PduVector::iterator it, PduVector::iterator end);
+    std::shared_ptr<const FlowProperties> get_props(void);
+    Pdu get_ack_for_data_frame(Pdu &pdu, const SeqNo seqno);
+    void ack_data_pdu(Pdu& pdu, const SeqNo seqno);
+    void nack_pdu(const SeqNo seqno);
+    void send_nacks(void);
+    virtual void update_ack(Pdu&) {} ///< fill in the state of the receiver right before the ACK leaves
+    void send_ack(void);
+    void stop_ack_timer(void);
+    void handle_ack_timer(const ArqExecutor::TimerId id);
+    bool drop_if_late(const Pdu& pdu);
+    void assign_seq_no(Pdu& pdu);
+    void skip_to(const Pdu& pdu, const SeqNo seq_no, PduVector& pdus);
+    void send_skip(PduVector& pdus);
+    void confirm_skip(const SeqNo ack_seq_no);
+    void stop_skip_timer(void);
+    void handle_skip_timer(const ArqExecutor::TimerId id);
+    uint32_t get_ack_timeout(void);
+    void add_rtt_sample(const boost::system_time& tx_time);
+    void backoff_ack_timeout(void);
     static std::string get_name(void) { return "ArqBase"; }
 
     // private variables
     FlowBase* const flow_;
     ArqState state_;
-    Buffer<Pdu> buffer_;
-    boost::thread arq_thread_;
+    SpscBuffer<Pdu> buffer_; // written by the flow, read by the ARQ, both serialize access
+    RttEstimator rtt_;
     ArqStats stats_;
     ArqStats last_stats_;
+    Pdu ack_; ///< header of the pending ACK
+    bool ack_pending_; ///< a received DATA PDU hasn't been acknowledged yet
+    ArqExecutor::TimerId ack_timer_id_; ///< timer of the delayed ACK, zero if not running
+    std::vector<SeqNo> nack_seq_nos_; ///< missing PDUs detected in the current frame, in seqno order
+    SeqNo next_seq_no_; ///< seqno of the next PDU that enters the transmit window
+    std::deque<SeqNo> tx_pending_; ///< seqnos queued for below but not yet transmitted
+    Pdu skip_; ///< SKIP the receiver hasn't confirmed yet
+    uint32_t num_skip_tx_; ///< transmissions of skip_
+    ArqExecutor::TimerId skip_timer_id_; ///< repeats skip_, zero if no SKIP is pending
     boost::mutex mutex_;
 
     DECLARE_LOGPTR(logger_)
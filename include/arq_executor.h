@@ -0,0 +1,110 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*! \brief Shared executor that drives the timers of all ARQ instances.
+ *
+ * Instead of having one thread per flow that blocks until an ACK arrives or
+ * a timeout occurs, all ARQ state machines are implemented as non-blocking
+ * event handlers. Events from above and below are handled directly in the
+ * calling thread, timeouts are fired by a single executor thread that is
+ * backed by a hierarchical timer wheel with a resolution of one millisecond.
+ * The thread is started when the first timer is scheduled.
+ */
+
+#ifndef ARQ_EXECUTOR_H
+#define ARQ_EXECUTOR_H
+
+#include <iostream>
+#include <functional>
+#include <unordered_map>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include "timer_wheel.h"
+#include "logger.h"
+
+namespace libgdtp
+{
+
+class ArqExecutor : boost::noncopyable
+{
+public:
+    typedef TimerWheel::TimerId TimerId;
+    typedef std::function<void(TimerId)> Callback;
+
+    static ArqExecutor& get_instance()
+    {
+        static ArqExecutor instance;
+        return instance;
+    }
+
+    /**
+     * @brief Schedule a callback to be called by the executor thread.
+     * @param owner The object the timer belongs to (see cancel_all())
+     * @param delay Delay in milliseconds
+     * @param callback Function that is called with the ID of the timer
+     * @return The ID of the timer, never zero
+     */
+    TimerId schedule(const void* owner, const uint32_t delay, Callback callback);
+
+    /**
+     * @brief Cancel a timer.
+     * This doesn't block, so the callback may already be running. Callbacks
+     * therefore need to check whether their timer is still valid.
+     */
+    void cancel(const TimerId id);
+
+    /**
+     * @brief Cancel all timers of an owner and wait for a running callback to finish.
+     * Must not be called with a lock held that the owner's callbacks acquire.
+     */
+    void cancel_all(const void* owner);
+
+private:
+    typedef struct
+    {
+        const void* owner;
+        Callback callback;
+    } Timer;
+
+    ArqExecutor();
+    ~ArqExecutor();
+    void executor_thread_function(void);
+    TimerWheel::Tick get_current_tick(void);
+    static std::string get_name(void) { return "ArqExecutor"; }
+
+    TimerWheel wheel_;
+    std::unordered_map<TimerId, Timer> timers_;
+    TimerId next_id_;
+    const void* running_owner_; ///< owner of the callback currently executed
+    const boost::system_time epoch_;
+
+    boost::thread executor_thread_;
+    boost::mutex mutex_;
+    boost::condition_variable timer_cond_;
+    boost::condition_variable done_cond_;
+    DECLARE_LOGPTR(logger_)
+};
+
+} // namespace libgdtp
+
+#endif // ARQ_EXECUTOR_H
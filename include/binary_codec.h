@@ -0,0 +1,243 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef BINARY_CODEC_H
+#define BINARY_CODEC_H
+
+#include <cstring>
+#include <stdint.h>
+#include "codec_base.h"
+#include "exceptions.h"
+
+namespace libgdtp
+{
+
+/**
+ * Codec with a packed, fixed-layout header in network byte order.
+ *
+ * Frame:   | payload | payload | ... | PDU header | PDU header | ... | trailer |
+ * Header:  | type (1) | src_id (4) | dest_id (4) | source (8) | destination (8) |
+ *          | seqno (8) | sack (8) | ack seqno (8) | payload length (4) |
+ * Trailer: | number of PDUs (2) | flags (1) | version (1) |
+ *
+ * The most significant bit of the type marks a DATA PDU that carries an ACK
+ * for the reverse direction in ack seqno and sack.
+ *
+ * The headers are placed behind the payloads, hence the first payload
+ * starts at the beginning of the frame. When decoding a frame that is
+ * owned by a shared pointer, the frame buffer itself is truncated to
+ * the first payload and handed up without copying.
+ */
+class BinaryCodec : public CodecBase
+{
+public:
+    static const uint8_t VERSION = 4;
+    static const size_t FRAME_TRAILER_SIZE = 4;
+    static const size_t PDU_HEADER_SIZE = 53;
+    static const uint8_t PIGGYBACK_ACK_FLAG = 0x80;
+
+    using CodecBase::decode;
+
+    /**
+     * Encode outgoing PDUs into a valid lower layer SDU.
+     *
+     * \param pdus Reference to a vector of Pdu objects
+     * \param lower_layer_sdu Reference to a Sdu object
+     * \return void
+     */
+    void encode(PduVector& pdus, Data& lower_layer_sdu)
+    {
+        if (pdus.size() > UINT16_MAX) {
+            throw GdtpException("Too many PDUs for a single frame.");
+        }
+
+        size_t frame_size = FRAME_TRAILER_SIZE;
+        for (auto& pdu : pdus) {
+            frame_size += PDU_HEADER_SIZE + pdu.get_payload_ptr()->size();
+        }
+        lower_layer_sdu.resize(frame_size);
+
+        uint8_t* pos = lower_layer_sdu.data();
+        for (auto& pdu : pdus) {
+            Data* payload = pdu.get_payload_ptr();
+            if (not payload->empty()) {
+                memcpy(pos, payload->data(), payload->size());
+                pos += payload->size();
+            }
+        }
+        for (auto& pdu : pdus) {
+            pos = write<uint8_t>(pos, pdu.get_type() | (pdu.has_piggyback_ack() ? PIGGYBACK_ACK_FLAG : 0));
+            pos = write<uint32_t>(pos, pdu.get_src_id());
+            pos = write<uint32_t>(pos, pdu.get_dest_id());
+            pos = write<uint64_t>(pos, pdu.get_source_addr());
+            pos = write<uint64_t>(pos, pdu.get_dest_addr());
+            pos = write<uint64_t>(pos, pdu.get_seq_no());
+            pos = write<uint64_t>(pos, pdu.get_sack());
+            pos = write<uint64_t>(pos, pdu.get_ack_seq_no());
+            pos = write<uint32_t>(pos, pdu.get_payload_ptr()->size());
+        }
+        pos = write<uint16_t>(pos, pdus.size());
+        pos = write<uint8_t>(pos, 0); // flags, reserved
+        pos = write<uint8_t>(pos, VERSION);
+    }
+
+
+    /**
+     * Decode an incoming SDU from a lower layer into valid PDUs of
+     * this protocol. Each payload is copied exactly once.
+     *
+     * \param lower_layer_sdu Reference to a Sdu object
+     * \param pdus Reference to a vector of Pdu objects
+     * \return void
+     */
+    void decode(Data& lower_layer_sdu, PduVector& pdus)
+    {
+        parse(lower_layer_sdu, pdus, false);
+    }
+
+
+    /**
+     * Decode an incoming SDU and reuse its buffer as payload of the first PDU.
+     * The SDU is truncated to that payload, payloads of all other PDUs are copied.
+     *
+     * \param lower_layer_sdu Shared pointer to a Sdu object, must not be used by the caller afterwards
+     * \param pdus Reference to a vector of Pdu objects
+     * \return void
+     */
+    void decode(std::shared_ptr<Data> lower_layer_sdu, PduVector& pdus)
+    {
+        const size_t first = pdus.size();
+        const size_t first_length = parse(*lower_layer_sdu, pdus, true);
+        if (pdus.size() > first) {
+            // shrinking doesn't reallocate, the first payload stays in place
+            lower_layer_sdu->resize(first_length);
+            pdus[first].set_payload(lower_layer_sdu);
+        }
+    }
+
+private:
+    /**
+     * Parse a frame and append its PDUs. If skip_first is set, the payload
+     * of the first PDU is left to the caller.
+     * \return The payload length of the first PDU
+     */
+    size_t parse(const Data& frame, PduVector& pdus, const bool skip_first)
+    {
+        if (frame.size() < FRAME_TRAILER_SIZE) {
+            throw DecodeException("Frame too short.");
+        }
+
+        const uint8_t* const begin = frame.data();
+        const uint8_t* const trailer = begin + frame.size() - FRAME_TRAILER_SIZE;
+        uint16_t num_pdus;
+        uint8_t flags, version;
+        read(read(read(trailer, num_pdus), flags), version);
+        if (version != VERSION) {
+            throw DecodeException("Unsupported frame version.");
+        }
+        if (size_t(trailer - begin) < num_pdus * PDU_HEADER_SIZE) {
+            throw DecodeException("PDU headers truncated.");
+        }
+
+        // validate the whole frame before appending any PDU
+        const uint8_t* const headers = trailer - num_pdus * PDU_HEADER_SIZE;
+        size_t payload_size = 0;
+        for (uint16_t i = 0; i < num_pdus; i++) {
+            uint8_t type;
+            uint32_t length;
+            read(headers + i * PDU_HEADER_SIZE, type);
+            read(headers + (i + 1) * PDU_HEADER_SIZE - sizeof(length), length);
+            if ((type & ~PIGGYBACK_ACK_FLAG) > SKIP) {
+                throw DecodeException("Unknown PDU type.");
+            }
+            payload_size += length;
+        }
+        if (payload_size != size_t(headers - begin)) {
+            throw DecodeException("Payload lengths don't match frame size.");
+        }
+
+        const uint8_t* header = headers;
+        const uint8_t* payload = begin;
+        size_t first_length = 0;
+        pdus.reserve(pdus.size() + num_pdus);
+        for (uint16_t i = 0; i < num_pdus; i++) {
+            uint8_t type;
+            uint32_t src_id, dest_id, length;
+            uint64_t source, destination, seqno, sack, ack_seqno;
+            header = read(header, type);
+            header = read(header, src_id);
+            header = read(header, dest_id);
+            header = read(header, source);
+            header = read(header, destination);
+            header = read(header, seqno);
+            header = read(header, sack);
+            header = read(header, ack_seqno);
+            header = read(header, length);
+            const bool piggyback = (type & PIGGYBACK_ACK_FLAG);
+            type &= ~PIGGYBACK_ACK_FLAG;
+
+            std::shared_ptr<Data> data;
+            if (i == 0 && skip_first) {
+                first_length = length;
+            } else {
+                data = make_payload(static_cast<Type>(type), payload, payload + length);
+            }
+            payload += length;
+
+            Pdu pdu(std::move(data));
+            pdu.set_type(static_cast<Type>(type));
+            pdu.set_src_id(src_id);
+            pdu.set_dest_id(dest_id);
+            pdu.set_source_addr(source);
+            pdu.set_dest_addr(destination);
+            pdu.set_seq_no(seqno);
+            pdu.set_sack(sack);
+            if (piggyback)
+                pdu.set_piggyback_ack(ack_seqno, sack);
+            pdus.push_back(std::move(pdu));
+        }
+        return first_length;
+    }
+
+    template<class T>
+    static uint8_t* write(uint8_t* pos, const T value)
+    {
+        for (size_t i = 0; i < sizeof(T); i++) {
+            pos[i] = uint8_t(value >> (8 * (sizeof(T) - 1 - i)));
+        }
+        return pos + sizeof(T);
+    }
+
+    template<class T>
+    static const uint8_t* read(const uint8_t* pos, T& value)
+    {
+        value = 0;
+        for (size_t i = 0; i < sizeof(T); i++) {
+            value = T(value << 8) | pos[i];
+        }
+        return pos + sizeof(T);
+    }
+};
+
+} // namespace libgdtp
+
+#endif // BINARY_CODEC_H
@@ -23,6 +23,11 @@
 /**
  * A thread-safe class that implements a fixed-size buffer.
  * Inspired by Iris' MessageQueue.h.
+ *
+ * Any number of threads may push and pop. The batch functions move several
+ * elements with a single lock round trip, condition variables are only
+ * signalled if a thread is actually waiting. Elements are moved out of the
+ * buffer, rvalue overloads allow moving them in.
  */
 
 #ifndef BUFFER_H
@@ -32,7 +37,10 @@
 #include <boost/thread/condition.hpp>
 #include <boost/thread/thread.hpp>
 #include <boost/call_traits.hpp>
+#include <iterator>
 #include <queue>
+#include <utility>
+#include <vector>
 
 template<class T>
 class Buffer : boost::noncopyable
@@ -43,8 +51,8 @@ public:
     typedef typename container_type::value_type value_type;
     typedef typename boost::call_traits<value_type>::param_type param_type;
 
-    explicit Buffer(size_type capacity) : capacity_(capacity) {}
-    explicit Buffer() : capacity_(10) {}
+    explicit Buffer(size_type capacity) : capacity_(capacity), numNotEmptyWaiters_(0), numNotFullWaiters_(0) {}
+    explicit Buffer() : capacity_(10), numNotEmptyWaiters_(0), numNotFullWaiters_(0) {}
 
     Buffer(const Buffer&) = delete;
     Buffer& operator=(const Buffer&) = delete;
@@ -52,12 +60,58 @@ public:
     void pushBack(T const& data)
     {
         boost::mutex::scoped_lock lock(mutex_);
-        while (container_.size() >= capacity_) {
-           notFullCond_.wait(lock);
-        }
+        waitNotFull(lock);
         container_.push(data);
-        lock.unlock();
-        notEmptyCond_.notify_one();
+        notifyNotEmpty(lock, 1);
+    }
+
+    void pushBack(T&& data)
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        waitNotFull(lock);
+        container_.push(std::move(data));
+        notifyNotEmpty(lock, 1);
+    }
+
+    /**
+     * Never blocks, data is only moved from if there is space.
+     * @return false if the buffer is full.
+     */
+    bool tryPushBack(T& data)
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        if (container_.size() >= capacity_) {
+            return false;
+        }
+        container_.push(std::move(data));
+        notifyNotEmpty(lock, 1);
+        return true;
+    }
+
+    template<class... Args>
+    void emplaceBack(Args&&... args)
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        waitNotFull(lock);
+        container_.emplace(std::forward<Args>(args)...);
+        notifyNotEmpty(lock, 1);
+    }
+
+    /**
+     * Push all elements with a single lock round trip as long as there
+     * is enough space. Blocks while the buffer is full.
+     */
+    void pushBackBatch(std::vector<T> const& data)
+    {
+        pushRange(data.begin(), data.end());
+    }
+
+    /**
+     * Same as above, but moves the elements into the buffer.
+     */
+    void pushBackBatch(std::vector<T>&& data)
+    {
+        pushRange(std::make_move_iterator(data.begin()), std::make_move_iterator(data.end()));
     }
 
     bool tryPop(T& value)
@@ -66,23 +120,53 @@ public:
         if (container_.empty()) {
             return false;
         }
-        value = container_.front();
+        value = std::move(container_.front());
         container_.pop();
-        lock.unlock();
-        notFullCond_.notify_one();
+        notifyNotFull(lock, 1);
         return true;
     }
 
     void popFront(T& value)
     {
         boost::mutex::scoped_lock lock(mutex_);
-        while (container_.empty()) {
-            notEmptyCond_.wait(lock);
-        }
-        value = container_.front();
+        waitNotEmpty(lock);
+        value = std::move(container_.front());
         container_.pop();
-        lock.unlock();
-        notFullCond_.notify_one();
+        notifyNotFull(lock, 1);
+    }
+
+    /**
+     * Blocks until at least one element is available, then appends up to
+     * max elements to values with a single lock round trip.
+     * @return The number of elements appended.
+     */
+    size_type popFrontBatch(std::vector<T>& values, size_type max)
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        waitNotEmpty(lock);
+        size_type num = 0;
+        while (num < max && not container_.empty()) {
+            values.push_back(std::move(container_.front()));
+            container_.pop();
+            num++;
+        }
+        notifyNotFull(lock, num);
+        return num;
+    }
+
+    /**
+     * Calls func with the first element, which stays in the buffer.
+     * @return false if the buffer is empty.
+     */
+    template<class Function>
+    bool peekFront(Function func) const
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        if (container_.empty()) {
+            return false;
+        }
+        func(container_.front());
+        return true;
     }
 
     size_type size() {
@@ -107,8 +191,66 @@ public:
     }
 
 private:
+    template<class Iterator>
+    void pushRange(Iterator it, Iterator end)
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        while (it != end) {
+            waitNotFull(lock);
+            size_type num = 0;
+            while (it != end && container_.size() < capacity_) {
+                container_.push(*it++);
+                num++;
+            }
+            // wake consumers before possibly waiting for space again
+            notifyNotEmpty(lock, num);
+            if (it != end) {
+                lock.lock();
+            }
+        }
+    }
+
+    void waitNotEmpty(boost::mutex::scoped_lock& lock)
+    {
+        numNotEmptyWaiters_++;
+        while (container_.empty()) {
+            notEmptyCond_.wait(lock);
+        }
+        numNotEmptyWaiters_--;
+    }
+
+    void waitNotFull(boost::mutex::scoped_lock& lock)
+    {
+        numNotFullWaiters_++;
+        while (container_.size() >= capacity_) {
+            notFullCond_.wait(lock);
+        }
+        numNotFullWaiters_--;
+    }
+
+    // unlock and only signal if someone is actually waiting
+    void notifyNotEmpty(boost::mutex::scoped_lock& lock, size_type num)
+    {
+        const bool waiting = (numNotEmptyWaiters_ > 0);
+        lock.unlock();
+        if (waiting) {
+            num > 1 ? notEmptyCond_.notify_all() : notEmptyCond_.notify_one();
+        }
+    }
+
+    void notifyNotFull(boost::mutex::scoped_lock& lock, size_type num)
+    {
+        const bool waiting = (numNotFullWaiters_ > 0);
+        lock.unlock();
+        if (waiting) {
+            num > 1 ? notFullCond_.notify_all() : notFullCond_.notify_one();
+        }
+    }
+
     container_type container_;
     size_type capacity_;
+    size_type numNotEmptyWaiters_;
+    size_type numNotFullWaiters_;
     mutable boost::mutex mutex_;
     boost::condition_variable notEmptyCond_;
     boost::condition_variable notFullCond_;
@@ -0,0 +1,100 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef CODEC_BASE_H
+#define CODEC_BASE_H
+
+#include "libgdtp.h"
+#include "pdu.h"
+#include "payload_pool.h"
+
+namespace libgdtp
+{
+
+class CodecBase : boost::noncopyable
+{
+public:
+    virtual ~CodecBase() {}
+
+    /**
+     * Encode outgoing PDUs into a valid lower layer SDU.
+     *
+     * \param pdus Reference to a vector of Pdu objects
+     * \param lower_layer_sdu Reference to a Sdu object
+     * \return void
+     */
+    virtual void encode(PduVector& pdus, Data& lower_layer_sdu) = 0;
+
+    /**
+     * Decode an incoming SDU from a lower layer into valid PDUs of
+     * this protocol. Throws a DecodeException if the SDU is malformed.
+     *
+     * \param lower_layer_sdu Reference to a Sdu object
+     * \param pdus Reference to a vector of Pdu objects
+     * \return void
+     */
+    virtual void decode(Data& lower_layer_sdu, PduVector& pdus) = 0;
+
+    /**
+     * Decode an incoming SDU whose ownership is passed to the codec. Codecs
+     * may reuse the buffer for PDU payloads instead of copying them, the
+     * default implementation falls back to the copying variant.
+     *
+     * \param lower_layer_sdu Shared pointer to a Sdu object, must not be used by the caller afterwards
+     * \param pdus Reference to a vector of Pdu objects
+     * \return void
+     */
+    virtual void decode(std::shared_ptr<Data> lower_layer_sdu, PduVector& pdus)
+    {
+        decode(*lower_layer_sdu, pdus);
+    }
+
+    /**
+     * Set the pool payloads of decoded PDUs are allocated from.
+     */
+    void set_payload_pool(std::shared_ptr<PayloadPool> pool)
+    {
+        pool_ = pool;
+    }
+
+protected:
+    /**
+     * Create the payload of a decoded PDU. Empty ACKs, NACKs and SKIPs share a single payload.
+     */
+    std::shared_ptr<Data> make_payload(const Type type, const uint8_t* begin, const uint8_t* end)
+    {
+        if ((type == ACK || type == NACK || type == SKIP) && begin == end) {
+            return Pdu::get_empty_payload();
+        }
+        if (pool_) {
+            return pool_->allocate(begin, end);
+        }
+        return std::make_shared<Data>(begin, end);
+    }
+
+private:
+    std::shared_ptr<PayloadPool> pool_;
+};
+
+} // namespace libgdtp
+
+#endif // CODEC_BASE_H
@@ -0,0 +1,64 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef CODEC_FACTORY_H
+#define CODEC_FACTORY_H
+
+#include <map>
+#include <memory>
+#include "protobuf_codec.h"
+#include "binary_codec.h"
+
+namespace libgdtp
+{
+
+enum Codec
+{
+    UNKNOWN_CODEC,
+    PROTOBUF,
+    BINARY
+};
+
+static std::map<std::string, Codec> codec_map_ = {{"protobuf", PROTOBUF},
+                                                  {"binary", BINARY}};
+
+class CodecFactory
+{
+    public:
+        static std::unique_ptr<CodecBase> make_codec(const std::string type)
+        {
+            Codec codec = codec_map_.count(type) ? codec_map_[type] : UNKNOWN_CODEC;
+            switch (codec)
+            {
+                case PROTOBUF:
+                    return std::unique_ptr<CodecBase>(new ProtobufCodec());
+                case BINARY:
+                    return std::unique_ptr<CodecBase>(new BinaryCodec());
+                default:
+                    throw GdtpException("Unknown codec type.");
+            }
+        }
+};
+
+} // namespace libgdtp
+
+#endif // CODEC_FACTORY_H
@@ -0,0 +1,71 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*! \brief Deficit Round Robin (DRR) scheduler.
+ *
+ * Flows with frames for below are served in round-robin order. Each flow
+ * receives its quantum (in bytes) per round and may send frames as long as
+ * its deficit covers the size of its next frame, so the capacity of a port
+ * is shared by bytes rather than by frames. As long as the quantum is not
+ * smaller than the largest frame, each dequeue has O(1) amortized cost.
+ */
+
+#ifndef DRR_SCHEDULER_H
+#define DRR_SCHEDULER_H
+
+#include "scheduler_base.h"
+#include "logger.h"
+#include <deque>
+#include <unordered_map>
+
+namespace libgdtp
+{
+
+class DrrScheduler : public SchedulerBase
+{
+public:
+    DrrScheduler() {}
+    void add_flow(FlowBase* flow);
+    void get_pdus_for_below(PduVector &pdus);
+    bool has_waiting_flow(void);
+
+private:
+    ///< Scheduling state of an active flow
+    typedef struct
+    {
+        size_t deficit; ///< bytes the flow may still send in the current round
+        bool new_round; ///< quantum has not been added for the upcoming turn yet
+    } DrrState;
+
+    FlowBase* get_next_flow();
+    void remove_flow_if_idle(FlowBase* flow);
+    static std::string get_name(void) { return "DrrScheduler"; }
+
+    // Flows with waiting frames in round-robin order, the front one is served
+    std::deque<FlowBase*> active_;
+    std::unordered_map<FlowBase*, DrrState> states_;
+    DECLARE_LOGPTR(logger_)
+};
+
+} // namespace libgdtp
+
+#endif // DRR_SCHEDULER_H
@@ -0,0 +1,60 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*! \brief Earliest Deadline First (EDF) scheduler.
+ *
+ * The flow whose next frame has the earliest deadline is served first.
+ * Frames without deadline are served after all others in the order their
+ * flows became ready. Expired frames are dropped by the ARQ of the flow.
+ */
+
+#ifndef EDF_SCHEDULER_H
+#define EDF_SCHEDULER_H
+
+#include "scheduler_base.h"
+#include "logger.h"
+#include <map>
+
+namespace libgdtp
+{
+
+class EdfScheduler : public SchedulerBase
+{
+public:
+    EdfScheduler() {}
+    void add_flow(FlowBase* flow);
+    void get_pdus_for_below(PduVector &pdus);
+    bool has_waiting_flow(void);
+
+private:
+    FlowBase* get_next_flow();
+    void queue_flow(FlowBase* flow);
+    static std::string get_name(void) { return "EdfScheduler"; }
+
+    // This queue holds pointers to all flows that are ready ordered by the deadline of their next frame
+    std::multimap<boost::posix_time::ptime, FlowBase*> queue_;
+    DECLARE_LOGPTR(logger_)
+};
+
+} // namespace libgdtp
+
+#endif // EDF_SCHEDULER_H
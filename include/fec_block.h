@@ -0,0 +1,96 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef FEC_BLOCK_H
+#define FEC_BLOCK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "libgdtp.h"
+
+namespace libgdtp
+{
+
+/**
+ * Layout and code of the FEC blocks shared by encoder and decoder.
+ *
+ * A block protects up to k data PDUs with m repair PDUs of a systematic
+ * Reed-Solomon code over GF(256). The data PDUs are sent unchanged, each
+ * repair PDU carries a linear combination of their payloads (zero padded to
+ * the largest one) and describes the members of the block:
+ *
+ * Repair:  | block id (4) | index (1) | k (1) | m (1) | k * member | symbol |
+ * Member:  | seqno (8) | length (4) | CRC-32 (4) |
+ *
+ * The receiver matches cached data PDUs by seqno and checks length and CRC,
+ * so a stale PDU with a wrapped seqno is treated as missing. The coefficients
+ * form a Cauchy matrix scaled to make the first row all ones, i.e. a single
+ * repair PDU is plain XOR parity and any k of the k + m PDUs recover the block.
+ */
+class FecBlock
+{
+public:
+    typedef struct
+    {
+        SeqNo seq_no;
+        uint32_t length;
+        uint32_t crc;
+    } Member;
+
+    typedef struct
+    {
+        uint32_t block_id;
+        uint8_t index; ///< of the repair PDU inside the block
+        uint8_t num_repair; ///< m
+        std::vector<Member> members;
+    } Header;
+
+    static const size_t MAX_PDUS = 256; ///< k + m, limited by the field size
+
+    /**
+     * @brief Coefficient of data PDU i in repair PDU j.
+     */
+    static uint8_t get_coefficient(const size_t repair_index, const size_t data_index);
+
+    static uint32_t get_crc(const uint8_t* data, const size_t len);
+
+    /**
+     * @brief Return the size of the header of a block with num_data PDUs.
+     */
+    static size_t get_header_size(const size_t num_data);
+
+    /**
+     * @brief Write the header to the front of buf, which must be large enough.
+     */
+    static void write_header(const Header& header, uint8_t* buf);
+
+    /**
+     * @brief Parse the header of a repair payload.
+     * @return false if the payload isn't a valid repair PDU
+     */
+    static bool read_header(const Data& payload, Header& header);
+};
+
+} // namespace libgdtp
+
+#endif // FEC_BLOCK_H
@@ -0,0 +1,86 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef FEC_DECODER_H
+#define FEC_DECODER_H
+
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include "pdu.h"
+#include "fec_block.h"
+
+namespace libgdtp
+{
+
+/**
+ * Receive side of the FEC stage. Copies of the received data PDUs are
+ * cached by seqno. Once a block has at least as many repair PDUs as members
+ * are missing, the missing PDUs are reconstructed. Blocks that can't be
+ * recovered yet are kept until too many newer blocks are pending.
+ * Not thread-safe, the flow serializes access.
+ */
+class FecDecoder
+{
+public:
+    FecDecoder(const size_t cache_size = 512, const size_t max_blocks = 16);
+
+    /**
+     * @brief Remember a received data PDU.
+     */
+    void add_pdu(const Pdu& pdu);
+
+    /**
+     * @brief Handle a repair PDU, invalid ones are ignored.
+     * @param recovered Receives the reconstructed DATA PDUs, if any.
+     */
+    void handle_repair_pdu(const Pdu& repair, PduVector& recovered);
+
+private:
+    typedef struct
+    {
+        std::shared_ptr<Data> payload;
+        uint32_t crc;
+        uint64_t serial; ///< tells a replaced entry from the current one
+    } CacheEntry;
+
+    typedef struct
+    {
+        std::vector<FecBlock::Member> members;
+        std::map<uint8_t, std::shared_ptr<Data> > repairs; ///< payloads by index
+    } Block;
+
+    void add_to_cache(const SeqNo seq_no, std::shared_ptr<Data> payload, const uint32_t crc);
+    bool is_present(const FecBlock::Member& member);
+    void decode(const Block& block, const std::vector<size_t>& missing, const Pdu& repair, PduVector& recovered);
+
+    const size_t cache_size_;
+    const size_t max_blocks_;
+    std::unordered_map<SeqNo, CacheEntry> cache_;
+    std::deque<std::pair<SeqNo, uint64_t> > cache_order_; ///< seqno and serial of the entries, oldest first
+    uint64_t next_serial_;
+    std::map<uint32_t, Block> blocks_; ///< pending blocks by id
+};
+
+} // namespace libgdtp
+
+#endif // FEC_DECODER_H
@@ -0,0 +1,74 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef FEC_ENCODER_H
+#define FEC_ENCODER_H
+
+#include <vector>
+#include "pdu.h"
+#include "fec_block.h"
+
+namespace libgdtp
+{
+
+/**
+ * Transmit side of the FEC stage. Data PDUs are added one by one and their
+ * payloads are folded into the repair symbols right away, so the encoder
+ * doesn't keep the data. After num_data PDUs, or earlier on flush(), the
+ * block is closed and its repair PDUs are returned.
+ * Not thread-safe, the flow serializes access.
+ */
+class FecEncoder
+{
+public:
+    FecEncoder(const size_t num_data, const size_t num_repair);
+
+    /**
+     * @brief Add a data PDU to the current block.
+     * @param repairs Receives the repair PDUs if the block is complete.
+     */
+    void add_pdu(const Pdu& pdu, PduVector& repairs);
+
+    /**
+     * @brief Close a partial block.
+     */
+    void flush(PduVector& repairs);
+
+    bool has_open_block(void) const { return not members_.empty(); }
+    size_t get_num_pdus(void) const { return members_.size(); }
+    uint32_t get_block_id(void) const { return block_id_; }
+
+private:
+    void close_block(PduVector& repairs);
+
+    const size_t num_data_;
+    const size_t num_repair_;
+    uint32_t block_id_;
+    std::vector<FecBlock::Member> members_;
+    std::vector<Data> symbols_; ///< one per repair PDU, as long as the largest member
+    Pdu first_; ///< addressing of the repair PDUs
+    boost::posix_time::ptime deadline_; ///< repairs are worthless once all members are
+};
+
+} // namespace libgdtp
+
+#endif // FEC_ENCODER_H
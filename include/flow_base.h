@@ -25,12 +25,17 @@
 
 #include <stdio.h>
 #include <atomic>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <boost/lexical_cast.hpp>
 #include "buffer.h"
 #include "logger.h"
 #include "pdu.h"
 #include "flow_property.h"
 #include "arq_base.h"
+#include "token_bucket.h"
 
 namespace libgdtp
 {
@@ -51,6 +56,7 @@ class FlowBase : boost::noncopyable
 {
     friend class OutboundFlow;
     friend class InboundFlow;
+    friend class StripeLane;
 public:
     FlowBase(FlowManager* manager,
                    const FlowId src_id,
@@ -67,28 +73,69 @@ public:
         dest_id_(dest_id),
         src_addr_(src_addr),
         dest_addr_(dest_addr),
-        properties_(props),
+        properties_(std::make_shared<FlowProperties>(props)),
         above_port_name_(above_port_name),
         below_port_name_(below_port_name),
         direction_(direction),
-        buffer_for_below_(buffer_size)
+        // the ARQ must never block on a full buffer while sending a window, each PDU may close an FEC block
+        buffer_for_below_(std::max<size_t>(buffer_size, 2 * props.get_window_size() * (1 + props.get_fec_repair_pdus()))),
+        bucket_(props.get_rate(), props.get_burst()),
+        rate_bucket_(&bucket_),
+        deferred_(false),
+        paired_flow_(NULL),
+        handler_delivering_(false),
+        repair_pdus_(0),
+        recovered_pdus_(0),
+        has_pending_(false),
+        pending_added_(0),
+        pending_queued_(0)
     {
     }
-    virtual ~FlowBase() {}
+    virtual ~FlowBase();
 
     virtual void print_status(void) = 0;
 
-    virtual void handle_frame_from_below(Pdu& pdu) = 0;
+    virtual void handle_frame_from_below(Pdu&& pdu) = 0;
 
     virtual void frame_transmitted(void) = 0;
 
-    ArqStats get_stats(StatsMode mode = RUNNING) { return arq_->get_stats(mode); }
+    /**
+     * @brief Called for each PDU the scheduler takes, frame_transmitted() follows in the same order.
+     */
+    virtual void frame_taken_for_below(const Pdu&) {}
+
+    /**
+     * @brief Called once all PDUs of a frame from below have been handled.
+     * SDUs for the receive handler are delivered here, after the ARQ released its lock.
+     */
+    void frame_received(void);
+
+    ArqStats get_stats(StatsMode mode = RUNNING)
+    {
+        ArqStats stats = arq_->get_stats(mode);
+        stats.tokens = rate_bucket_->get_tokens();
+        stats.repair_pdus = repair_pdus_;
+        stats.recovered_pdus = recovered_pdus_;
+        return stats;
+    }
 
     /**
      * @brief Return relative priority of this connection (the larger, the higher).
      * @return int, the priority.
      */
-    uint32_t get_priority(void) { return properties_.get_priority(); }
+    uint32_t get_priority(void) { return std::atomic_load(&properties_)->get_priority(); }
+
+    /**
+     * @brief Return the number of bytes this flow may send per round (DRR).
+     * @return uint32_t, the quantum.
+     */
+    uint32_t get_quantum(void) { return std::atomic_load(&properties_)->get_quantum(); }
+
+    /**
+     * @brief Return the share of the port this flow gets relative to others (WFQ).
+     * @return uint32_t, the weight.
+     */
+    uint32_t get_weight(void) { return std::atomic_load(&properties_)->get_weight(); }
 
     /**
      * @brief Return whether connection is broadcast or not.
@@ -104,7 +151,7 @@ public:
      * @brief Return whether connection is reliable or not.
      * @return true if this connection should be error free, false otherwise.
      */
-    bool is_unreliable(void) { return (properties_.get_transfer_mode() == UNRELIABLE); }
+    bool is_unreliable(void) { return (std::atomic_load(&properties_)->get_transfer_mode() == UNRELIABLE); }
 
     /**
      * @brief has_frame_for_below() checks whether the below buffer of this
@@ -113,12 +160,44 @@ public:
      */
     bool has_frame_for_below(void) { return buffer_for_below_.isNotEmpty(); }
 
+    /**
+     * @brief get_next_frame_size() returns the payload size of the first
+     * frame in the below buffer without removing it.
+     * @return false if the buffer is empty
+     */
+    bool get_next_frame_size(size_t& size)
+    {
+        return buffer_for_below_.peekFront([&size](const Pdu& pdu) { size = pdu.get_payload()->size(); });
+    }
+
+    /**
+     * @brief get_next_frame_deadline() returns the time by which the first
+     * frame in the below buffer has to be transmitted. ACKs and NACKs are always urgent.
+     * @return false if the buffer is empty
+     */
+    bool get_next_frame_deadline(boost::posix_time::ptime& deadline)
+    {
+        return buffer_for_below_.peekFront([&deadline](const Pdu& pdu) {
+            deadline = (pdu.get_type() == ACK || pdu.get_type() == NACK) ? boost::posix_time::ptime(boost::posix_time::neg_infin) : pdu.get_deadline();
+        });
+    }
+
     /**
      * @brief get_frame_for_below() is a blocking method that pops the first element from
      * its queue and returns it to the caller.
      * The mutex_ must NOT be hold when calling the method (causes deadlock with writer)
+     * If more frames are waiting, the flow is signalled to the scheduler again.
+     */
+    void get_frame_for_below(Pdu &pdu);
+
+    /**
+     * @brief conforms_to_rate() checks whether the first frame in the below buffer
+     * may be sent according to the token bucket of the flow. If not, the flow is
+     * deferred and marked as ready again once enough tokens are available.
+     * Never blocks.
+     * @return false if the flow has to wait
      */
-    void get_frame_for_below(Pdu &pdu) { buffer_for_below_.popFront(pdu); }
+    bool conforms_to_rate(void);
 
     /**
      * @brief Return the current output portname of the connection.
@@ -126,6 +205,18 @@ public:
      */
     PortId get_below_port_name(void) { return below_port_name_; }
 
+    /**
+     * @brief Return the upper layer port the flow delivers to.
+     * @return the port name
+     */
+    PortId get_above_port_name(void) { return above_port_name_; }
+
+    /**
+     * @brief Deliver SDUs to a callback instead of the buffer of the upper layer port.
+     * @param handler The callback, NULL to deliver to the buffer again.
+     */
+    void set_receive_handler(std::shared_ptr<ReceiveHandler> handler) { std::atomic_store(&receive_handler_, handler); }
+
     /**
      * @brief Return the flows' port ID at the source
      * @return the id
@@ -138,39 +229,98 @@ public:
      */
     uint32_t get_dest_id(void) { return dest_id_; }
 
+    /**
+     * @brief Return the address of the node the flow originates from
+     * @return the address
+     */
+    Addr get_src_addr(void) { return src_addr_; }
+
+    /**
+     * @brief Return the address of the node the flow is destined to
+     * @return the address
+     */
+    Addr get_dest_addr(void) { return dest_addr_; }
+
+    /**
+     * @brief Pair the flow with the flow of the reverse direction between the
+     * same nodes and upper layer port, they carry each other's ACKs on their DATA.
+     * @param flow The flow of the reverse direction, NULL to unpair.
+     */
+    void set_paired_flow(FlowBase* flow) { paired_flow_ = flow; }
+
+    /**
+     * @brief Return the flow of the reverse direction, if any.
+     * @return the flow or NULL
+     */
+    FlowBase* get_paired_flow(void) { return paired_flow_; }
+
     /**
      * @brief Return the size of the outbound buffer.
      * @return the current length
      */
     size_t get_below_buffer_size(void) { return buffer_for_below_.size(); }
 
-    const FlowProperties get_props(void) { return properties_; }
+    /**
+     * @brief Return the current properties, they may be replaced by another thread at any time.
+     * @return a snapshot that stays valid and unchanged while it is held
+     */
+    std::shared_ptr<const FlowProperties> get_props(void) { return std::atomic_load(&properties_); }
 
+    /**
+     * @brief Replace the properties as a whole, readers keep the snapshot they hold.
+     */
     void set_properties(FlowProperties props)
     {
         std::unique_lock<std::mutex> lock(mutex_);
-        properties_ = props;
+        bucket_.configure(props.get_rate(), props.get_burst());
+        std::atomic_store(&properties_, std::shared_ptr<const FlowProperties>(std::make_shared<FlowProperties>(props)));
     }
 
     FlowDirection get_direction(void) { return direction_; }
 
-    void queue_pdu_for_above(Pdu& pdu);
+    void queue_pdu_for_above(Pdu&& pdu);
+
+    virtual void queue_pdu_for_below(Pdu&& pdu);
 
-    void queue_pdu_for_below(Pdu& pdu);
+    /**
+     * @brief Same as queue_pdu_for_below(), but never blocks. PDUs that don't
+     * fit are kept in order and queued once the scheduler takes a frame.
+     * For the executor and scheduler threads, which must not wait for space.
+     */
+    virtual void queue_pdu_for_below_nowait(Pdu&& pdu);
 
 private:
+    bool move_pending_pdus(void);
+    void deliver_to_handler(void);
+
     // member variables
     const FlowId src_id_;
     const FlowId dest_id_;
     Addr src_addr_;
     Addr dest_addr_;
-    FlowProperties properties_;
+    std::shared_ptr<const FlowProperties> properties_; ///< accessed atomically, never modified in place
     const PortId above_port_name_;
     const PortId below_port_name_;
     const FlowDirection direction_;
 
     std::unique_ptr<ArqBase> arq_;
     Buffer<Pdu> buffer_for_below_;
+    TokenBucket bucket_;
+    TokenBucket* rate_bucket_; ///< charged for each frame sent, the owner's bucket for stripe lanes
+    std::atomic<bool> deferred_; ///< a timer will mark the flow as ready once it conforms again
+    std::atomic<FlowBase*> paired_flow_; ///< flow of the reverse direction, flows are never deleted before the manager
+    std::shared_ptr<ReceiveHandler> receive_handler_; ///< accessed atomically, set while SDUs bypass the above buffer
+    std::mutex handler_mutex_; ///< guards the PDUs waiting for the receive handler
+    std::deque<Pdu> handler_pending_; ///< PDUs passed up by the ARQ, delivered in frame_received()
+    bool handler_delivering_; ///< a thread is calling the receive handler
+    std::atomic<uint32_t> repair_pdus_; ///< FEC repair PDUs sent or received
+    std::atomic<uint32_t> recovered_pdus_; ///< PDUs reconstructed by the FEC decoder
+    std::mutex pending_mutex_; ///< guards the PDUs waiting for space, never held while blocking on the buffer
+    std::condition_variable pending_cond_;
+    std::deque<Pdu> pending_for_below_; ///< PDUs that didn't fit into the buffer, in order
+    std::atomic<bool> has_pending_; ///< pending_for_below_ isn't empty
+    uint64_t pending_added_; ///< PDUs ever added to pending_for_below_
+    uint64_t pending_queued_; ///< PDUs ever moved from pending_for_below_ to the buffer
 
     FlowManager* manager_;
     std::mutex mutex_;
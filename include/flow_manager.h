@@ -62,6 +62,7 @@ public:
     void initialize(void);
     void deinitialize(void);
     void set_scheduler_type(const PortId port, const std::string type);
+    void set_aggregation_limits(const PortId port, const size_t max_bytes, const uint32_t max_wait);
     void set_default_source_address(const Addr address);
     void set_default_destination_address(const Addr address);
     void set_default_flow_properties(const FlowProperties props);
@@ -72,19 +73,27 @@ public:
 
     ArqStats get_stats(FlowId id);
 
-    int handle_sdu_from_above(std::shared_ptr<Data> sdu, const FlowId id);
-    int handle_pdu_from_below(const PortId id, Pdu &pdu);
-    int add_frame_for_above(Pdu &pdu, const FlowId id);
+    int handle_sdu_from_above(std::shared_ptr<Data>&& sdu, const FlowId id,
+                              const boost::posix_time::ptime& deadline = boost::posix_time::pos_infin);
+    void handle_sdus_from_above(std::vector<std::shared_ptr<Data> >& sdus, const FlowId id);
+    void handle_pdus_from_below(const PortId id, PduVector& pdus);
+    void add_frame_for_above(Pdu&& pdu, const PortId id);
 
     bool has_pdu_for_below(const PortId id);
     void get_pdus_for_below(PduVector &pdus, const FlowId id);
+    bool try_get_pdus_for_below(PduVector &pdus, const PortId id);
+    int get_event_fd(const PortId id);
     void set_frame_transmitted(const PortId id);
 
     bool has_sdu_for_above(const PortId id);
     std::shared_ptr<Data> get_sdu_for_above(const PortId id);
+    size_t get_sdus_for_above(const PortId id, std::vector<std::shared_ptr<Data> >& sdus, const size_t max);
+    void register_receive_handler(const PortId id, ReceiveHandler handler);
 
 private:
     FlowBase* find_flow(Pdu &pdu, const PortId belowid);
+    void pair_flow(FlowBase* flow);
+    FlowBase* handle_pdu_from_below(const PortId id, Pdu&& pdu);
     static std::string get_name(void) { return "FlowManager"; }
 
     // member variables
@@ -97,9 +106,12 @@ private:
     FlowProperties default_props_;
 
     std::set<Addr> destinations_; ///< Addresses to listen for in incoming frames (search may have linear complexity)
-    std::map<const FlowId, std::shared_ptr<FlowBase> > flows_; ///< FIXME: may replace with more efficient data structures for search and insert
-    std::map<PortId, std::unique_ptr<SchedulerBase> > schedulers_; ///< A map containing the actual schedulers
+    std::map<const FlowId, std::shared_ptr<FlowBase> > flows_; ///< Outbound flows by source id. FIXME: may replace with more efficient data structures for search and insert
+    std::map<std::pair<Addr, FlowId>, std::shared_ptr<FlowBase> > inbound_flows_; ///< Inbound flows by address and source id of the sender
+    std::map<PortId, std::unique_ptr<SchedulerBase> > schedulers_; ///< A map containing the actual schedulers, fixed after initialize()
     std::map<PortId, std::unique_ptr<Buffer<Pdu> > > above_buffers_; ///< A map containing the data buffers for each upper layer port
+    std::map<PortId, std::shared_ptr<ReceiveHandler> > receive_handlers_; ///< Callbacks replacing the buffers of some upper layer ports
+    bool initialized_; ///< no more ports or schedulers may be added
     std::mutex mutex_;
 
     DECLARE_LOGPTR(logger_)
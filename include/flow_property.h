@@ -29,6 +29,7 @@
 #ifndef FLOW_PROPERTY_H
 #define FLOW_PROPERTY_H
 
+#include <map>
 #include <string>
 #include <stdint.h>
 
@@ -48,6 +49,22 @@ typedef enum
 } AddressingMode;
 
 
+typedef enum
+{
+    STOP_AND_WAIT = 0,
+    SELECTIVE_REPEAT,
+    GO_BACK_N
+} ArqType;
+
+
+typedef enum
+{
+    NO_STRIPING = 0,
+    WEIGHTED_ROUND_ROBIN, ///< PDUs are spread according to the port weights
+    SHORTEST_QUEUE ///< PDUs go to the port with the fewest queued PDUs relative to its weight
+} StripingMode;
+
+
 class FlowProperties
 {
 public:
@@ -64,7 +81,24 @@ public:
         max_seqno_(max_seqno),
         ack_timeout_(ack_timeout),
         max_retransmission_(max_retransmission),
-        addr_dev_(addr_dev)
+        addr_dev_(addr_dev),
+        arq_type_(STOP_AND_WAIT),
+        window_size_(8),
+        quantum_(1500),
+        weight_(1),
+        max_latency_(0),
+        rate_(0),
+        burst_(1500),
+        below_port_(0), // DEFAULT_BELOW_PORT_ID
+        striping_mode_(NO_STRIPING),
+        adaptive_rto_(false),
+        min_rto_(10),
+        max_rto_(10000),
+        ack_delay_(0),
+        nack_(false),
+        fec_data_pdus_(0),
+        fec_repair_pdus_(0),
+        fec_max_delay_(10)
     {}
 
     TransferMode get_transfer_mode() const { return transfer_mode_; }
@@ -74,6 +108,24 @@ public:
     uint32_t get_max_retransmission() const { return max_retransmission_; }
     uint32_t get_ack_timeout() const { return ack_timeout_; }
     std::string get_addr_dev() const { return addr_dev_; }
+    ArqType get_arq_type() const { return arq_type_; }
+    uint32_t get_window_size() const { return window_size_; }
+    uint32_t get_quantum() const { return quantum_; }
+    uint32_t get_weight() const { return weight_; }
+    uint32_t get_max_latency() const { return max_latency_; }
+    uint32_t get_rate() const { return rate_; }
+    uint32_t get_burst() const { return burst_; }
+    uint32_t get_below_port() const { return below_port_; }
+    StripingMode get_striping_mode() const { return striping_mode_; }
+    const std::map<uint32_t, uint32_t>& get_stripe_ports() const { return stripe_ports_; }
+    bool get_adaptive_rto() const { return adaptive_rto_; }
+    uint32_t get_min_rto() const { return min_rto_; }
+    uint32_t get_max_rto() const { return max_rto_; }
+    uint32_t get_ack_delay() const { return ack_delay_; }
+    bool get_nack() const { return nack_; }
+    uint32_t get_fec_data_pdus() const { return fec_data_pdus_; }
+    uint32_t get_fec_repair_pdus() const { return fec_repair_pdus_; }
+    uint32_t get_fec_max_delay() const { return fec_max_delay_; }
     std::string pp_string() const
     {
         switch (transfer_mode_) {
@@ -89,12 +141,28 @@ public:
     void set_ack_timeout(const uint32_t timeout) { ack_timeout_ = timeout; }
     void set_max_retransmissions(const uint32_t no) { max_retransmission_ = no; }
     void set_addr_dev(const std::string dev) { addr_dev_ = dev; }
+    void set_arq_type(const ArqType type) { arq_type_ = type; }
+    void set_window_size(const uint32_t size) { window_size_ = size; }
+    void set_quantum(const uint32_t quantum) { quantum_ = quantum; }
+    void set_weight(const uint32_t weight) { weight_ = weight; }
+    void set_max_latency(const uint32_t latency) { max_latency_ = latency; }
+    void set_rate(const uint32_t rate) { rate_ = rate; }
+    void set_burst(const uint32_t burst) { burst_ = burst; }
+    void set_below_port(const uint32_t port) { below_port_ = port; }
+    void set_striping_mode(const StripingMode mode) { striping_mode_ = mode; }
+    void add_stripe_port(const uint32_t port, const uint32_t weight = 1) { stripe_ports_[port] = weight; }
+    void set_adaptive_rto(const bool adaptive) { adaptive_rto_ = adaptive; }
+    void set_min_rto(const uint32_t rto) { min_rto_ = rto; }
+    void set_max_rto(const uint32_t rto) { max_rto_ = rto; }
+    void set_ack_delay(const uint32_t delay) { ack_delay_ = delay; }
+    void set_nack(const bool nack) { nack_ = nack; }
+    void set_fec(const uint32_t data_pdus, const uint32_t repair_pdus) { fec_data_pdus_ = data_pdus; fec_repair_pdus_ = repair_pdus; }
+    void set_fec_max_delay(const uint32_t delay) { fec_max_delay_ = delay; }
 
 private:
     TransferMode transfer_mode_;
     uint32_t priority_;
     /* Not implemented:
-    int throughput;
     int delay;
     */
     AddressingMode addressing_mode_;
@@ -102,6 +170,24 @@ private:
     uint32_t ack_timeout_;
     uint32_t max_retransmission_;
     std::string addr_dev_;
+    ArqType arq_type_; ///< ARQ engine used for reliable unicast flows, fixed at flow creation
+    uint32_t window_size_; ///< Number of unacknowledged PDUs in flight (windowed ARQs only)
+    uint32_t quantum_; ///< Bytes a flow may send per round (DRR scheduler only)
+    uint32_t weight_; ///< Relative share of the port, greater than zero, may be changed at runtime (WFQ scheduler only)
+    uint32_t max_latency_; ///< Time in ms after which SDUs are dropped instead of (re)transmitted, 0 disables
+    uint32_t rate_; ///< Maximum rate in bytes per second enforced by a token bucket, 0 disables
+    uint32_t burst_; ///< Size of the token bucket in bytes, i.e. the largest burst sent at once
+    uint32_t below_port_; ///< Lower layer port the flow transmits on, fixed at flow creation
+    StripingMode striping_mode_; ///< How PDUs are spread across the stripe ports, fixed at flow creation
+    std::map<uint32_t, uint32_t> stripe_ports_; ///< Lower layer ports used for striping and their weights
+    bool adaptive_rto_; ///< Derive the ACK timeout from the measured RTT, ack_timeout_ is only used until the first sample
+    uint32_t min_rto_; ///< Lower bound of the adaptive ACK timeout in ms
+    uint32_t max_rto_; ///< Upper bound of the adaptive ACK timeout in ms, also limits the backoff
+    uint32_t ack_delay_; ///< Time in ms an ACK may wait for reverse DATA to carry it, 0 sends it with the end of the frame
+    bool nack_; ///< Receivers request PDUs missing from a seqno gap right away (windowed ARQs only)
+    uint32_t fec_data_pdus_; ///< Data PDUs per FEC block, 0 disables FEC, fixed at flow creation
+    uint32_t fec_repair_pdus_; ///< Repair PDUs sent after each FEC block
+    uint32_t fec_max_delay_; ///< Time in ms after which a partial FEC block is closed
 };
 
 } // namespace libgdtp
@@ -25,6 +25,7 @@
 
 #include "libgdtp.h"
 #include "flow_manager.h"
+#include "codec_base.h"
 
 namespace libgdtp
 {
@@ -37,6 +38,8 @@ public:
 
     void initialize();
     void set_scheduler_type(const PortId port, const std::string type);
+    void set_aggregation_limits(const PortId port, const size_t max_bytes, const uint32_t max_wait);
+    void set_codec_type(const std::string type);
     void set_default_source_address(const Addr source);
     void set_default_destination_address(const Addr destination);
     int allocate_flow(const FlowId id, FlowProperties props);
@@ -44,12 +47,19 @@ public:
 
     bool has_data_for_below(const FlowId id);
     void get_data_for_below(const FlowId id, Data& data);
+    bool try_get_data_for_below(const PortId id, Data& data);
+    int get_event_fd(const PortId id);
     void handle_data_from_below(const PortId id, Data& data);
+    void handle_data_from_below(const PortId id, std::shared_ptr<Data> data);
     void set_data_transmitted(const FlowId id);
 
-    void handle_data_from_above(std::shared_ptr<Data> data, const FlowId id);
+    void handle_data_from_above(std::shared_ptr<Data>&& data, const FlowId id);
+    void handle_data_from_above(std::shared_ptr<Data>&& data, const FlowId id, const uint32_t deadline);
+    void handle_data_from_above_batch(std::vector<std::shared_ptr<Data> >&& data, const FlowId id);
     bool has_data_for_above(const FlowId id);
     std::shared_ptr<Data> get_data_for_above(const FlowId id);
+    size_t get_data_for_above_batch(const FlowId id, std::vector<std::shared_ptr<Data> >& data, const size_t max);
+    void register_receive_handler(const FlowId id, ReceiveHandler handler);
 
     FlowStats get_stats(const FlowId id);
 
@@ -57,9 +67,14 @@ private:
     GdtpImpl(const GdtpImpl&); // non-copyable ('= delete' in C++11)
     GdtpImpl& operator=(const GdtpImpl&); // non-copyable ('= delete' in C++11)
     static std::string get_name(void) { return "GdtpImpl"; }
+    void handle_pdus_from_below(const PortId id, PduVector& pdus);
+    void encode_pdus(PduVector& pdus, Data& data);
 
     std::unique_ptr<FlowManager> manager_;
     EncoderStats stats_;
+    std::shared_ptr<PayloadPool> pool_;
+    std::unique_ptr<CodecBase> codec_;
+    bool initialized_; ///< the codec is fixed from now on
 
     DECLARE_LOGPTR(logger_)
 };
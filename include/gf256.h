@@ -0,0 +1,75 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef GF256_H
+#define GF256_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+namespace libgdtp
+{
+
+/**
+ * Arithmetic in GF(2^8) with the polynomial x^8 + x^4 + x^3 + x^2 + 1 (0x11d).
+ *
+ * Addition is XOR, multiplication uses log/exp tables. The region operation
+ * dominates FEC coding and is vectorised with SSSE3 or AVX2 (pshufb on the
+ * two nibbles of each byte) if the CPU supports it. The best implementation
+ * is picked at runtime, the scalar one is always available.
+ */
+class Gf256
+{
+public:
+    typedef enum
+    {
+        SCALAR = 0,
+        SSSE3,
+        AVX2
+    } Impl;
+
+    static uint8_t mul(const uint8_t a, const uint8_t b);
+
+    /**
+     * @brief Multiplicative inverse, a must not be zero.
+     */
+    static uint8_t inv(const uint8_t a);
+
+    /**
+     * @brief dst[i] ^= c * src[i] for len bytes, using the best implementation.
+     */
+    static void mul_add_region(uint8_t* dst, const uint8_t* src, const uint8_t c, const size_t len);
+
+    /**
+     * @brief Same as above with a specific implementation, it must be supported.
+     */
+    static void mul_add_region(uint8_t* dst, const uint8_t* src, const uint8_t c, const size_t len, const Impl impl);
+
+    static bool is_supported(const Impl impl);
+    static Impl get_best_impl(void);
+    static std::string get_impl_as_string(const Impl impl);
+};
+
+} // namespace libgdtp
+
+#endif // GF256_H
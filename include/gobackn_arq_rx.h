@@ -0,0 +1,66 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*! \brief Receive side of a Go-Back-N ARQ.
+ *
+ * The receiver only accepts the next expected PDU and discards everything
+ * else, so no reorder buffer is needed. Each DATA PDU is answered with a
+ * cumulative ACK carrying the seqno of the last in-order PDU.
+ */
+
+#ifndef GOBACKN_ARQ_RX_H
+#define GOBACKN_ARQ_RX_H
+
+#include <atomic>
+#include "arq_base.h"
+#include "logger.h"
+
+namespace libgdtp {
+
+class FlowBase;
+
+class GoBackNArqRx : public ArqBase
+{
+public:
+    GoBackNArqRx(FlowBase* flow, size_t buffer_size);
+    ~GoBackNArqRx(void);
+
+    void handle_pdu_from_below(Pdu&& pdu);
+    void frame_transmitted() {};
+
+private:
+    // member functions
+    void handle_data_pdu(Pdu& pdu);
+    void handle_skip_pdu(Pdu& pdu);
+    void update_ack(Pdu& ack);
+    static std::string get_name(void) { return "GoBackNArqRx"; }
+
+    // member variables
+    std::atomic<SeqNo> expected_seq_no_; ///< expected seqno of next PDU
+    bool nack_sent_; ///< the expected PDU has been NACKed already
+
+    DECLARE_LOGPTR(logger_)
+};
+
+}
+
+#endif // GOBACKN_ARQ_RX_H
@@ -0,0 +1,82 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*! \brief Transmit side of a Go-Back-N ARQ.
+ *
+ * Up to window_size PDUs may be outstanding at the same time. The receiver
+ * acknowledges cumulatively, hence only a single timer for the oldest
+ * outstanding PDU is used. If it expires, all outstanding PDUs are sent again.
+ */
+
+#ifndef GOBACKN_ARQ_TX_H
+#define GOBACKN_ARQ_TX_H
+
+#include <deque>
+#include "arq_base.h"
+#include "arq_executor.h"
+#include "logger.h"
+
+namespace libgdtp {
+
+class FlowBase;
+
+class GoBackNArqTx : public ArqBase
+{
+public:
+    GoBackNArqTx(FlowBase* flow, size_t buffer_size);
+    ~GoBackNArqTx(void);
+
+    void handle_pdu_from_below(Pdu&& pdu);
+    void frame_transmitted();
+
+private:
+    ///< A PDU inside the transmit window
+    typedef struct
+    {
+        Pdu pdu;
+        bool transmitted;
+        bool retransmitted; ///< excluded from RTT measurement
+        boost::system_time tx_time; ///< last transmission
+    } TxSlot;
+
+    // member functions
+    void service_buffer(void);
+    void handle_ack_pdu(Pdu& pdu);
+    void handle_nack_pdu(Pdu& pdu, PduVector& pdus);
+    void fill_window(PduVector& pdus);
+    void handle_timeout(const ArqExecutor::TimerId id);
+    void retransmit_window(PduVector& pdus, const bool fast);
+    void restart_timer(void);
+    void stop_timer(void);
+    void transmit_pdus(PduVector& pdus, const bool wait = true);
+    static std::string get_name(void) { return "GoBackNArqTx"; }
+
+    // member variables
+    std::deque<TxSlot> window_; ///< outstanding PDUs, ordered by seqno
+    ArqExecutor::TimerId timer_id_; ///< timer of the oldest PDU, zero if not running
+    uint32_t num_timeouts_; ///< consecutive timeouts of the oldest PDU
+    DECLARE_LOGPTR(logger_)
+};
+
+}
+
+#endif // GOBACKN_ARQ_TX_H
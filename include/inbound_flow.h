@@ -25,6 +25,9 @@
 
 #include "flow_base.h"
 #include "stopwait_arq_rx.h"
+#include "selectiverepeat_arq_rx.h"
+#include "gobackn_arq_rx.h"
+#include "fec_decoder.h"
 
 namespace libgdtp
 {
@@ -50,20 +53,42 @@ public:
                          above_port_name,
                          below_port_name,
                          INBOUND,
-                         buffer_size)
+                         buffer_size),
+          fec_active_(false)
     {
-        arq_ = std::unique_ptr<StopWaitArqRx>(new StopWaitArqRx(this, buffer_size));
+        switch (props.get_arq_type()) {
+        case SELECTIVE_REPEAT:
+            arq_ = std::unique_ptr<SelectiveRepeatArqRx>(new SelectiveRepeatArqRx(this, buffer_size));
+            break;
+        case GO_BACK_N:
+            arq_ = std::unique_ptr<GoBackNArqRx>(new GoBackNArqRx(this, buffer_size));
+            break;
+        case STOP_AND_WAIT:
+        default:
+            arq_ = std::unique_ptr<StopWaitArqRx>(new StopWaitArqRx(this, buffer_size));
+        }
+
+        // otherwise the decoder is created with the first repair PDU
+        if (props.get_fec_data_pdus() > 0) {
+            fec_decoder_.reset(new FecDecoder());
+            fec_active_ = true;
+        }
     }
     ~InboundFlow() {}
     void print_status(void);
-    void handle_frame_from_below(Pdu& pdu);
+    void handle_frame_from_below(Pdu&& pdu);
     void frame_transmitted(void);
 
 private:
     // member functions
+    void handle_repair_pdu(Pdu&& pdu);
+    void deliver_pdu(Pdu&& pdu);
     static std::string get_name(void) { return "InboundFlow"; }
 
     // member variables
+    std::unique_ptr<FecDecoder> fec_decoder_; ///< NULL until FEC is used
+    std::atomic<bool> fec_active_; ///< spares DATA PDUs the FEC mutex as long as there is no decoder
+    std::mutex fec_mutex_;
     DECLARE_LOGPTR(logger_)
 };
 
@@ -29,6 +29,7 @@
 #ifndef LIBGDTP_H
 #define LIBGDTP_H
 
+#include <functional>
 #include <memory>
 #include <vector>
 #include <string>
@@ -46,6 +47,7 @@ typedef uint32_t FlowId;          ///< Flow identifier
 typedef uint32_t PortId;          ///< Identifier used for lower and upper layer ports
 typedef uint64_t Addr;            ///< Address identifier
 typedef uint64_t SeqNo;           ///< Sequence number type
+typedef std::function<void(std::shared_ptr<Data>)> ReceiveHandler; ///< Callback for data received on a flow
 
 ///< Statistics for data handled by an ARQ
 typedef struct
@@ -55,9 +57,18 @@ typedef struct
     uint32_t pdus_from_below;
     uint32_t pdus_for_below;
     uint32_t rtx_pdus;
+    uint32_t fast_rtx_pdus; ///< retransmissions requested by a NACK or SACK before the ACK timer expired
+    uint32_t timeout_rtx_pdus; ///< retransmissions caused by an expired ACK timer
     uint32_t lost_pdus;
     uint32_t bytes_from_above;
     uint32_t bytes_for_above;
+    uint32_t dropped_late; ///< PDUs dropped instead of (re)transmitted because their deadline has passed
+    float tokens; ///< current fill level of the token bucket in bytes (rate limited flows only)
+    float srtt; ///< smoothed round-trip time in ms (adaptive RTO only)
+    uint32_t rto; ///< current ACK timeout in ms, including backoff
+    uint32_t piggybacked_acks; ///< ACKs carried by DATA of the reverse direction instead of an own PDU
+    uint32_t repair_pdus; ///< FEC repair PDUs sent (outbound) or received (inbound)
+    uint32_t recovered_pdus; ///< PDUs reconstructed from FEC repair PDUs (inbound only)
     float fer;
 } ArqStats;
 
@@ -70,6 +81,10 @@ typedef struct
     uint32_t bytes_for_below;
     uint32_t frames_for_below;
     uint32_t frames_from_below;
+    uint32_t pdus_for_below; ///< PDUs encoded into frames for below
+    float aggregation_factor; ///< average number of PDUs per frame for below
+    uint32_t heap_allocations; ///< payload buffers and control blocks taken from the heap
+    uint32_t pool_allocations; ///< payload buffers and control blocks recycled by the payload pool
 } EncoderStats;
 
 ///< Both stats combined
@@ -106,7 +121,11 @@ public:
      * \brief Set the scheduler to be used by the lower layer interface.
      *
      * This function configures the type of scheduler to be used by the lower
-     * layer interface.
+     * layer interface. Calling it for an unknown port adds another lower layer
+     * port with its own scheduler, flows are bound to it by means of
+     * FlowProperties::set_below_port(). The scheduler of a port can't be
+     * changed once flows use the port. All schedulers have to be set before
+     * initialize(), afterwards the call throws a ParameterException.
      *
      * @param type The actual scheduler
      * @param port The lower layer port of which the scheduler should be set
@@ -114,6 +133,34 @@ public:
      */
     void set_scheduler_type(const std::string type, const PortId port = DEFAULT_BELOW_PORT_ID);
 
+    /**
+     * \brief Limit the size of frames built by an aggregating scheduler.
+     *
+     * PDUs of several flows are packed into one frame as long as their payload
+     * fits into max_bytes. If the frame isn't full, the scheduler waits up to
+     * max_wait milliseconds for more PDUs. Only valid for the "aggregate"
+     * scheduler, hence set_scheduler_type() has to be called first.
+     *
+     * @param max_bytes The payload byte budget of a frame
+     * @param max_wait The time in ms to wait for further PDUs, zero to never wait
+     * @param port The lower layer port of which the scheduler should be configured
+     *
+     */
+    void set_aggregation_limits(const size_t max_bytes, const uint32_t max_wait = 0, const PortId port = DEFAULT_BELOW_PORT_ID);
+
+    /**
+     * \brief Set the codec used to encode frames for the lower layer.
+     *
+     * Both peers need to use the same codec. The default is "protobuf", "binary"
+     * selects a packed fixed-layout header that is considerably cheaper to process.
+     * The codec has to be set before initialize(), afterwards the call throws a
+     * ParameterException.
+     *
+     * @param type The codec, either "protobuf" or "binary"
+     *
+     */
+    void set_codec_type(const std::string type);
+
     /**
      * \brief Set the default source and destination address to be used for flows.
      *
@@ -140,6 +187,11 @@ public:
 
     /**
      * @brief Modify the properties of a flow during runtime.
+     *
+     * The below port, striping, ARQ type, window size, seqno space and FEC
+     * are fixed when the flow is allocated, changing them throws a
+     * ParameterException.
+     *
      * @param id The ID of the flow.
      * @param props Flow properties
      */
@@ -157,7 +209,39 @@ public:
      * @param sdu A shared pointer to the data provided.
      * @param id The ID of the flow.
      */
-    void handle_data_from_above(std::shared_ptr<Data> data, const FlowId id);
+    void handle_data_from_above(const std::shared_ptr<Data>& data, const FlowId id);
+
+    /**
+     * @brief Handle data from an upper layer component and take over the
+     * caller's reference, which avoids touching the reference count.
+     * @param sdu A shared pointer to the data provided.
+     * @param id The ID of the flow.
+     */
+    void handle_data_from_above(std::shared_ptr<Data>&& data, const FlowId id);
+
+    /**
+     * @brief Handle data from an upper layer component that has to be
+     * transmitted within a given time, otherwise it is dropped.
+     * @param sdu A shared pointer to the data provided.
+     * @param id The ID of the flow.
+     * @param deadline The deadline in ms from now.
+     */
+    void handle_data_from_above(const std::shared_ptr<Data>& data, const FlowId id, const uint32_t deadline);
+
+    /**
+     * @brief Same as above, but takes over the caller's reference.
+     */
+    void handle_data_from_above(std::shared_ptr<Data>&& data, const FlowId id, const uint32_t deadline);
+
+    /**
+     * @brief Handle a burst of data from an upper layer component.
+     * The flow is looked up and locked only once and the SDUs are queued
+     * with as few notifications as possible. Blocks while the flow's
+     * buffer is full, just like handle_data_from_above().
+     * @param data The SDUs in transmission order, the vector is emptied.
+     * @param id The ID of the flow.
+     */
+    void handle_data_from_above_batch(std::vector<std::shared_ptr<Data> >&& data, const FlowId id);
 
     /**
      * @brief Handle data from an lower layer component
@@ -166,6 +250,15 @@ public:
      */
     void handle_data_from_below(const PortId id, Data& data);
 
+    /**
+     * @brief Handle data from an lower layer component and take ownership of it.
+     * Depending on the codec, the buffer is handed up as payload without copying,
+     * hence the caller must not reuse or modify it afterwards.
+     * @param id The ID of the port.
+     * @param data A shared pointer to the data provided.
+     */
+    void handle_data_from_below(const PortId id, std::shared_ptr<Data> data);
+
     /**
      * @brief Query whether there is data to be transmitted or not.
      * @param id The ID of the port.
@@ -179,6 +272,25 @@ public:
      */
     void get_data_for_below(const FlowId id, Data& data);
 
+    /**
+     * @brief Retrieve the data to be transmitted on a given port without blocking.
+     * Aggregating schedulers don't wait for further PDUs either.
+     * @param id The ID of the port.
+     * @param data A reference to a data object to be filled.
+     * @return False if no data is pending, data is left untouched then.
+     */
+    bool try_get_data_for_below(const PortId id, Data& data);
+
+    /**
+     * @brief Get a file descriptor that is readable while data is pending on a port.
+     * The descriptor can be added to select(), poll() or epoll (level-triggered).
+     * It is owned by libgdtp, callers must neither read from nor close it.
+     * Only available on Linux.
+     * @param id The ID of the port.
+     * @return The eventfd of the port.
+     */
+    int get_event_fd(const PortId id);
+
     /**
      * @brief Inform libgdtp that data has actually been transmitted.
      * @param id The flow ID the data belongs to.
@@ -199,6 +311,31 @@ public:
      */
     std::shared_ptr<Data> get_data_for_above(const FlowId id);
 
+    /**
+     * @brief Retrieve a burst of data received on a flow.
+     * Blocks until at least one SDU is available.
+     * @param id The ID of the flow.
+     * @param data A vector the SDUs are appended to.
+     * @param max The maximum number of SDUs to retrieve.
+     * @return The number of SDUs appended.
+     */
+    size_t get_data_for_above_batch(const FlowId id, std::vector<std::shared_ptr<Data> >& data, const size_t max);
+
+    /**
+     * @brief Deliver data received on a flow to a callback instead of queueing it.
+     *
+     * The handler is invoked directly from the receive path, i.e. on the thread
+     * that calls handle_data_from_below(), once per SDU and in the order the SDUs
+     * are delivered by the ARQ. For reliable flows it runs while the ARQ of the
+     * flow is locked, hence it should return quickly and must not feed data from
+     * below itself. Handlers of different flows may run concurrently if several
+     * threads feed data from below. SDUs that have been queued before the handler
+     * was registered remain available via get_data_for_above().
+     * @param id The ID of the flow.
+     * @param handler The callback, an empty function unregisters the current one.
+     */
+    void register_receive_handler(const FlowId id, ReceiveHandler handler);
+
 private:
     // non-copyable
     Gdtp(const Gdtp&) = delete;
@@ -60,7 +60,7 @@ public:
      * \param source reference to the source address to be filled
      * \param destination reference to the destination address to be filled
      */
-    static void get_ipv4_addresses(std::shared_ptr<Data> sdu, uint32_t &source, uint32_t &destination)
+    static void get_ipv4_addresses(const std::shared_ptr<Data>& sdu, uint32_t &source, uint32_t &destination)
     {
         assert(sdu->size() > sizeof(struct ip));
         const struct ether_header* ethernet_header = (struct ether_header*)sdu->data();;
@@ -31,6 +31,11 @@
 
 #include "flow_base.h"
 #include "stopwait_arq_tx.h"
+#include "selectiverepeat_arq_tx.h"
+#include "gobackn_arq_tx.h"
+#include "stripe_lane.h"
+#include "fec_encoder.h"
+#include <condition_variable>
 
 namespace libgdtp
 {
@@ -57,24 +62,77 @@ public:
                          below_port_name,
                          OUTGOING,
                          buffer_size),
-          seq_no_(0)
+          seq_no_(0),
+          fec_draining_(false),
+          fec_added_(0),
+          fec_queued_(0)
     {
-        arq_ = std::unique_ptr<StopWaitArqTx>(new StopWaitArqTx(this, buffer_size));
+        switch (props.get_arq_type()) {
+        case SELECTIVE_REPEAT:
+            arq_ = std::unique_ptr<SelectiveRepeatArqTx>(new SelectiveRepeatArqTx(this, buffer_size));
+            break;
+        case GO_BACK_N:
+            arq_ = std::unique_ptr<GoBackNArqTx>(new GoBackNArqTx(this, buffer_size));
+            break;
+        case STOP_AND_WAIT:
+        default:
+            arq_ = std::unique_ptr<StopWaitArqTx>(new StopWaitArqTx(this, buffer_size));
+        }
+
+        if (props.get_striping_mode() != NO_STRIPING) {
+            for (auto& port : props.get_stripe_ports()) {
+                lanes_.emplace_back(new StripeLane(manager, this, src_id, dest_id, source, destination,
+                                                   props, above_port_name, port.first, buffer_size));
+                lane_credits_.push_back(0);
+            }
+        }
+
+        if (props.get_fec_data_pdus() > 0) {
+            fec_encoder_.reset(new FecEncoder(props.get_fec_data_pdus(), props.get_fec_repair_pdus()));
+        }
     }
-    ~OutboundFlow() {}
+    ~OutboundFlow();
 
-    void handle_frame_from_above(std::shared_ptr<Data> Data);
-    void handle_frame_from_below(Pdu& pdu);
+    void handle_frame_from_above(std::shared_ptr<Data>&& sdu, boost::posix_time::ptime deadline);
+    void handle_frames_from_above(std::vector<std::shared_ptr<Data> >& sdus, boost::posix_time::ptime deadline);
+    void handle_frame_from_below(Pdu&& pdu);
     void print_status(void);
     void frame_transmitted(void);
+    void frame_taken_for_below(const Pdu& pdu);
+    void queue_pdu_for_below(Pdu&& pdu);
+    void queue_pdu_for_below_nowait(Pdu&& pdu);
+    void set_properties(FlowProperties props);
+
+    /**
+     * @brief Return the per-port lanes of a striped flow, empty if the flow isn't striped.
+     */
+    std::vector<FlowBase*> get_stripe_lanes(void);
 
 private:
     // member functions
     SeqNo get_next_seq_no(void);
+    Pdu make_pdu(std::shared_ptr<Data>&& sdu, boost::posix_time::ptime deadline);
+    StripeLane* select_lane(void);
+    uint64_t add_fec_pdu(Pdu&& pdu);
+    void add_repair_pdus(PduVector& repairs);
+    void queue_fec_pdus(const uint64_t count, const bool wait);
+    void handle_fec_timeout(const uint32_t block_id);
     static std::string get_name(void) { return "OutboundFlow"; }
 
     // member variables
     std::atomic<SeqNo> seq_no_;
+    std::vector<std::unique_ptr<StripeLane> > lanes_; ///< one lane per stripe port, ordered by port
+    std::vector<int64_t> lane_credits_; ///< current credits of the lanes (weighted round-robin)
+    std::mutex stripe_mutex_;
+    std::unique_ptr<FecEncoder> fec_encoder_; ///< NULL if FEC is disabled
+    std::mutex fec_mutex_; ///< guards the encoder and the PDUs waiting to be queued, never held while queueing
+    std::deque<Pdu> fec_pending_; ///< PDUs in block order, repairs follow the data of their block
+    bool fec_draining_; ///< a thread is moving fec_pending_ to the buffer
+    uint64_t fec_added_; ///< PDUs ever added to fec_pending_
+    uint64_t fec_queued_; ///< PDUs ever moved from fec_pending_ to the buffer
+    std::condition_variable fec_queued_cond_;
+    std::deque<bool> taken_repairs_; ///< whether the PDUs taken by the scheduler were repairs, oldest first
+    std::mutex taken_mutex_;
     Buffer<Pdu> buffer_from_above_;
     DECLARE_LOGPTR(logger_)
 };
@@ -0,0 +1,125 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef PAYLOAD_POOL_H
+#define PAYLOAD_POOL_H
+
+#include <memory>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+#include "libgdtp.h"
+
+namespace libgdtp
+{
+
+/**
+ * A pool for payload buffers of received PDUs.
+ *
+ * Released buffers keep their capacity and are handed out again, the
+ * control blocks of the shared pointers are recycled from a free list
+ * as well. Once the pool has warmed up, allocating a payload doesn't
+ * touch the heap anymore.
+ *
+ * Payloads may outlive the Gdtp instance, hence the pool is reference
+ * counted and kept alive by all payloads it handed out.
+ */
+class PayloadPool : public std::enable_shared_from_this<PayloadPool>, boost::noncopyable
+{
+public:
+    typedef struct
+    {
+        uint32_t heap_allocations; ///< buffers and control blocks allocated from the heap
+        uint32_t pool_allocations; ///< buffers and control blocks served from the pool
+    } Stats;
+
+    explicit PayloadPool(const size_t max_free = 1024);
+    ~PayloadPool();
+
+    /**
+     * @brief Get a buffer with the given size, its content is undefined.
+     */
+    std::shared_ptr<Data> allocate(const size_t size);
+
+    /**
+     * @brief Get a buffer holding a copy of [begin, end).
+     */
+    std::shared_ptr<Data> allocate(const uint8_t* begin, const uint8_t* end);
+
+    Stats get_stats(void);
+
+private:
+    /**
+     * Allocator for the control blocks of the shared pointers. It keeps the
+     * pool alive until the last control block has been released.
+     */
+    template<class T>
+    class BlockAllocator
+    {
+    public:
+        typedef T value_type;
+
+        explicit BlockAllocator(std::shared_ptr<PayloadPool> pool) : pool_(pool) {}
+        template<class U>
+        BlockAllocator(const BlockAllocator<U>& other) : pool_(other.pool_) {}
+
+        T* allocate(const size_t n)
+        {
+            return static_cast<T*>(pool_->allocate_block(n * sizeof(T)));
+        }
+        void deallocate(T* p, const size_t n)
+        {
+            pool_->release_block(p, n * sizeof(T));
+        }
+
+        template<class U>
+        bool operator==(const BlockAllocator<U>& other) const { return pool_ == other.pool_; }
+        template<class U>
+        bool operator!=(const BlockAllocator<U>& other) const { return pool_ != other.pool_; }
+
+        std::shared_ptr<PayloadPool> pool_;
+    };
+
+    class Deleter
+    {
+    public:
+        explicit Deleter(PayloadPool* pool) : pool_(pool) {}
+        void operator()(Data* data) { pool_->release(data); }
+    private:
+        PayloadPool* pool_;
+    };
+
+    void release(Data* data);
+    void* allocate_block(const size_t size);
+    void release_block(void* block, const size_t size);
+
+    const size_t max_free_;
+    size_t block_size_; ///< size of control blocks, set on first use
+    std::vector<Data*> free_buffers_;
+    std::vector<void*> free_blocks_;
+    Stats stats_;
+    boost::mutex mutex_;
+};
+
+} // namespace libgdtp
+
+#endif // PAYLOAD_POOL_H
@@ -23,6 +23,8 @@
 #ifndef PDU_H
 #define PDU_H
 
+#include <atomic>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 #include "libgdtp.h"
 
 namespace libgdtp
@@ -32,59 +34,99 @@ class Pdu;
 
 typedef std::vector<Pdu> PduVector;
 
-enum Type { DATA, ACK, BROADCAST };
+enum Type { DATA, ACK, BROADCAST, NACK, REPAIR, SKIP };
 
 class Pdu
 {
 public:
     Pdu() :
-        payload_(new Data),
+        payload_(get_empty_payload()),
         type_(DATA),
-        seqno_(0)
+        seqno_(0),
+        sack_(0),
+        ack_seqno_(0),
+        piggyback_ack_(false),
+        deadline_(boost::posix_time::pos_infin)
     {}
 
     Pdu(std::shared_ptr<Data> sdu) :
-        payload_(sdu),
+        payload_(std::move(sdu)),
         type_(DATA),
-        seqno_(0)
+        seqno_(0),
+        sack_(0),
+        ack_seqno_(0),
+        piggyback_ack_(false),
+        deadline_(boost::posix_time::pos_infin)
     {}
 
+    /**
+     * Payload shared by all PDUs without data (e.g., ACKs), must not be modified.
+     */
+    static std::shared_ptr<Data> get_empty_payload(void)
+    {
+        static std::shared_ptr<Data> empty(new Data);
+        return empty;
+    }
+
     Data* get_payload_ptr(void)
     {
         return payload_.get();
     }
 
-    std::shared_ptr<Data> get_payload(void)
+    /**
+     * Number of payload reference count operations caused by copying PDUs.
+     * Only counted if built with GDTP_COUNT_REF_OPS.
+     */
+    static std::atomic<uint64_t>& get_ref_ops(void)
+    {
+        static std::atomic<uint64_t> ref_ops(0);
+        return ref_ops;
+    }
+
+    const std::shared_ptr<Data>& get_payload(void) const
     {
         return payload_;
     }
 
-    FlowId get_src_id(void)
+    /**
+     * Hand the payload over to the caller, the PDU is left without payload.
+     */
+    std::shared_ptr<Data> release_payload(void)
+    {
+        return std::move(payload_);
+    }
+
+    void set_payload(std::shared_ptr<Data> payload)
+    {
+        payload_ = std::move(payload);
+    }
+
+    FlowId get_src_id(void) const
     {
         return src_id_;
     }
 
-    FlowId get_dest_id(void)
+    FlowId get_dest_id(void) const
     {
         return dest_id_;
     }
 
-    Addr get_source_addr(void)
+    Addr get_source_addr(void) const
     {
         return source_addr_;
     }
 
-    Addr get_dest_addr(void)
+    Addr get_dest_addr(void) const
     {
         return dest_addr_;
     }
 
-    SeqNo get_seq_no(void)
+    SeqNo get_seq_no(void) const
     {
         return seqno_;
     }
 
-    Type get_type(void)
+    Type get_type(void) const
     {
         return type_;
     }
@@ -98,6 +140,15 @@ public:
         case ACK:
             return "ACK";
             break;
+        case NACK:
+            return "NACK";
+            break;
+        case REPAIR:
+            return "REPAIR";
+            break;
+        case SKIP:
+            return "SKIP";
+            break;
         default:
             return "UNKNOWN";
         }
@@ -123,6 +174,59 @@ public:
         type_ = type;
     }
 
+    /**
+     * Selective ACK bitmap of an ACK PDU, bit i acknowledges seqno + 1 + i.
+     * For a NACK PDU, bit i requests seqno + 1 + i in addition to seqno.
+     */
+    uint64_t get_sack(void) const
+    {
+        return sack_;
+    }
+
+    void set_sack(const uint64_t sack)
+    {
+        sack_ = sack;
+    }
+
+    /**
+     * ACK for the reverse direction carried by a DATA PDU, the SACK bitmap
+     * belongs to it then.
+     */
+    bool has_piggyback_ack(void) const
+    {
+        return piggyback_ack_;
+    }
+
+    SeqNo get_ack_seq_no(void) const
+    {
+        return ack_seqno_;
+    }
+
+    void set_piggyback_ack(const SeqNo no, const uint64_t sack)
+    {
+        ack_seqno_ = no;
+        sack_ = sack;
+        piggyback_ack_ = true;
+    }
+
+    /**
+     * Point in time after which the PDU is worthless, local only and not encoded.
+     */
+    const boost::posix_time::ptime& get_deadline(void) const
+    {
+        return deadline_;
+    }
+
+    bool is_expired(const boost::posix_time::ptime& now) const
+    {
+        return now > deadline_;
+    }
+
+    void set_deadline(const boost::posix_time::ptime& deadline)
+    {
+        deadline_ = deadline;
+    }
+
     void set_src_id(const FlowId id)
     {
         src_id_ = id;
@@ -140,7 +244,22 @@ private:
     Addr dest_addr_;
     Type type_;
     SeqNo seqno_;
+    uint64_t sack_;
+    SeqNo ack_seqno_;
+    bool piggyback_ack_;
     std::shared_ptr<Data> payload_;
+    boost::posix_time::ptime deadline_;
+#ifdef GDTP_COUNT_REF_OPS
+    // a copy increments the payload reference count and decrements it again later
+    struct RefOpCounter
+    {
+        RefOpCounter() {}
+        RefOpCounter(const RefOpCounter&) { get_ref_ops() += 2; }
+        RefOpCounter(RefOpCounter&&) {}
+        RefOpCounter& operator=(const RefOpCounter&) { get_ref_ops() += 2; return *this; }
+        RefOpCounter& operator=(RefOpCounter&&) { return *this; }
+    } ref_op_counter_;
+#endif
 };
 
 } // namespace libgdtp
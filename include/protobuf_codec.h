@@ -24,17 +24,18 @@
 #define PROTOBUF_ENCODER_H
 
 #include <boost/lexical_cast.hpp>
-#include "libgdtp.h"
-#include "pdu.h"
+#include "codec_base.h"
 #include "gdtp.pb.h"
 #include "exceptions.h"
 
 namespace libgdtp
 {
 
-class ProtobufCodec
+class ProtobufCodec : public CodecBase
 {
 public:
+    using CodecBase::decode;
+
     /**
      * Encode an outgoing PDU into a valid lower layer SDU.
      *
@@ -42,11 +43,11 @@ public:
      * \param lower_layer_sdu Reference to a Sdu object
      * \return void
      */
-    static void encode(PduVector& pdus, Data& lower_layer_sdu)
+    void encode(PduVector& pdus, Data& lower_layer_sdu)
     {
         GdtpFrame frame;
 
-        for (Pdu i : pdus) {
+        for (Pdu& i : pdus) {
             GdtpPdu* protopdu = frame.add_pdu();
             try {
                 protopdu->set_source(boost::lexical_cast<uint64_t>(i.get_source_addr()));
@@ -54,6 +55,10 @@ public:
                 protopdu->set_src_id(boost::lexical_cast<uint32_t>(i.get_src_id()));
                 protopdu->set_dest_id(boost::lexical_cast<uint32_t>(i.get_dest_id()));
                 protopdu->set_seqno(i.get_seq_no());
+                if (i.get_sack() != 0)
+                    protopdu->set_sack(i.get_sack());
+                if (i.has_piggyback_ack())
+                    protopdu->set_ack_seqno(i.get_ack_seq_no());
             }
             catch( const boost::bad_lexical_cast & ) {
                 throw GdtpException("Error while converting protocol fields.");
@@ -71,14 +76,23 @@ public:
             case ACK:
                 protopdu->set_type(GdtpPdu::ACK);
                 break;
+            case NACK:
+                protopdu->set_type(GdtpPdu::NACK);
+                break;
+            case REPAIR:
+                protopdu->set_type(GdtpPdu::REPAIR);
+                break;
+            case SKIP:
+                protopdu->set_type(GdtpPdu::SKIP);
+                break;
             }
             // copy payload from shared object
-            protopdu->add_payload(&i.get_payload_ptr()->front(), i.get_payload_ptr()->size());
-
-            // serialize
-            lower_layer_sdu.resize(frame.ByteSize());
-            frame.SerializeWithCachedSizesToArray(&lower_layer_sdu.front());
+            protopdu->add_payload(i.get_payload_ptr()->data(), i.get_payload_ptr()->size());
         }
+
+        // serialize
+        lower_layer_sdu.resize(frame.ByteSize());
+        frame.SerializeWithCachedSizesToArray(lower_layer_sdu.data());
     }
 
 
@@ -90,10 +104,10 @@ public:
      * \param pdu Reference to a Pdu object
      * \return void
      */
-    static void decode(Data& lower_layer_sdu, PduVector& pdus)
+    void decode(Data& lower_layer_sdu, PduVector& pdus)
     {
         GdtpFrame frame;
-        if (not frame.ParseFromArray((const void*)&lower_layer_sdu.front(), lower_layer_sdu.size())) {
+        if (not frame.ParseFromArray((const void*)lower_layer_sdu.data(), lower_layer_sdu.size())) {
             throw DecodeException("Decoding frame failed.");
         }
 
@@ -108,6 +122,9 @@ public:
             pdu.set_src_id(protopdu->src_id());
             pdu.set_dest_id(protopdu->dest_id());
             pdu.set_seq_no(protopdu->seqno());
+            pdu.set_sack(protopdu->sack());
+            if (protopdu->has_ack_seqno())
+                pdu.set_piggyback_ack(protopdu->ack_seqno(), protopdu->sack());
             switch (protopdu->type())
             {
             default:
@@ -120,14 +137,25 @@ public:
             case GdtpPdu::ACK:
                 pdu.set_type(ACK);
                 break;
+            case GdtpPdu::NACK:
+                pdu.set_type(NACK);
+                break;
+            case GdtpPdu::REPAIR:
+                pdu.set_type(REPAIR);
+                break;
+            case GdtpPdu::SKIP:
+                pdu.set_type(SKIP);
+                break;
             }
 
             // copy payload into provided buffer
-            assert(protopdu->mutable_payload()->size() == 1);
-            std::string payload = protopdu->mutable_payload()->Get(0);
-            pdu.get_payload_ptr()->clear();
-            pdu.get_payload_ptr()->insert(pdu.get_payload_ptr()->end(), payload.c_str(), payload.c_str() + payload.size());
-            pdus.push_back(pdu);
+            if (protopdu->payload_size() != 1) {
+                throw DecodeException("Invalid number of payloads.");
+            }
+            const std::string& payload = protopdu->payload(0);
+            const uint8_t* begin = reinterpret_cast<const uint8_t*>(payload.data());
+            pdu.set_payload(make_payload(pdu.get_type(), begin, begin + payload.size()));
+            pdus.push_back(std::move(pdu));
         }
     }
 };
@@ -0,0 +1,74 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef RTT_ESTIMATOR_H
+#define RTT_ESTIMATOR_H
+
+#include <stdint.h>
+#include <boost/thread/thread_time.hpp>
+
+namespace libgdtp
+{
+
+/**
+ * Retransmission timeout estimation following Jacobson/Karels (RFC 6298).
+ *
+ * The smoothed RTT and its variation are updated from RTT samples, which
+ * must only be taken from PDUs that have not been retransmitted (Karn's
+ * algorithm). Each timeout doubles the RTO until the next valid sample.
+ * Not thread-safe, the ARQ serializes access.
+ */
+class RttEstimator
+{
+public:
+    RttEstimator();
+
+    /**
+     * @brief Update the estimate with the time between transmission and ACK.
+     */
+    void add_sample(const boost::posix_time::time_duration& rtt);
+
+    /**
+     * @brief Double the RTO after a timeout.
+     */
+    void backoff(void);
+
+    /**
+     * @brief Return the RTO in ms, initial is used until the first sample.
+     */
+    uint32_t get_rto(const uint32_t initial, const uint32_t min, const uint32_t max) const;
+
+    /**
+     * @brief Return the smoothed RTT in ms, zero without a sample.
+     */
+    double get_srtt(void) const { return srtt_; }
+
+private:
+    bool has_sample_;
+    double srtt_; ///< smoothed RTT in ms
+    double rttvar_; ///< RTT variation in ms
+    uint32_t num_backoffs_; ///< timeouts since the last valid sample
+};
+
+} // namespace libgdtp
+
+#endif // RTT_ESTIMATOR_H
@@ -24,6 +24,7 @@
 #define SCHEDULER_BASE_H
 
 #include "flow_base.h"
+#include <atomic>
 #include <unordered_set>
 
 namespace libgdtp
@@ -33,23 +34,37 @@ class SchedulerBase : boost::noncopyable
 {
 public:
     SchedulerBase() :
-        flow_(NULL)
+        flow_(NULL),
+        event_fd_(-1),
+        event_set_(false)
     {}
-    virtual ~SchedulerBase() {}
+    virtual ~SchedulerBase();
     virtual void add_flow(FlowBase*) = 0;
+    virtual void flow_modified(FlowBase*) {} ///< called after the properties of a flow have changed
     virtual bool has_waiting_flow(void) = 0;
     virtual void get_pdus_for_below(PduVector &pdus) = 0;
-    void set_pdus_transmitted(void);
+    virtual bool try_get_pdus_for_below(PduVector &pdus);
+    virtual void set_pdus_transmitted(void);
+    virtual void set_aggregation_limits(const size_t max_bytes, const uint32_t max_wait);
+
+    // The event fd is readable as long as flows are waiting, it is only created on request
+    int get_event_fd(void);
+    void signal_event_fd(void);
+    void update_event_fd(void);
 
 protected:
-    // This set holds the connection ids that are currently serviced by the scheduler
-    // This allow O(1) lookups if new connections get signalled
-    std::unordered_set<FlowId> serviced_flows_;
+    // This set holds the connections that are currently serviced by the scheduler
+    // This allow O(1) lookups if new connections get signalled. Flows are identified
+    // by their object, inbound flows may share the source id of a local outbound flow
+    std::unordered_set<FlowBase*> serviced_flows_;
     boost::mutex mutex_;
     boost::condition_variable not_empty_cond_;
     FlowBase* flow_; // holds the active flow
 
 private:
+    std::atomic<int> event_fd_;
+    std::atomic<bool> event_set_; ///< the event fd has been written since it was drained last
+
     virtual FlowBase* get_next_flow() = 0;
 };
 
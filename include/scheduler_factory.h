@@ -26,6 +26,10 @@
 #include "fifo_scheduler.h"
 #include "priority_scheduler.h"
 #include "implicitack_scheduler.h"
+#include "drr_scheduler.h"
+#include "wfq_scheduler.h"
+#include "edf_scheduler.h"
+#include "aggregate_scheduler.h"
 
 namespace libgdtp
 {
@@ -34,12 +38,20 @@ enum Scheduler
 {
     FIFO,
     PRIORITY,
-    IMPLICITACK
+    IMPLICITACK,
+    DRR,
+    WFQ,
+    EDF,
+    AGGREGATE
 };
 
 static std::map<std::string, Scheduler> scheduler_map_ = {{"fifo", FIFO},
                                                           {"priority", PRIORITY},
-                                                          {"implicitack", IMPLICITACK}};
+                                                          {"implicitack", IMPLICITACK},
+                                                          {"drr", DRR},
+                                                          {"wfq", WFQ},
+                                                          {"edf", EDF},
+                                                          {"aggregate", AGGREGATE}};
 
 class SchedulerFactory
 {
@@ -55,6 +67,14 @@ class SchedulerFactory
                     return std::unique_ptr<SchedulerBase>(new PriorityScheduler());
                 case IMPLICITACK:
                     return std::unique_ptr<SchedulerBase>(new ImplicitAckScheduler());
+                case DRR:
+                    return std::unique_ptr<SchedulerBase>(new DrrScheduler());
+                case WFQ:
+                    return std::unique_ptr<SchedulerBase>(new WfqScheduler());
+                case EDF:
+                    return std::unique_ptr<SchedulerBase>(new EdfScheduler());
+                case AGGREGATE:
+                    return std::unique_ptr<SchedulerBase>(new AggregateScheduler());
                 default:
                     throw GdtpException("Unknown scheduler type.");
             }
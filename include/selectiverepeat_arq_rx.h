@@ -0,0 +1,70 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*! \brief Receive side of a Selective-Repeat ARQ.
+ *
+ * Every DATA PDU inside the receive window is acknowledged individually.
+ * PDUs received out of order are held back in a reorder buffer and passed
+ * to the upper layer strictly in sequence.
+ */
+
+#ifndef SELECTIVEREPEAT_ARQ_RX_H
+#define SELECTIVEREPEAT_ARQ_RX_H
+
+#include <map>
+#include "arq_base.h"
+#include "logger.h"
+
+namespace libgdtp {
+
+class FlowBase;
+
+class SelectiveRepeatArqRx : public ArqBase
+{
+public:
+    SelectiveRepeatArqRx(FlowBase* flow, size_t buffer_size);
+    ~SelectiveRepeatArqRx(void);
+
+    void handle_pdu_from_below(Pdu&& pdu);
+    void frame_transmitted() {};
+
+private:
+    // member functions
+    void handle_data_pdu(Pdu& pdu);
+    void handle_skip_pdu(Pdu& pdu);
+    void update_ack(Pdu& ack);
+    void detect_gap(const SeqNo seq_no);
+    void advance_window(const SeqNo new_base);
+    void deliver_in_order(void);
+    static std::string get_name(void) { return "SelectiveRepeatArqRx"; }
+
+    // member variables
+    SeqNo rx_base_; ///< seqno of the next PDU to be passed up
+    std::map<SeqNo, Pdu> reorder_buffer_; ///< PDUs received ahead of rx_base_
+    SeqNo rx_next_; ///< one past the highest seqno received, missing PDUs below it have been NACKed already
+
+    DECLARE_LOGPTR(logger_)
+};
+
+}
+
+#endif // SELECTIVEREPEAT_ARQ_RX_H
@@ -0,0 +1,83 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*! \brief Transmit side of a Selective-Repeat ARQ.
+ *
+ * Up to window_size PDUs may be outstanding at the same time. Each PDU has
+ * its own retransmission timer that is started once the PDU has actually been
+ * transmitted and only PDUs that time out are retransmitted.
+ */
+
+#ifndef SELECTIVEREPEAT_ARQ_TX_H
+#define SELECTIVEREPEAT_ARQ_TX_H
+
+#include <deque>
+#include "arq_base.h"
+#include "arq_executor.h"
+#include "logger.h"
+
+namespace libgdtp {
+
+class FlowBase;
+
+class SelectiveRepeatArqTx : public ArqBase
+{
+public:
+    SelectiveRepeatArqTx(FlowBase* flow, size_t buffer_size);
+    ~SelectiveRepeatArqTx(void);
+
+    void handle_pdu_from_below(Pdu&& pdu);
+    void frame_transmitted();
+
+private:
+    ///< A PDU inside the transmit window
+    typedef struct
+    {
+        Pdu pdu;
+        uint32_t num_tx;
+        bool done; ///< acknowledged or given up
+        bool abandoned; ///< given up after it has been sent, the receiver may still wait for it
+        ArqExecutor::TimerId timer_id; ///< running retransmission timer, zero if none
+        uint32_t timeout; ///< duration of the running timer in ms
+        boost::system_time tx_time; ///< last transmission
+    } TxSlot;
+
+    // member functions
+    void service_buffer(void);
+    void handle_ack_pdu(Pdu& pdu, PduVector& pdus);
+    void handle_nack_pdu(Pdu& pdu, PduVector& pdus);
+    void fill_window(PduVector& pdus);
+    void handle_timeout(const ArqExecutor::TimerId id);
+    void transmit_pdus(PduVector& pdus, const bool wait = true);
+    void retransmit(TxSlot& slot, PduVector& pdus, const bool fast);
+    void slide_window(PduVector& pdus);
+    TxSlot* find_slot(const SeqNo seq_no);
+    static std::string get_name(void) { return "SelectiveRepeatArqTx"; }
+
+    // member variables
+    std::deque<TxSlot> window_; ///< outstanding PDUs, ordered by seqno
+    DECLARE_LOGPTR(logger_)
+};
+
+}
+
+#endif // SELECTIVEREPEAT_ARQ_TX_H
@@ -0,0 +1,232 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * A fixed-size single-producer/single-consumer ring buffer with the same
+ * interface as Buffer. Producer and consumer never share a lock, head and
+ * tail are kept on separate cache lines. A thread only blocks if the ring
+ * is full (producer) or empty (consumer), using a futex on Linux.
+ *
+ * Several producers (or consumers) may be used as long as they are
+ * serialized by an external lock.
+ */
+
+#ifndef SPSC_BUFFER_H
+#define SPSC_BUFFER_H
+
+#include <atomic>
+#include <vector>
+#include <utility>
+#include <boost/noncopyable.hpp>
+#include <boost/call_traits.hpp>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#else
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#endif
+
+#define SPSC_CACHE_LINE_SIZE 64
+
+template<class T>
+class SpscBuffer : boost::noncopyable
+{
+public:
+    typedef size_t size_type;
+    typedef T value_type;
+    typedef typename boost::call_traits<value_type>::param_type param_type;
+
+    explicit SpscBuffer(size_type capacity) :
+        capacity_(capacity),
+        slots_(capacity + 1),
+        head_(0),
+        tail_(0)
+    {}
+    explicit SpscBuffer() : SpscBuffer(10) {}
+
+    void pushBack(T const& data)
+    {
+        push(data);
+    }
+
+    void pushBack(T&& data)
+    {
+        push(std::move(data));
+    }
+
+    /**
+     * Push all elements of a range. Elements are published and the consumer
+     * is notified once per run of free slots instead of once per element.
+     * Blocks while the ring is full.
+     */
+    template<class Iterator>
+    void pushBackBatch(Iterator it, Iterator end)
+    {
+        size_type tail = tail_.load(std::memory_order_relaxed);
+        while (it != end) {
+            const size_type next = increment(tail);
+            if (next == head_.load(std::memory_order_acquire)) {
+                // publish what has been written so far before waiting for space
+                tail_.store(tail, std::memory_order_release);
+                notEmpty_.notify();
+                notFull_.wait([&] { return next != head_.load(std::memory_order_acquire); });
+            }
+            slots_[tail] = *it++;
+            tail = next;
+        }
+        tail_.store(tail, std::memory_order_release);
+        notEmpty_.notify();
+    }
+
+    bool tryPop(T& value)
+    {
+        const size_type head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        pop(head, value);
+        return true;
+    }
+
+    void popFront(T& value)
+    {
+        const size_type head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            notEmpty_.wait([&] { return head != tail_.load(std::memory_order_acquire); });
+        }
+        pop(head, value);
+    }
+
+    size_type size() const
+    {
+        const size_type head = head_.load(std::memory_order_acquire);
+        const size_type tail = tail_.load(std::memory_order_acquire);
+        return (tail + slots_.size() - head) % slots_.size();
+    }
+
+    size_type capacity() const { return capacity_; }
+
+    bool isEmpty() const { return size() == 0; }
+
+    bool isNotEmpty() const { return size() != 0; }
+
+private:
+    /**
+     * Wait/notify primitive for one direction. Notifying is a single
+     * atomic increment unless the other side is actually sleeping.
+     */
+    class Event : boost::noncopyable
+    {
+    public:
+        Event() : seq_(0), sleeping_(0) {}
+
+        template<class Predicate>
+        void wait(Predicate ready)
+        {
+            while (true) {
+                const uint32_t seq = seq_.load(std::memory_order_acquire);
+                sleeping_.store(1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (ready()) {
+                    sleeping_.store(0, std::memory_order_relaxed);
+                    return;
+                }
+#ifdef __linux__
+                syscall(SYS_futex, reinterpret_cast<int*>(&seq_), FUTEX_WAIT_PRIVATE, seq, NULL, NULL, 0);
+#else
+                boost::mutex::scoped_lock lock(mutex_);
+                while (seq_.load(std::memory_order_acquire) == seq) {
+                    cond_.wait(lock);
+                }
+#endif
+            }
+        }
+
+        void notify()
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            // only the first notification after the other side went to sleep needs a syscall
+            if (sleeping_.load(std::memory_order_relaxed) == 0 || sleeping_.exchange(0) == 0) {
+                return;
+            }
+#ifdef __linux__
+            seq_.fetch_add(1, std::memory_order_release);
+            syscall(SYS_futex, reinterpret_cast<int*>(&seq_), FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#else
+            boost::mutex::scoped_lock lock(mutex_);
+            seq_.fetch_add(1, std::memory_order_release);
+            cond_.notify_one();
+#endif
+        }
+
+    private:
+        std::atomic<uint32_t> seq_;
+        std::atomic<uint32_t> sleeping_; ///< set while the waiting side may be blocked
+#ifndef __linux__
+        boost::mutex mutex_;
+        boost::condition_variable cond_;
+#endif
+    };
+
+    size_type increment(const size_type index) const
+    {
+        return (index + 1 == slots_.size()) ? 0 : index + 1;
+    }
+
+    template<class U>
+    void push(U&& data)
+    {
+        const size_type tail = tail_.load(std::memory_order_relaxed);
+        const size_type next = increment(tail);
+        if (next == head_.load(std::memory_order_acquire)) {
+            notFull_.wait([&] { return next != head_.load(std::memory_order_acquire); });
+        }
+        slots_[tail] = std::forward<U>(data);
+        tail_.store(next, std::memory_order_release);
+        notEmpty_.notify();
+    }
+
+    void pop(const size_type head, T& value)
+    {
+        value = std::move(slots_[head]); // the slot must not keep resources alive
+        head_.store(increment(head), std::memory_order_release);
+        notFull_.notify();
+    }
+
+    const size_type capacity_;
+    std::vector<T> slots_;
+    // consumer and producer side on separate cache lines to avoid false sharing,
+    // padded rather than aligned, so buffers may be members of heap objects
+    char pad0_[SPSC_CACHE_LINE_SIZE];
+    std::atomic<size_type> head_;
+    char pad1_[SPSC_CACHE_LINE_SIZE];
+    std::atomic<size_type> tail_;
+    char pad2_[SPSC_CACHE_LINE_SIZE];
+    Event notEmpty_;
+    char pad3_[SPSC_CACHE_LINE_SIZE];
+    Event notFull_;
+    char pad4_[SPSC_CACHE_LINE_SIZE];
+};
+
+#endif // SPSC_BUFFER_H
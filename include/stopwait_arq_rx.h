@@ -15,10 +15,9 @@ class StopWaitArqRx : public ArqBase
 {
 public:
     StopWaitArqRx(FlowBase* flow, size_t buffer_size);
-    ~StopWaitArqRx(void) {};
+    ~StopWaitArqRx(void);
 
-    void handle_pdu_from_below(Pdu& pdu);
-    Pdu get_ack_for_data_frame(Pdu &pdu, const SeqNo seqno);
+    void handle_pdu_from_below(Pdu&& pdu);
     void frame_transmitted() {};
 
 private:
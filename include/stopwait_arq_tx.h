@@ -27,6 +27,7 @@
 #include <condition_variable>
 #include <atomic>
 #include "arq_base.h"
+#include "arq_executor.h"
 #include "logger.h"
 
 namespace libgdtp {
@@ -39,23 +40,23 @@ public:
     StopWaitArqTx(FlowBase* flow, size_t buffer_size);
     ~StopWaitArqTx(void);
 
-    void handle_pdu_from_below(Pdu& pdu);
+    void handle_pdu_from_below(Pdu&& pdu);
     void frame_transmitted();
 
 private:
     // member functions defined in arq_base
-    void arq_thread_function(void);
+    void service_buffer(void);
     void handle_ack_pdu(Pdu& pdu);
-
-    void transmit_pdu(Pdu& pdu);
+    void handle_timeout(const ArqExecutor::TimerId id);
+    void start_next_pdu(PduVector& pdus);
+    void transmit_pdus(PduVector& pdus, const bool wait = true);
     static std::string get_name(void) { return "StopWaitArqTx"; }
 
     // member variables ..
-    std::atomic<uint32_t> tx_seq_no_; // seqno of currently served PDU
-
-    // timer synchronization and rtx handling
-    boost::condition_variable timer_cond_;
-    boost::condition_variable tx_cond_;
+    Pdu tx_pdu_; // currently served PDU
+    uint32_t num_tx_; // number of transmissions of currently served PDU
+    boost::system_time tx_time_; // last transmission of currently served PDU
+    ArqExecutor::TimerId timer_id_; // running ACK timer, zero if none
     DECLARE_LOGPTR(logger_)
 };
 
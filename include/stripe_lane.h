@@ -0,0 +1,89 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*! \brief One lower layer port of a striped outbound flow.
+ *
+ * A striped OutboundFlow owns a lane for each of its stripe ports. Lanes
+ * queue the PDUs assigned to their port and are served by the scheduler
+ * of that port like any other flow. Transmissions are reported to the
+ * owning flow, whose ARQ handles all lanes together.
+ */
+
+#ifndef STRIPE_LANE_H
+#define STRIPE_LANE_H
+
+#include "flow_base.h"
+
+namespace libgdtp
+{
+
+class StripeLane : public FlowBase
+{
+public:
+    StripeLane(FlowManager* manager,
+               FlowBase* owner,
+               const FlowId src_id,
+               const FlowId dest_id,
+               Addr source,
+               Addr destination,
+               FlowProperties props,
+               PortId above_port_name,
+               PortId below_port_name,
+               size_t buffer_size)
+        : FlowBase(manager,
+                   src_id,
+                   dest_id,
+                   source,
+                   destination,
+                   props,
+                   above_port_name,
+                   below_port_name,
+                   OUTGOING,
+                   buffer_size),
+          owner_(owner),
+          weight_(props.get_stripe_ports().at(below_port_name))
+    {
+        // the rate limits the flow as a whole, not each of its ports
+        rate_bucket_ = &owner->bucket_;
+    }
+    ~StripeLane() {}
+
+    void handle_frame_from_below(Pdu&& pdu);
+    void print_status(void);
+    void frame_transmitted(void);
+
+    /**
+     * @brief Return the share of PDUs this lane gets relative to the other lanes.
+     */
+    uint32_t get_stripe_weight(void) const { return weight_; }
+
+private:
+    static std::string get_name(void) { return "StripeLane"; }
+
+    FlowBase* owner_;
+    const uint32_t weight_;
+    DECLARE_LOGPTR(logger_)
+};
+
+} // namespace libgdtp
+
+#endif // STRIPE_LANE_H
@@ -0,0 +1,169 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*! \brief A hierarchical timer wheel.
+ *
+ * Timers are sorted into NUM_LEVELS wheels of 2^SLOT_BITS slots each. The
+ * first wheel has a resolution of one tick, every further wheel covers the
+ * whole range of the previous one per slot. Timers on upper wheels are moved
+ * down (cascaded) as time advances, so adding a timer and expiring it are
+ * O(1). Cancellation is done lazily by the owner of the wheel, i.e. expired
+ * IDs that are not known anymore are simply ignored.
+ * The class is not thread-safe.
+ */
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+#include <boost/noncopyable.hpp>
+
+namespace libgdtp
+{
+
+class TimerWheel : boost::noncopyable
+{
+public:
+    typedef uint64_t TimerId;
+    typedef uint64_t Tick;
+
+    TimerWheel() :
+        current_tick_(0),
+        num_entries_(0)
+    {}
+
+    /**
+     * @brief Add a timer that expires at a given tick.
+     * Timers in the past expire with the next tick.
+     */
+    void add(const TimerId id, const Tick expires)
+    {
+        Entry entry = { id, std::max(expires, current_tick_ + 1) };
+        insert(entry);
+    }
+
+    /**
+     * @brief Advance the wheel up to the given tick.
+     * @param now The current tick
+     * @param expired All timers that expired on the way are appended here.
+     */
+    void advance(const Tick now, std::vector<TimerId>& expired)
+    {
+        if (num_entries_ == 0) {
+            current_tick_ = std::max(current_tick_, now);
+            return;
+        }
+
+        while (current_tick_ < now) {
+            current_tick_++;
+            // cascade upper wheels, beginning with the top-most one
+            for (int level = NUM_LEVELS - 1; level > 0; level--) {
+                if ((current_tick_ & ((Tick(1) << (SLOT_BITS * level)) - 1)) == 0)
+                    cascade(level, (current_tick_ >> (SLOT_BITS * level)) & SLOT_MASK);
+            }
+
+            std::vector<Entry> entries;
+            entries.swap(slots_[0][current_tick_ & SLOT_MASK]);
+            for (auto& entry : entries) {
+                num_entries_--;
+                if (entry.expires <= current_tick_) {
+                    expired.push_back(entry.id);
+                } else {
+                    insert(entry);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Return the earliest tick at which advance() may produce expired timers.
+     */
+    Tick next_expiry(void) const
+    {
+        Tick next_cascade = (current_tick_ | SLOT_MASK) + 1;
+        for (Tick tick = current_tick_ + 1; tick < next_cascade; tick++) {
+            if (not slots_[0][tick & SLOT_MASK].empty())
+                return tick;
+        }
+        return next_cascade;
+    }
+
+    /**
+     * @brief Drop all timers and restart at the given tick.
+     */
+    void reset(const Tick now)
+    {
+        for (int level = 0; level < NUM_LEVELS; level++) {
+            for (size_t slot = 0; slot < NUM_SLOTS; slot++) {
+                slots_[level][slot].clear();
+            }
+        }
+        num_entries_ = 0;
+        current_tick_ = now;
+    }
+
+    bool is_empty(void) const { return num_entries_ == 0; }
+
+private:
+    static const int NUM_LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const size_t NUM_SLOTS = 1 << SLOT_BITS;
+    static const Tick SLOT_MASK = NUM_SLOTS - 1;
+
+    typedef struct
+    {
+        TimerId id;
+        Tick expires;
+    } Entry;
+
+    // timers due in the current tick end up in the current slot of the first wheel
+    void insert(const Entry& entry)
+    {
+        Tick delta = (entry.expires > current_tick_) ? entry.expires - current_tick_ : 0;
+        int level = 0;
+        while (level < NUM_LEVELS - 1 && delta >= (Tick(1) << (SLOT_BITS * (level + 1)))) {
+            level++;
+        }
+        slots_[level][(entry.expires >> (SLOT_BITS * level)) & SLOT_MASK].push_back(entry);
+        num_entries_++;
+    }
+
+    void cascade(const int level, const size_t slot)
+    {
+        std::vector<Entry> entries;
+        entries.swap(slots_[level][slot]);
+        for (auto& entry : entries) {
+            num_entries_--;
+            insert(entry);
+        }
+    }
+
+    Tick current_tick_;
+    size_t num_entries_;
+    std::vector<Entry> slots_[NUM_LEVELS][NUM_SLOTS];
+};
+
+} // namespace libgdtp
+
+#endif // TIMER_WHEEL_H
@@ -0,0 +1,80 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef TOKEN_BUCKET_H
+#define TOKEN_BUCKET_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread_time.hpp>
+
+namespace libgdtp
+{
+
+/**
+ * A token bucket limiting the rate of a flow.
+ *
+ * The bucket fills with rate bytes per second up to burst bytes. A frame
+ * may be sent once the bucket holds as many tokens as the frame is large.
+ * Frames larger than the burst only need a full bucket and leave a debt
+ * behind, so they can't get stuck. A rate of zero disables the limit.
+ */
+class TokenBucket : boost::noncopyable
+{
+public:
+    TokenBucket(const uint32_t rate = 0, const uint32_t burst = 0);
+
+    /**
+     * @brief Change rate and burst, the current fill level is kept.
+     */
+    void configure(const uint32_t rate, const uint32_t burst);
+
+    /**
+     * @brief Return the time in ms until a frame of the given size may be sent, zero if now.
+     */
+    uint32_t get_wait_time(const size_t size);
+
+    /**
+     * @brief Take the tokens for a frame that is being sent.
+     */
+    void consume(const size_t size);
+
+    /**
+     * @brief Return the current fill level in bytes, negative while in debt.
+     */
+    double get_tokens(void);
+
+private:
+    void refill(void);
+
+    boost::mutex mutex_;
+    uint32_t rate_; ///< bytes per second, zero if unlimited
+    uint32_t burst_; ///< bucket size in bytes
+    double tokens_;
+    boost::system_time last_refill_;
+};
+
+} // namespace libgdtp
+
+#endif // TOKEN_BUCKET_H
@@ -0,0 +1,82 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*! \brief Weighted Fair Queueing (WFQ) scheduler.
+ *
+ * Each waiting flow is tagged with the virtual finish time of its next
+ * frame, i.e., its virtual start time plus the frame size divided by the
+ * flow's weight. The flow with the smallest finish time sends next, so
+ * backlogged flows share the port in proportion to their weights.
+ * The virtual time is the finish time of the frame in service
+ * (self-clocked fair queueing).
+ */
+
+#ifndef WFQ_SCHEDULER_H
+#define WFQ_SCHEDULER_H
+
+#include "scheduler_base.h"
+#include "logger.h"
+#include <map>
+#include <unordered_map>
+
+namespace libgdtp
+{
+
+class WfqScheduler : public SchedulerBase
+{
+public:
+    WfqScheduler() :
+        virtual_time_(0)
+    {}
+    void add_flow(FlowBase* flow);
+    void flow_modified(FlowBase* flow);
+    void get_pdus_for_below(PduVector &pdus);
+    bool has_waiting_flow(void);
+
+private:
+    typedef std::multimap<double, FlowBase*> TagQueue;
+
+    ///< Virtual times of a flow's next frame
+    typedef struct
+    {
+        double start;
+        double finish;
+        size_t size;
+        bool queued; ///< whether the flow is waiting in queue_
+        TagQueue::iterator pos;
+    } FlowTag;
+
+    FlowBase* get_next_flow();
+    void tag_next_frame(FlowBase* flow, FlowTag& tag, const double start);
+    void requeue_flow(FlowBase* flow);
+    static std::string get_name(void) { return "WfqScheduler"; }
+
+    double virtual_time_;
+    // This queue holds pointers to all flows that are ready ordered by finish time
+    TagQueue queue_;
+    std::unordered_map<FlowBase*, FlowTag> tags_;
+    DECLARE_LOGPTR(logger_)
+};
+
+} // namespace libgdtp
+
+#endif // WFQ_SCHEDULER_H
@@ -0,0 +1,162 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "aggregate_scheduler.h"
+
+namespace libgdtp
+{
+
+void AggregateScheduler::add_flow(FlowBase* flow)
+{
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    // only add flows to queue if they are not serviced yet
+    if (serviced_flows_.find(flow) == serviced_flows_.end()) {
+        serviced_flows_.insert(flow);
+        queue_.push(flow);
+    }
+    not_empty_cond_.notify_one();
+}
+
+
+void AggregateScheduler::set_aggregation_limits(const size_t max_bytes, const uint32_t max_wait)
+{
+    if (max_bytes == 0)
+        throw ParameterException("Byte budget must be greater than zero.");
+
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    max_bytes_ = max_bytes;
+    max_wait_ = max_wait;
+}
+
+
+FlowBase* AggregateScheduler::get_next_flow()
+{
+    boost::mutex::scoped_lock lock(mutex_);
+    while (queue_.empty()) {
+        not_empty_cond_.wait(lock);
+    }
+    flow_ = queue_.front();
+    queue_.pop();
+    serviced_flows_.erase(flow_);
+    return flow_;
+}
+
+
+/**
+ * Return the next flow whose frame still fits into a frame that already holds
+ * used bytes of payload. Waits until deadline for a flow to become ready.
+ * @return NULL if the frame is complete
+ */
+FlowBase* AggregateScheduler::get_next_flow(const size_t used, const boost::system_time& deadline)
+{
+    boost::mutex::scoped_lock lock(mutex_);
+    while (queue_.empty()) {
+        if (not not_empty_cond_.timed_wait(lock, deadline))
+            return NULL;
+    }
+
+    size_t size = 0;
+    queue_.front()->get_next_frame_size(size);
+    if (used + size > max_bytes_)
+        return NULL; // keep the flow for the next frame
+
+    flow_ = queue_.front();
+    queue_.pop();
+    serviced_flows_.erase(flow_);
+    return flow_;
+}
+
+
+void AggregateScheduler::get_pdus_for_below(PduVector &pdus)
+{
+    fill_frame(this->get_next_flow(), true, pdus);
+}
+
+
+/**
+ * Never waits for further PDUs, the frame holds what is ready right now.
+ */
+bool AggregateScheduler::try_get_pdus_for_below(PduVector &pdus)
+{
+    if (not has_waiting_flow())
+        return false;
+
+    fill_frame(this->get_next_flow(), false, pdus);
+    return true;
+}
+
+
+/**
+ * Take PDUs starting with the given flow until the frame is complete.
+ * The first PDU is always taken, even if it exceeds the budget on its own.
+ */
+void AggregateScheduler::fill_frame(FlowBase* flow, const bool wait, PduVector &pdus)
+{
+    boost::system_time deadline = boost::get_system_time();
+    if (wait) {
+        boost::mutex::scoped_lock lock(mutex_);
+        deadline += boost::posix_time::milliseconds(max_wait_);
+    }
+
+    std::vector<FlowBase*> flows;
+    size_t used = 0;
+    while (flow != NULL) {
+        Pdu pdu;
+        flow->get_frame_for_below(pdu);
+        used += pdu.get_payload()->size();
+        pdus.push_back(std::move(pdu));
+        flows.push_back(flow);
+        flow = this->get_next_flow(used, deadline);
+    }
+
+    boost::mutex::scoped_lock lock(mutex_);
+    frame_flows_.swap(flows);
+}
+
+
+/**
+ * Every PDU of the frame has to be confirmed to the flow it was taken from.
+ */
+void AggregateScheduler::set_pdus_transmitted(void)
+{
+    std::vector<FlowBase*> flows;
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        assert(not frame_flows_.empty());
+        flows.swap(frame_flows_);
+    }
+    // notify the flows without holding the lock, the ARQ may enqueue new PDUs
+    for (FlowBase* flow : flows) {
+        flow->frame_transmitted();
+    }
+}
+
+
+bool AggregateScheduler::has_waiting_flow(void)
+{
+    boost::mutex::scoped_lock lock(mutex_);
+    return (not queue_.empty());
+}
+
+ASSIGN_LOGPTR(AggregateScheduler::logger_, AggregateScheduler::get_name())
+
+} // namespace libgdtp
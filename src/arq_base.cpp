@@ -31,33 +31,374 @@ ArqBase::ArqBase(FlowBase* const flow, const size_t buffer_size) :
     state_(IDLE),
     buffer_(buffer_size),
     stats_(),
-    last_stats_()
+    last_stats_(),
+    ack_pending_(false),
+    ack_timer_id_(0),
+    next_seq_no_(1),
+    num_skip_tx_(0),
+    skip_timer_id_(0)
 {
 }
 
-void ArqBase::handle_pdu_from_above(Pdu &pdu)
+void ArqBase::handle_pdu_from_above(Pdu&& pdu)
 {
 #if NON_BLOCKING_ARQ
     if (buffer_.capacity() != buffer_.size()) {
 #endif
-        buffer_.pushBack(pdu);
         stats_.sdus_from_above++;
         stats_.bytes_from_above += pdu.get_payload()->size();
+        buffer_.pushBack(std::move(pdu));
 #if NON_BLOCKING_ARQ
     } else {
         LOG_DEBUG("arq buffer full, dropping frame");
     }
 #endif
+    service_buffer();
 }
 
-const FlowProperties ArqBase::get_props(void)
+
+void ArqBase::handle_pdus_from_above(PduVector&& pdus)
+{
+    PduVector::iterator it = pdus.begin();
+    while (it != pdus.end()) {
+        it = queue_pdus(it, pdus.end());
+        service_buffer();
+    }
+}
+
+
+/**
+ * Move as many PDUs into the buffer as there are free slots, but at least one,
+ * which blocks if the buffer is full.
+ * @return iterator to the first PDU that has not been queued
+ */
+PduVector::iterator ArqBase::queue_pdus(PduVector::iterator it, PduVector::iterator end)
+{
+    // only this thread fills the buffer, so free slots can't disappear
+    const size_t free_slots = buffer_.capacity() - buffer_.size();
+#if NON_BLOCKING_ARQ
+    if (free_slots == 0) {
+        LOG_DEBUG("arq buffer full, dropping " << (end - it) << " frames");
+        return end;
+    }
+#endif
+    PduVector::iterator last = it + std::min<size_t>(std::max<size_t>(free_slots, 1), end - it);
+    for (PduVector::iterator i = it; i != last; ++i) {
+        stats_.sdus_from_above++;
+        stats_.bytes_from_above += i->get_payload()->size();
+    }
+    buffer_.pushBackBatch(std::make_move_iterator(it), std::make_move_iterator(last));
+    return last;
+}
+
+std::shared_ptr<const FlowProperties> ArqBase::get_props(void)
 {
     return flow_->get_props();
 }
 
+Pdu ArqBase::get_ack_for_data_frame(Pdu &data, const SeqNo seqno)
+{
+    Pdu ack;
+    ack.set_type(ACK);
+    ack.set_dest_addr(data.get_source_addr());
+    ack.set_source_addr(data.get_dest_addr());
+    ack.set_src_id(data.get_dest_id());
+    ack.set_dest_id(data.get_src_id());
+    ack.set_seq_no(seqno);
+    return ack;
+}
+
+/**
+ * Remember that a DATA PDU has to be acknowledged. The ACK isn't sent before
+ * the whole frame has been handled, so it covers all PDUs of the frame.
+ * Must be called with mutex_ held.
+ */
+void ArqBase::ack_data_pdu(Pdu& data, const SeqNo seqno)
+{
+    ack_ = get_ack_for_data_frame(data, seqno);
+    ack_pending_ = true;
+}
+
+
+/**
+ * Request a missing PDU from the sender once the whole frame has been handled.
+ * Must be called with mutex_ held, after ack_data_pdu() for the same frame.
+ */
+void ArqBase::nack_pdu(const SeqNo seqno)
+{
+    LOG_INFO("PDU " << seqno << " is missing.");
+    nack_seq_nos_.push_back(seqno);
+}
+
+
+/**
+ * Send NACKs for all missing PDUs. A NACK requests its seqno and, through
+ * its bitmap, up to 64 following ones. Never waits for space in the buffer.
+ * Must be called with mutex_ held.
+ */
+void ArqBase::send_nacks(void)
+{
+    const SeqNo max_seq_no = get_props()->get_max_seqno();
+    std::vector<SeqNo>::iterator it = nack_seq_nos_.begin();
+    while (it != nack_seq_nos_.end()) {
+        Pdu nack(ack_); // the ACK header is addressed to the sender already
+        nack.set_type(NACK);
+        nack.set_seq_no(*it);
+        nack.set_sack(0);
+        for (++it; it != nack_seq_nos_.end(); ++it) {
+            const SeqNo offset = (*it + max_seq_no - nack.get_seq_no() - 1) % max_seq_no;
+            if (offset >= 64)
+                break;
+            nack.set_sack(nack.get_sack() | (uint64_t(1) << offset));
+        }
+        LOG_INFO("Transmitting NACK " << nack.get_seq_no() << " with bitmap " << std::hex << nack.get_sack() << std::dec);
+        flow_->queue_pdu_for_below_nowait(std::move(nack));
+        stats_.pdus_for_below++;
+    }
+    nack_seq_nos_.clear();
+}
+
+
+void ArqBase::frame_received()
+{
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    if (not nack_seq_nos_.empty())
+        send_nacks();
+    if (not ack_pending_)
+        return;
+
+    const uint32_t delay = get_props()->get_ack_delay();
+    if (delay == 0) {
+        send_ack();
+    } else
+    if (ack_timer_id_ == 0) {
+        // the timer isn't restarted by further frames, so no ACK waits longer than the delay
+        ack_timer_id_ = ArqExecutor::get_instance().schedule(this, delay,
+                                    std::bind(&ArqBase::handle_ack_timer, this, std::placeholders::_1));
+    }
+}
+
+
+bool ArqBase::piggyback_ack(Pdu& pdu)
+{
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    if (not ack_pending_)
+        return false;
+
+    update_ack(ack_);
+    pdu.set_piggyback_ack(ack_.get_seq_no(), ack_.get_sack());
+    ack_pending_ = false;
+    stop_ack_timer();
+    stats_.piggybacked_acks++;
+    LOG_DEBUG("Piggybacking ACK " << ack_.get_seq_no() << " on PDU " << pdu.get_seq_no() << ".");
+    return true;
+}
+
+
+/**
+ * Send the pending ACK as a PDU of its own, without waiting for space.
+ * Must be called with mutex_ held.
+ */
+void ArqBase::send_ack(void)
+{
+    update_ack(ack_);
+    ack_pending_ = false;
+    stop_ack_timer();
+    LOG_INFO("Transmitting ACK " << ack_.get_seq_no() << " with SACK " << std::hex << ack_.get_sack() << std::dec);
+    flow_->queue_pdu_for_below_nowait(Pdu(ack_));
+    stats_.pdus_for_below++;
+}
+
+
+/**
+ * Must be called with mutex_ held.
+ */
+void ArqBase::stop_ack_timer(void)
+{
+    if (ack_timer_id_ != 0) {
+        ArqExecutor::get_instance().cancel(ack_timer_id_);
+        ack_timer_id_ = 0;
+    }
+}
+
+
+/**
+ * No DATA of the reverse direction took the ACK along in time, send it on its own.
+ */
+void ArqBase::handle_ack_timer(const ArqExecutor::TimerId id)
+{
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    if (id != ack_timer_id_)
+        return; // piggybacked in the meantime
+
+    ack_timer_id_ = 0;
+    if (ack_pending_)
+        send_ack();
+}
+
+
+/**
+ * Account a PDU whose deadline has passed as dropped.
+ * @return true if the PDU must not be (re)transmitted
+ */
+bool ArqBase::drop_if_late(const Pdu& pdu)
+{
+    if (pdu.get_deadline().is_pos_infinity() || not pdu.is_expired(boost::get_system_time()))
+        return false;
+
+    LOG_INFO("Dropping PDU " << pdu.get_seq_no() << ", deadline has passed.");
+    stats_.dropped_late++;
+    return true;
+}
+
+
+/**
+ * Number a PDU that enters the transmit window. PDUs dropped before never
+ * get a seqno, so the receiver doesn't wait for them.
+ * Must be called with mutex_ held.
+ */
+void ArqBase::assign_seq_no(Pdu& pdu)
+{
+    pdu.set_seq_no(next_seq_no_);
+    next_seq_no_ = (next_seq_no_ + 1) % get_props()->get_max_seqno();
+}
+
+
+/**
+ * Tell the receiver to stop waiting for PDUs that have been given up after they
+ * were sent, it shall go on with seq_no. The SKIP is repeated until an ACK
+ * confirms it, a newer SKIP replaces a pending one.
+ * Must be called with mutex_ held.
+ */
+void ArqBase::skip_to(const Pdu& pdu, const SeqNo seq_no, PduVector& pdus)
+{
+    skip_ = Pdu();
+    skip_.set_type(SKIP);
+    skip_.set_source_addr(pdu.get_source_addr());
+    skip_.set_dest_addr(pdu.get_dest_addr());
+    skip_.set_src_id(pdu.get_src_id());
+    skip_.set_dest_id(pdu.get_dest_id());
+    skip_.set_seq_no(seq_no);
+    num_skip_tx_ = 0;
+    send_skip(pdus);
+}
+
+
+/**
+ * Must be called with mutex_ held.
+ */
+void ArqBase::send_skip(PduVector& pdus)
+{
+    LOG_INFO("Transmitting SKIP " << skip_.get_seq_no() << ".");
+    stop_skip_timer();
+    skip_timer_id_ = ArqExecutor::get_instance().schedule(this, get_ack_timeout(),
+                                std::bind(&ArqBase::handle_skip_timer, this, std::placeholders::_1));
+    num_skip_tx_++;
+    // no PDU of the window has this seqno, so frame_transmitted() passes over the SKIP
+    tx_pending_.push_back(get_props()->get_max_seqno());
+    pdus.push_back(skip_);
+    stats_.pdus_for_below++;
+}
+
+
+/**
+ * The pending SKIP has been received once the cumulative ACK reaches the
+ * PDU before it. The receiver never gets more than a window ahead of it.
+ * Must be called with mutex_ held.
+ */
+void ArqBase::confirm_skip(const SeqNo ack_seq_no)
+{
+    if (skip_timer_id_ == 0)
+        return;
+
+    const SeqNo max_seq_no = get_props()->get_max_seqno();
+    const SeqNo offset = (ack_seq_no + 1 + max_seq_no - skip_.get_seq_no()) % max_seq_no;
+    if (offset <= get_props()->get_window_size()) {
+        LOG_DEBUG("SKIP " << skip_.get_seq_no() << " confirmed.");
+        stop_skip_timer();
+    }
+}
+
+
+/**
+ * Must be called with mutex_ held.
+ */
+void ArqBase::stop_skip_timer(void)
+{
+    if (skip_timer_id_ != 0) {
+        ArqExecutor::get_instance().cancel(skip_timer_id_);
+        skip_timer_id_ = 0;
+    }
+}
+
+
+void ArqBase::handle_skip_timer(const ArqExecutor::TimerId id)
+{
+    PduVector pdus;
+    {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        if (id != skip_timer_id_)
+            return; // confirmed or replaced in the meantime
+
+        skip_timer_id_ = 0;
+        if (num_skip_tx_ >= get_props()->get_max_retransmission()) {
+            LOG_INFO("SKIP " << skip_.get_seq_no() << " not confirmed, maximum number of retransmissions reached.");
+            return;
+        }
+        send_skip(pdus);
+    }
+    for (auto& pdu : pdus) {
+        flow_->queue_pdu_for_below_nowait(std::move(pdu));
+    }
+}
+
+/**
+ * Return the ACK timeout for a PDU that is about to wait for its ACK.
+ * Must be called with mutex_ held.
+ */
+uint32_t ArqBase::get_ack_timeout(void)
+{
+    const std::shared_ptr<const FlowProperties> props = get_props();
+    if (not props->get_adaptive_rto())
+        return props->get_ack_timeout();
+
+    stats_.rto = rtt_.get_rto(props->get_ack_timeout(), props->get_min_rto(), props->get_max_rto());
+    return stats_.rto;
+}
+
+
+/**
+ * Measure the RTT of a PDU that has been acknowledged. Following Karn's
+ * algorithm, the caller must skip retransmitted PDUs because their ACK
+ * can't be matched with a transmission.
+ * Must be called with mutex_ held.
+ */
+void ArqBase::add_rtt_sample(const boost::system_time& tx_time)
+{
+    if (not get_props()->get_adaptive_rto())
+        return;
+
+    rtt_.add_sample(boost::get_system_time() - tx_time);
+    stats_.srtt = rtt_.get_srtt();
+    LOG_DEBUG("SRTT is " << stats_.srtt << " ms.");
+}
+
+
+/**
+ * Must be called with mutex_ held.
+ */
+void ArqBase::backoff_ack_timeout(void)
+{
+    if (get_props()->get_adaptive_rto())
+        rtt_.backoff();
+}
+
+
 ArqStats ArqBase::get_stats(StatsMode mode)
 {
     ArqStats tmp = stats_;
+    if (not get_props()->get_adaptive_rto())
+        tmp.rto = get_props()->get_ack_timeout();
     int frames_for_above = stats_.sdus_for_above;
     int lost_frames = stats_.lost_pdus;
     if (mode == RUNNING) {
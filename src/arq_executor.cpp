@@ -0,0 +1,140 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "arq_executor.h"
+
+namespace libgdtp
+{
+
+ArqExecutor::ArqExecutor() :
+    next_id_(1),
+    running_owner_(NULL),
+    epoch_(boost::get_system_time())
+{
+}
+
+
+ArqExecutor::~ArqExecutor()
+{
+    if (executor_thread_.joinable()) {
+        executor_thread_.interrupt();
+        executor_thread_.join();
+    }
+}
+
+
+ArqExecutor::TimerId ArqExecutor::schedule(const void* owner, const uint32_t delay, Callback callback)
+{
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    if (not executor_thread_.joinable()) {
+        executor_thread_ = boost::thread(&ArqExecutor::executor_thread_function, this);
+    }
+
+    TimerWheel::Tick now = get_current_tick();
+    if (timers_.empty()) {
+        // get rid of cancelled timers and don't let the wheel catch up on idle time
+        wheel_.reset(now);
+    }
+
+    TimerId id = next_id_++;
+    Timer timer = { owner, callback };
+    timers_[id] = timer;
+    wheel_.add(id, now + std::max<uint32_t>(delay, 1));
+    timer_cond_.notify_one();
+    return id;
+}
+
+
+void ArqExecutor::cancel(const TimerId id)
+{
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    timers_.erase(id);
+}
+
+
+void ArqExecutor::cancel_all(const void* owner)
+{
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    for (auto it = timers_.begin(); it != timers_.end();) {
+        if (it->second.owner == owner) {
+            it = timers_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // the owner may be destroyed after returning, so wait for its callback
+    if (boost::this_thread::get_id() != executor_thread_.get_id()) {
+        while (running_owner_ == owner) {
+            done_cond_.wait(lock);
+        }
+    }
+}
+
+
+TimerWheel::Tick ArqExecutor::get_current_tick(void)
+{
+    return (boost::get_system_time() - epoch_).total_milliseconds();
+}
+
+
+void ArqExecutor::executor_thread_function(void)
+{
+    try {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        while (true) {
+            if (timers_.empty()) {
+                timer_cond_.wait(lock);
+                continue;
+            }
+
+            std::vector<TimerId> expired;
+            wheel_.advance(get_current_tick(), expired);
+            for (auto id : expired) {
+                auto it = timers_.find(id);
+                if (it == timers_.end())
+                    continue; // cancelled
+
+                Timer timer = it->second;
+                timers_.erase(it);
+                running_owner_ = timer.owner;
+                lock.unlock();
+                timer.callback(id);
+                lock.lock();
+                running_owner_ = NULL;
+                done_cond_.notify_all();
+            }
+
+            if (not timers_.empty()) {
+                timer_cond_.timed_wait(lock, epoch_ + boost::posix_time::milliseconds(wheel_.next_expiry()));
+            }
+        }
+    }
+    catch(boost::thread_interrupted)
+    {
+        LOG_INFO("ARQ executor thread " << boost::this_thread::get_id() << " was interrupted.");
+    }
+}
+
+ASSIGN_LOGPTR(ArqExecutor::logger_, ArqExecutor::get_name())
+
+} // namespace libgdtp
@@ -0,0 +1,116 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "drr_scheduler.h"
+
+namespace libgdtp
+{
+
+void DrrScheduler::add_flow(FlowBase* flow)
+{
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    // flows stay active until they run out of frames
+    if (serviced_flows_.find(flow) == serviced_flows_.end()) {
+        serviced_flows_.insert(flow);
+        DrrState state = { 0, true };
+        states_[flow] = state;
+        active_.push_back(flow);
+    }
+    not_empty_cond_.notify_one();
+}
+
+/**
+ * Determine the flow that sends next and charge its deficit. The flow stays
+ * at the front as long as its deficit covers its next frame.
+ */
+FlowBase* DrrScheduler::get_next_flow()
+{
+    boost::mutex::scoped_lock lock(mutex_);
+    while (true) {
+        while (active_.empty()) {
+            not_empty_cond_.wait(lock);
+        }
+
+        FlowBase* flow = active_.front();
+        DrrState& state = states_[flow];
+        size_t size;
+        if (not flow->get_next_frame_size(size)) {
+            // shouldn't happen as only we take frames from the flow
+            active_.pop_front();
+            serviced_flows_.erase(flow);
+            states_.erase(flow);
+            continue;
+        }
+
+        if (state.new_round) {
+            state.deficit += flow->get_quantum();
+            state.new_round = false;
+        }
+
+        if (size <= state.deficit) {
+            state.deficit -= size;
+            flow_ = flow;
+            return flow_;
+        }
+
+        // deficit exhausted, continue with next flow
+        state.new_round = true;
+        active_.pop_front();
+        active_.push_back(flow);
+    }
+}
+
+/**
+ * An idle or rate limited flow leaves the round and loses its remaining deficit.
+ */
+void DrrScheduler::remove_flow_if_idle(FlowBase* flow)
+{
+    boost::mutex::scoped_lock lock(mutex_);
+    if (flow->has_frame_for_below() && flow->conforms_to_rate())
+        return;
+
+    assert(active_.front() == flow);
+    active_.pop_front();
+    serviced_flows_.erase(flow);
+    states_.erase(flow);
+}
+
+void DrrScheduler::get_pdus_for_below(PduVector &pdus)
+{
+    this->get_next_flow();
+    assert(flow_ != NULL);
+
+    Pdu pdu;
+    flow_->get_frame_for_below(pdu);
+    pdus.push_back(std::move(pdu));
+    remove_flow_if_idle(flow_);
+}
+
+bool DrrScheduler::has_waiting_flow(void)
+{
+    boost::mutex::scoped_lock lock(mutex_);
+    return (not active_.empty());
+}
+
+ASSIGN_LOGPTR(DrrScheduler::logger_, DrrScheduler::get_name())
+
+} // namespace libgdtp
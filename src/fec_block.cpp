@@ -0,0 +1,123 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <boost/crc.hpp>
+#include "fec_block.h"
+#include "gf256.h"
+
+namespace libgdtp
+{
+
+static const size_t BLOCK_HEADER_SIZE = 7;
+static const size_t MEMBER_SIZE = 16;
+static const uint8_t X0 = 255; ///< evaluation point of the first repair PDU, the others follow downwards
+
+// big endian, like the binary codec
+template<typename T>
+static uint8_t* write(uint8_t* pos, const T value)
+{
+    for (size_t i = 0; i < sizeof(T); i++) {
+        *pos++ = static_cast<uint8_t>(value >> (8 * (sizeof(T) - 1 - i)));
+    }
+    return pos;
+}
+
+template<typename T>
+static const uint8_t* read(const uint8_t* pos, T& value)
+{
+    value = 0;
+    for (size_t i = 0; i < sizeof(T); i++) {
+        value = (value << 8) | *pos++;
+    }
+    return pos;
+}
+
+
+/**
+ * Cauchy element 1 / (x_j + y_i) with y_i = i and x_j = 255 - j, divided by
+ * the element of the first row. Scaling columns keeps every square
+ * submatrix invertible, and x_j != y_i as long as k + m <= 256.
+ */
+uint8_t FecBlock::get_coefficient(const size_t repair_index, const size_t data_index)
+{
+    const uint8_t y = static_cast<uint8_t>(data_index);
+    const uint8_t x = static_cast<uint8_t>(X0 - repair_index);
+    return Gf256::mul(X0 ^ y, Gf256::inv(x ^ y));
+}
+
+
+uint32_t FecBlock::get_crc(const uint8_t* data, const size_t len)
+{
+    boost::crc_32_type crc;
+    crc.process_bytes(data, len);
+    return crc.checksum();
+}
+
+
+size_t FecBlock::get_header_size(const size_t num_data)
+{
+    return BLOCK_HEADER_SIZE + num_data * MEMBER_SIZE;
+}
+
+
+void FecBlock::write_header(const Header& header, uint8_t* buf)
+{
+    buf = write<uint32_t>(buf, header.block_id);
+    buf = write<uint8_t>(buf, header.index);
+    buf = write<uint8_t>(buf, header.members.size());
+    buf = write<uint8_t>(buf, header.num_repair);
+    for (auto& m : header.members) {
+        buf = write<uint64_t>(buf, m.seq_no);
+        buf = write<uint32_t>(buf, m.length);
+        buf = write<uint32_t>(buf, m.crc);
+    }
+}
+
+
+bool FecBlock::read_header(const Data& payload, Header& header)
+{
+    if (payload.size() < BLOCK_HEADER_SIZE)
+        return false;
+
+    uint8_t num_data;
+    const uint8_t* pos = payload.data();
+    pos = read(pos, header.block_id);
+    pos = read(pos, header.index);
+    pos = read(pos, num_data);
+    pos = read(pos, header.num_repair);
+    if (num_data == 0 || header.index >= header.num_repair ||
+        num_data + header.num_repair > MAX_PDUS || payload.size() < get_header_size(num_data))
+        return false;
+
+    header.members.resize(num_data);
+    for (auto& m : header.members) {
+        pos = read(pos, m.seq_no);
+        pos = read(pos, m.length);
+        pos = read(pos, m.crc);
+        // the symbol is as long as the largest member
+        if (m.length > payload.size() - get_header_size(num_data))
+            return false;
+    }
+    return true;
+}
+
+} // namespace libgdtp
@@ -0,0 +1,195 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "fec_decoder.h"
+#include "gf256.h"
+
+namespace libgdtp
+{
+
+FecDecoder::FecDecoder(const size_t cache_size, const size_t max_blocks) :
+    cache_size_(cache_size),
+    max_blocks_(max_blocks),
+    next_serial_(0)
+{
+}
+
+
+void FecDecoder::add_pdu(const Pdu& pdu)
+{
+    // the payload is handed to the upper layer, which may modify it
+    const Data& payload = *pdu.get_payload();
+    add_to_cache(pdu.get_seq_no(), std::make_shared<Data>(payload),
+                 FecBlock::get_crc(payload.data(), payload.size()));
+}
+
+
+void FecDecoder::add_to_cache(const SeqNo seq_no, std::shared_ptr<Data> payload, const uint32_t crc)
+{
+    cache_[seq_no] = { std::move(payload), crc, next_serial_ };
+    cache_order_.push_back(std::make_pair(seq_no, next_serial_));
+    next_serial_++;
+
+    while (cache_order_.size() > cache_size_) {
+        auto it = cache_.find(cache_order_.front().first);
+        if (it != cache_.end() && it->second.serial == cache_order_.front().second)
+            cache_.erase(it);
+        cache_order_.pop_front();
+    }
+}
+
+
+bool FecDecoder::is_present(const FecBlock::Member& member)
+{
+    auto it = cache_.find(member.seq_no);
+    return (it != cache_.end() && it->second.payload->size() == member.length && it->second.crc == member.crc);
+}
+
+
+void FecDecoder::handle_repair_pdu(const Pdu& repair, PduVector& recovered)
+{
+    FecBlock::Header header;
+    if (not FecBlock::read_header(*repair.get_payload(), header))
+        return;
+
+    auto it = blocks_.find(header.block_id);
+    if (it == blocks_.end()) {
+        it = blocks_.insert(std::make_pair(header.block_id, Block())).first;
+        it->second.members = std::move(header.members);
+    } else
+    if (it->second.members.size() != header.members.size()) {
+        return;
+    }
+    Block& block = it->second;
+    block.repairs[header.index] = repair.get_payload();
+
+    std::vector<size_t> missing;
+    for (size_t i = 0; i < block.members.size(); i++) {
+        if (not is_present(block.members[i]))
+            missing.push_back(i);
+    }
+
+    if (block.repairs.size() >= missing.size()) {
+        if (not missing.empty())
+            decode(block, missing, repair, recovered);
+        blocks_.erase(it);
+    }
+
+    // give up on the oldest blocks, their PDUs are lost for good
+    while (blocks_.size() > max_blocks_) {
+        blocks_.erase(blocks_.begin());
+    }
+}
+
+
+/**
+ * Solve for the missing symbols: subtract the known members from as many
+ * repair symbols as members are missing, then multiply by the inverse of the
+ * coefficients of the missing members.
+ */
+void FecDecoder::decode(const Block& block, const std::vector<size_t>& missing, const Pdu& repair, PduVector& recovered)
+{
+    const size_t e = missing.size();
+    const size_t header_size = FecBlock::get_header_size(block.members.size());
+
+    std::vector<uint8_t> rows;
+    std::vector<Data> rhs;
+    for (auto& r : block.repairs) {
+        if (rows.size() == e)
+            break;
+        // all repair symbols of a block have the same length
+        if (not rhs.empty() && r.second->size() - header_size != rhs.front().size())
+            return;
+        rows.push_back(r.first);
+        rhs.emplace_back(r.second->begin() + header_size, r.second->end());
+    }
+    const size_t symbol_size = rhs.front().size();
+
+    size_t next_missing = 0;
+    for (size_t i = 0; i < block.members.size(); i++) {
+        if (next_missing < e && missing[next_missing] == i) {
+            next_missing++;
+            continue;
+        }
+        const Data& payload = *cache_.at(block.members[i].seq_no).payload;
+        for (size_t a = 0; a < e; a++) {
+            Gf256::mul_add_region(rhs[a].data(), payload.data(), FecBlock::get_coefficient(rows[a], i), payload.size());
+        }
+    }
+
+    // invert the e x e coefficient matrix (Gauss-Jordan), any square submatrix is regular
+    std::vector<uint8_t> m(e * e), inv(e * e, 0);
+    for (size_t a = 0; a < e; a++) {
+        for (size_t b = 0; b < e; b++) {
+            m[a * e + b] = FecBlock::get_coefficient(rows[a], missing[b]);
+        }
+        inv[a * e + a] = 1;
+    }
+    for (size_t col = 0; col < e; col++) {
+        size_t pivot = col;
+        while (pivot < e && m[pivot * e + col] == 0)
+            pivot++;
+        if (pivot == e)
+            return;
+        for (size_t b = 0; b < e; b++) {
+            std::swap(m[pivot * e + b], m[col * e + b]);
+            std::swap(inv[pivot * e + b], inv[col * e + b]);
+        }
+        const uint8_t f = Gf256::inv(m[col * e + col]);
+        for (size_t b = 0; b < e; b++) {
+            m[col * e + b] = Gf256::mul(m[col * e + b], f);
+            inv[col * e + b] = Gf256::mul(inv[col * e + b], f);
+        }
+        for (size_t a = 0; a < e; a++) {
+            const uint8_t g = m[a * e + col];
+            if (a == col || g == 0)
+                continue;
+            for (size_t b = 0; b < e; b++) {
+                m[a * e + b] ^= Gf256::mul(g, m[col * e + b]);
+                inv[a * e + b] ^= Gf256::mul(g, inv[col * e + b]);
+            }
+        }
+    }
+
+    for (size_t b = 0; b < e; b++) {
+        const FecBlock::Member& member = block.members[missing[b]];
+        std::shared_ptr<Data> symbol = std::make_shared<Data>(symbol_size, 0);
+        for (size_t a = 0; a < e; a++) {
+            Gf256::mul_add_region(symbol->data(), rhs[a].data(), inv[b * e + a], symbol_size);
+        }
+        symbol->resize(member.length);
+        if (FecBlock::get_crc(symbol->data(), symbol->size()) != member.crc)
+            continue;
+
+        Pdu pdu(std::make_shared<Data>(*symbol));
+        pdu.set_type(DATA);
+        pdu.set_source_addr(repair.get_source_addr());
+        pdu.set_dest_addr(repair.get_dest_addr());
+        pdu.set_src_id(repair.get_src_id());
+        pdu.set_dest_id(repair.get_dest_id());
+        pdu.set_seq_no(member.seq_no);
+        recovered.push_back(std::move(pdu));
+        add_to_cache(member.seq_no, std::move(symbol), member.crc);
+    }
+}
+
+} // namespace libgdtp
@@ -0,0 +1,104 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "fec_encoder.h"
+#include "gf256.h"
+#include "exceptions.h"
+
+namespace libgdtp
+{
+
+FecEncoder::FecEncoder(const size_t num_data, const size_t num_repair) :
+    num_data_(num_data),
+    num_repair_(num_repair),
+    block_id_(0),
+    symbols_(num_repair),
+    deadline_(boost::posix_time::neg_infin)
+{
+    if (num_data == 0 || num_repair == 0 || num_data + num_repair > FecBlock::MAX_PDUS)
+        throw ParameterException("Invalid number of FEC data or repair PDUs.");
+    members_.reserve(num_data);
+}
+
+
+void FecEncoder::add_pdu(const Pdu& pdu, PduVector& repairs)
+{
+    if (members_.empty()) {
+        first_.set_source_addr(pdu.get_source_addr());
+        first_.set_dest_addr(pdu.get_dest_addr());
+        first_.set_src_id(pdu.get_src_id());
+        first_.set_dest_id(pdu.get_dest_id());
+    }
+
+    const Data& payload = *pdu.get_payload();
+    const size_t index = members_.size();
+    for (size_t j = 0; j < num_repair_; j++) {
+        // zero padding doesn't change the sum
+        if (symbols_[j].size() < payload.size())
+            symbols_[j].resize(payload.size(), 0);
+        Gf256::mul_add_region(symbols_[j].data(), payload.data(), FecBlock::get_coefficient(j, index), payload.size());
+    }
+    members_.push_back({ pdu.get_seq_no(),
+                         static_cast<uint32_t>(payload.size()),
+                         FecBlock::get_crc(payload.data(), payload.size()) });
+    deadline_ = std::max(deadline_, pdu.get_deadline());
+
+    if (members_.size() == num_data_)
+        close_block(repairs);
+}
+
+
+void FecEncoder::flush(PduVector& repairs)
+{
+    if (has_open_block())
+        close_block(repairs);
+}
+
+
+void FecEncoder::close_block(PduVector& repairs)
+{
+    FecBlock::Header header = { block_id_, 0, static_cast<uint8_t>(num_repair_), std::move(members_) };
+    const size_t header_size = FecBlock::get_header_size(header.members.size());
+    for (size_t j = 0; j < num_repair_; j++) {
+        std::shared_ptr<Data> payload = std::make_shared<Data>(header_size + symbols_[j].size());
+        header.index = j;
+        FecBlock::write_header(header, payload->data());
+        if (not symbols_[j].empty())
+            std::memcpy(payload->data() + header_size, symbols_[j].data(), symbols_[j].size());
+        symbols_[j].clear();
+
+        Pdu repair(first_);
+        repair.set_payload(std::move(payload));
+        repair.set_type(REPAIR);
+        repair.set_deadline(deadline_);
+        repairs.push_back(std::move(repair));
+    }
+
+    block_id_++;
+    members_.clear();
+    members_.reserve(num_data_);
+    deadline_ = boost::posix_time::neg_infin;
+}
+
+} // namespace libgdtp
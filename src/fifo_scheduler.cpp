@@ -29,8 +29,8 @@ void FifoScheduler::add_flow(FlowBase* flow)
 {
     boost::lock_guard<boost::mutex> lock(mutex_);
     // only add connections to queue if they are not serviced yet
-    if (serviced_flows_.find(flow->get_src_id()) == serviced_flows_.end()) {
-        serviced_flows_.insert(flow->get_src_id());
+    if (serviced_flows_.find(flow) == serviced_flows_.end()) {
+        serviced_flows_.insert(flow);
         queue_.push(flow);
     }
     not_empty_cond_.notify_one();
@@ -44,7 +44,7 @@ FlowBase* FifoScheduler::get_next_flow()
     }
     flow_ = queue_.front();
     queue_.pop();
-    serviced_flows_.erase(flow_->get_src_id());
+    serviced_flows_.erase(flow_);
     return flow_;
 }
 
@@ -55,7 +55,7 @@ void FifoScheduler::get_pdus_for_below(PduVector &pdus)
 
     Pdu pdu;
     flow_->get_frame_for_below(pdu);
-    pdus.push_back(pdu);
+    pdus.push_back(std::move(pdu));
 }
 
 
@@ -22,19 +22,160 @@
 
 #include "flow_base.h"
 #include "flow_manager.h"
+#include "arq_executor.h"
 
 namespace libgdtp
 {
 
-void FlowBase::queue_pdu_for_below(Pdu& pdu)
+FlowBase::~FlowBase()
 {
-    buffer_for_below_.pushBack(pdu);
+    ArqExecutor::get_instance().cancel_all(this);
+}
+
+void FlowBase::queue_pdu_for_below(Pdu&& pdu)
+{
+    if (has_pending_) {
+        std::unique_lock<std::mutex> lock(pending_mutex_);
+        if (not pending_for_below_.empty()) {
+            // line up behind the PDUs that are waiting for space already
+            pending_for_below_.push_back(std::move(pdu));
+            const uint64_t count = ++pending_added_;
+            const bool queued = move_pending_pdus();
+            lock.unlock();
+            if (queued)
+                manager_->mark_flow_as_ready(this);
+            lock.lock();
+            while (pending_queued_ < count)
+                pending_cond_.wait(lock);
+            return;
+        }
+    }
+    buffer_for_below_.pushBack(std::move(pdu));
     manager_->mark_flow_as_ready(this);
 }
 
-void FlowBase::queue_pdu_for_above(Pdu& pdu)
+void FlowBase::queue_pdu_for_below_nowait(Pdu&& pdu)
+{
+    bool queued;
+    {
+        std::unique_lock<std::mutex> lock(pending_mutex_);
+        pending_for_below_.push_back(std::move(pdu));
+        pending_added_++;
+        queued = move_pending_pdus();
+    }
+    // the scheduler lock must not be taken while holding pending_mutex_
+    if (queued)
+        manager_->mark_flow_as_ready(this);
+}
+
+/**
+ * Move the PDUs waiting for space to the buffer as long as they fit.
+ * Must be called with pending_mutex_ held.
+ * @return true if at least one PDU has been queued
+ */
+bool FlowBase::move_pending_pdus(void)
+{
+    bool queued = false;
+    while (not pending_for_below_.empty() && buffer_for_below_.tryPushBack(pending_for_below_.front())) {
+        pending_for_below_.pop_front();
+        pending_queued_++;
+        queued = true;
+    }
+    has_pending_ = not pending_for_below_.empty();
+    if (queued)
+        pending_cond_.notify_all();
+    return queued;
+}
+
+void FlowBase::get_frame_for_below(Pdu& pdu)
 {
-    manager_->add_frame_for_above(pdu, above_port_name_);
+    buffer_for_below_.popFront(pdu);
+    if (has_pending_) {
+        std::unique_lock<std::mutex> lock(pending_mutex_);
+        move_pending_pdus();
+    }
+    rate_bucket_->consume(pdu.get_payload()->size());
+    frame_taken_for_below(pdu);
+    // let a pending ACK of the reverse direction ride along, the ARQ keeps its own copy of the PDU
+    FlowBase* paired = paired_flow_;
+    if (paired != NULL && pdu.get_type() == DATA)
+        paired->arq_->piggyback_ack(pdu);
+    // windowed ARQs may have queued more than one PDU
+    if (buffer_for_below_.isNotEmpty())
+        manager_->mark_flow_as_ready(this);
+}
+
+bool FlowBase::conforms_to_rate(void)
+{
+    size_t size;
+    if (not get_next_frame_size(size))
+        return true;
+
+    const uint32_t wait = rate_bucket_->get_wait_time(size);
+    if (wait == 0)
+        return true;
+
+    // only a single timer per flow, the flow is checked again when it fires
+    if (not deferred_.exchange(true)) {
+        ArqExecutor::get_instance().schedule(this, wait, [this](const ArqExecutor::TimerId) {
+            deferred_ = false;
+            if (buffer_for_below_.isNotEmpty())
+                manager_->mark_flow_as_ready(this);
+        });
+    }
+    return false;
+}
+
+void FlowBase::frame_received(void)
+{
+    arq_->frame_received();
+    deliver_to_handler();
+}
+
+/**
+ * The ARQ passes PDUs up while holding its lock. The receive handler is only
+ * called from frame_received(), so it may send on the reverse flow right away.
+ */
+void FlowBase::queue_pdu_for_above(Pdu&& pdu)
+{
+    if (std::atomic_load(&receive_handler_)) {
+        std::unique_lock<std::mutex> lock(handler_mutex_);
+        handler_pending_.push_back(std::move(pdu));
+        return;
+    }
+    manager_->add_frame_for_above(std::move(pdu), above_port_name_);
+}
+
+/**
+ * Call the receive handler for the PDUs passed up so far. A single thread
+ * delivers at a time, which keeps the order if several ports feed the flow.
+ */
+void FlowBase::deliver_to_handler(void)
+{
+    std::unique_lock<std::mutex> lock(handler_mutex_);
+    if (handler_delivering_)
+        return; // the other thread picks up our PDUs as well
+
+    handler_delivering_ = true;
+    while (not handler_pending_.empty()) {
+        Pdu pdu = std::move(handler_pending_.front());
+        handler_pending_.pop_front();
+        lock.unlock();
+        // the handler may be swapped by another thread at any time
+        std::shared_ptr<ReceiveHandler> handler = std::atomic_load(&receive_handler_);
+        try {
+            if (handler)
+                (*handler)(pdu.release_payload());
+            else
+                manager_->add_frame_for_above(std::move(pdu), above_port_name_);
+        } catch (...) {
+            lock.lock();
+            handler_delivering_ = false;
+            throw;
+        }
+        lock.lock();
+    }
+    handler_delivering_ = false;
 }
 
 } // namespace libgdtp
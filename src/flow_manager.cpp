@@ -20,6 +20,7 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#include <algorithm>
 #include <limits>
 #include "flow_manager.h"
 #include "networking_helper.h"
@@ -37,13 +38,18 @@ FlowManager::FlowManager() :
     default_ack_timeout_(100),
     default_max_num_retries_(3),
     default_buffer_size_(default_buffer_size),
-    default_props_(default_props)
+    default_props_(default_props),
+    initialized_(false)
 {
     schedulers_[DEFAULT_BELOW_PORT_ID] = SchedulerFactory::make_scheduler("fifo");
 }
 
 void FlowManager::initialize(void)
 {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // the set of ports is fixed from now on, tx threads look up their scheduler without locking
+    initialized_ = true;
+
     // fill valid destinations
     destinations_.insert(default_source_addr_);
     destinations_.insert(BROADCAST_ADDRESS);
@@ -60,6 +66,9 @@ void FlowManager::deinitialize()
     for (it = flows_.begin(); it != flows_.end(); it++) {
         it->second->print_status();
     }
+    for (auto& f : inbound_flows_) {
+        f.second->print_status();
+    }
 }
 
 /**
@@ -76,12 +85,46 @@ void FlowManager::deinitialize()
 FlowId FlowManager::allocate_flow(const PortId dest_id, FlowProperties props)
 {
     std::unique_lock<std::mutex> lock(mutex_);
+    // an inbound flow on the same port is the reverse direction, not a duplicate
     for (auto& f : flows_) {
         if (f.second->get_dest_id() == dest_id)
             throw GdtpException("Flow already allocated.");
     }
+    if (flows_.size() > MAX_NUM_FLOWS)
+        throw GdtpException("No flow ids left.");
+
+    if (schedulers_.find(props.get_below_port()) == schedulers_.end())
+        throw ParameterException("Below port " + std::to_string(props.get_below_port()) + " has no scheduler.");
+
+    // the DRR scheduler would never find a flow that may send
+    if (props.get_quantum() == 0)
+        throw ParameterException("Quantum of a flow must be greater than zero.");
+    // the WFQ scheduler divides by the weight
+    if (props.get_weight() == 0)
+        throw ParameterException("Weight of a flow must be greater than zero.");
+
+    if (props.get_striping_mode() != NO_STRIPING) {
+        if (props.get_stripe_ports().empty())
+            throw ParameterException("Striping requires at least one stripe port.");
+        for (auto& port : props.get_stripe_ports()) {
+            if (schedulers_.find(port.first) == schedulers_.end())
+                throw ParameterException("Stripe port " + std::to_string(port.first) + " has no scheduler.");
+            if (port.second == 0)
+                throw ParameterException("Weight of stripe port " + std::to_string(port.first) + " must be greater than zero.");
+        }
+    }
+
+    if (props.get_fec_data_pdus() > 0) {
+        if (props.get_fec_repair_pdus() == 0)
+            throw ParameterException("FEC requires at least one repair PDU per block.");
+        if (props.get_fec_data_pdus() + props.get_fec_repair_pdus() > FecBlock::MAX_PDUS)
+            throw ParameterException("FEC blocks are limited to " + std::to_string(FecBlock::MAX_PDUS) + " PDUs.");
+        // the lanes are serviced independently, repairs could overtake their data
+        if (props.get_striping_mode() != NO_STRIPING)
+            throw ParameterException("FEC can't be combined with striping.");
+    }
 
-    // create unique random source id
+    // create unique random source id, inbound flows are kept apart and may use the same ids
     FlowId src_id;
     do {
         src_id = random_generator::get_instance().uniform_0_to_n(MAX_NUM_FLOWS);
@@ -111,8 +154,9 @@ FlowId FlowManager::allocate_flow(const PortId dest_id, FlowProperties props)
                                                                               default_destination_addr_,
                                                                               props,
                                                                               dest_id,
-                                                                              DEFAULT_BELOW_PORT_ID,
+                                                                              props.get_below_port(),
                                                                               default_buffer_size_));
+    pair_flow(flows_[src_id].get());
 
     // add source address if necessary
     if (destinations_.find(src_address) == destinations_.end()) {
@@ -120,8 +164,13 @@ FlowId FlowManager::allocate_flow(const PortId dest_id, FlowProperties props)
         destinations_.insert(src_address);
     }
 
-    // creating buffers for upper layer port of this flow
-    above_buffers_[dest_id].reset(new Buffer<Pdu>(default_buffer_size_));
+    // creating buffers for upper layer port of this flow, unless the reverse direction did already
+    if (above_buffers_.find(dest_id) == above_buffers_.end()) {
+        above_buffers_[dest_id].reset(new Buffer<Pdu>(default_buffer_size_));
+    }
+    if (receive_handlers_.find(dest_id) != receive_handlers_.end()) {
+        flows_[src_id]->set_receive_handler(receive_handlers_[dest_id]);
+    }
     return src_id;
 }
 
@@ -129,8 +178,30 @@ FlowId FlowManager::allocate_flow(const PortId dest_id, FlowProperties props)
 void FlowManager::modify_properties(const FlowId id, FlowProperties props)
 {
     try {
-        OutboundFlow* conn = dynamic_cast<OutboundFlow*>(flows_.at(id).get());
+        OutboundFlow* conn = static_cast<OutboundFlow*>(flows_.at(id).get());
+        if (props.get_below_port() != conn->get_below_port_name())
+            throw ParameterException("Below port of a flow can't be changed.");
+        if (props.get_quantum() == 0)
+            throw ParameterException("Quantum of a flow must be greater than zero.");
+        if (props.get_weight() == 0)
+            throw ParameterException("Weight of a flow must be greater than zero.");
+        const FlowProperties old_props = *conn->get_props();
+        if (props.get_striping_mode() != old_props.get_striping_mode() ||
+            props.get_stripe_ports() != old_props.get_stripe_ports())
+            throw ParameterException("Striping of a flow can't be changed.");
+        // the ARQ and the FEC encoder are built with the flow, also the window
+        // size has only been checked against the seqno space there
+        if (props.get_arq_type() != old_props.get_arq_type() ||
+            props.get_window_size() != old_props.get_window_size() ||
+            props.get_max_seqno() != old_props.get_max_seqno() ||
+            props.get_fec_data_pdus() != old_props.get_fec_data_pdus() ||
+            props.get_fec_repair_pdus() != old_props.get_fec_repair_pdus())
+            throw ParameterException("ARQ type, window size, seqno space and FEC of a flow can't be changed.");
         conn->set_properties(props);
+        schedulers_.at(conn->get_below_port_name())->flow_modified(conn);
+        for (FlowBase* lane : conn->get_stripe_lanes()) {
+            schedulers_.at(lane->get_below_port_name())->flow_modified(lane);
+        }
     } catch (const std::out_of_range& e) {
         throw GdtpException("Unknown flow specified.");
     }
@@ -147,39 +218,73 @@ void FlowManager::modify_properties(const FlowId id, FlowProperties props)
  * @return string containing the id
  *
  */
-int FlowManager::handle_sdu_from_above(std::shared_ptr<Data> sdu, const FlowId id)
+int FlowManager::handle_sdu_from_above(std::shared_ptr<Data>&& sdu, const FlowId id, const boost::posix_time::ptime& deadline)
 {
     LOG_DEBUG("handle_sdu_from_above()");
     try {
-        OutboundFlow* flow = dynamic_cast<OutboundFlow*>(flows_.at(id).get());
-        flow->handle_frame_from_above(sdu);
+        OutboundFlow* flow = static_cast<OutboundFlow*>(flows_.at(id).get());
+        flow->handle_frame_from_above(std::move(sdu), deadline);
+    } catch (const std::out_of_range& e) {
+        throw GdtpException("Unknown flow specified.");
+    }
+    return 1;
+}
+
+
+void FlowManager::handle_sdus_from_above(std::vector<std::shared_ptr<Data> >& sdus, const FlowId id)
+{
+    LOG_DEBUG("handle_sdus_from_above()");
+    try {
+        OutboundFlow* flow = static_cast<OutboundFlow*>(flows_.at(id).get());
+        flow->handle_frames_from_above(sdus, boost::posix_time::pos_infin);
     } catch (const std::out_of_range& e) {
         throw GdtpException("Unknown flow specified.");
     }
 }
 
 
-int FlowManager::handle_pdu_from_below(const PortId id, Pdu &pdu)
+/**
+ * Handle all PDUs of a frame. Flows that got PDUs from the frame are told once all
+ * of them have been handled, so they can answer with a single ACK.
+ */
+void FlowManager::handle_pdus_from_below(const PortId id, PduVector& pdus)
+{
+    std::vector<FlowBase*> flows;
+    for (Pdu& pdu : pdus) {
+        FlowBase* flow = handle_pdu_from_below(id, std::move(pdu));
+        if (flow != NULL && std::find(flows.begin(), flows.end(), flow) == flows.end())
+            flows.push_back(flow);
+    }
+    for (FlowBase* flow : flows) {
+        flow->frame_received();
+    }
+}
+
+
+/**
+ * @return the flow that handled the PDU, NULL if the PDU isn't for us
+ */
+FlowBase* FlowManager::handle_pdu_from_below(const PortId id, Pdu&& pdu)
 {
     LOG_DEBUG("handle_frame_from_below()");
     // check if destination address matches
     if (destinations_.find(pdu.get_dest_addr()) == destinations_.end()) {
         // frame is not for us
         LOG_DEBUG("Ignoring frame for " << pdu.get_dest_addr());
-        return 0;
+        return NULL;
     }
 
     // get corresponding connection handle
     FlowBase* flow = find_flow(pdu, id);
-    flow->handle_frame_from_below(pdu);
-    return 1;
+    flow->handle_frame_from_below(std::move(pdu));
+    return flow;
 }
 
 
-int FlowManager::add_frame_for_above(Pdu &pdu, const PortId id)
+void FlowManager::add_frame_for_above(Pdu&& pdu, const PortId id)
 {
     try {
-        above_buffers_.at(id)->pushBack(pdu);
+        above_buffers_.at(id)->pushBack(std::move(pdu));
     } catch (const std::out_of_range& e) {
         throw GdtpException("Unknown port id " + std::to_string(id) + " specified.");
     }
@@ -189,7 +294,32 @@ int FlowManager::add_frame_for_above(Pdu &pdu, const PortId id)
 void FlowManager::get_pdus_for_below(PduVector &pdus, const PortId id)
 {
     try {
-        schedulers_.at(id)->get_pdus_for_below(pdus);
+        SchedulerBase* scheduler = schedulers_.at(id).get();
+        scheduler->get_pdus_for_below(pdus);
+        scheduler->update_event_fd();
+    } catch (const std::out_of_range& e) {
+        throw GdtpException("Below port ID " + std::to_string(id) + " is not valid.");
+    }
+}
+
+
+bool FlowManager::try_get_pdus_for_below(PduVector &pdus, const PortId id)
+{
+    try {
+        SchedulerBase* scheduler = schedulers_.at(id).get();
+        const bool found = scheduler->try_get_pdus_for_below(pdus);
+        scheduler->update_event_fd();
+        return found;
+    } catch (const std::out_of_range& e) {
+        throw GdtpException("Below port ID " + std::to_string(id) + " is not valid.");
+    }
+}
+
+
+int FlowManager::get_event_fd(const PortId id)
+{
+    try {
+        return schedulers_.at(id)->get_event_fd();
     } catch (const std::out_of_range& e) {
         throw GdtpException("Below port ID " + std::to_string(id) + " is not valid.");
     }
@@ -233,69 +363,180 @@ std::shared_ptr<Data> FlowManager::get_sdu_for_above(const PortId id)
 
     // we know id exists, so we can safely access it
     above_buffers_.at(id)->popFront(tmp);
-    return tmp.get_payload();
+    return tmp.release_payload();
 }
 
 
+/**
+ * Blocks until at least one SDU is available and returns up to max SDUs at once.
+ */
+size_t FlowManager::get_sdus_for_above(const PortId id, std::vector<std::shared_ptr<Data> >& sdus, const size_t max)
+{
+    PduVector pdus;
+    if (above_buffers_.find(id) == above_buffers_.end()) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        above_buffers_[id].reset(new Buffer<Pdu>);
+    }
+
+    // we know id exists, so we can safely access it
+    above_buffers_.at(id)->popFrontBatch(pdus, max);
+    for (auto& pdu : pdus) {
+        sdus.push_back(pdu.release_payload());
+    }
+    return pdus.size();
+}
+
+
+/**
+ * Hand SDUs of an upper layer port to a callback. The handler is passed to all
+ * flows of the port, flows created later pick it up on creation.
+ */
+void FlowManager::register_receive_handler(const PortId id, ReceiveHandler handler)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::shared_ptr<ReceiveHandler> ptr;
+    if (handler) {
+        ptr = std::make_shared<ReceiveHandler>(std::move(handler));
+        receive_handlers_[id] = ptr;
+    } else {
+        receive_handlers_.erase(id);
+    }
+
+    for (auto& f : flows_) {
+        if (f.second->get_above_port_name() == id)
+            f.second->set_receive_handler(ptr);
+    }
+    for (auto& f : inbound_flows_) {
+        if (f.second->get_above_port_name() == id)
+            f.second->set_receive_handler(ptr);
+    }
+}
+
+
+/**
+ * Pair a new flow with the flow of the reverse direction, i.e. the one between
+ * the same two nodes and for the same upper layer port, so that they can
+ * carry each other's ACKs.
+ * Must be called with mutex_ held.
+ */
+void FlowManager::pair_flow(FlowBase* flow)
+{
+    std::vector<FlowBase*> others;
+    if (flow->get_direction() == OUTGOING) {
+        for (auto& f : inbound_flows_)
+            others.push_back(f.second.get());
+    } else {
+        for (auto& f : flows_)
+            others.push_back(f.second.get());
+    }
+
+    for (FlowBase* other : others) {
+        if (other->get_paired_flow() == NULL &&
+            other->get_dest_id() == flow->get_dest_id() &&
+            other->get_src_addr() == flow->get_dest_addr() &&
+            other->get_dest_addr() == flow->get_src_addr()) {
+            LOG_INFO("Pairing flow " << flow->get_src_id() << " with flow " << other->get_src_id() << " of the reverse direction.");
+            flow->set_paired_flow(other);
+            other->set_paired_flow(flow);
+            return;
+        }
+    }
+}
+
+
+/**
+ * Inbound flows are keyed by the address and the source id of the sender, the
+ * source ids of different senders and of our own outbound flows may collide.
+ * ACKs and NACKs carry the source id of our outbound flow as destination id.
+ */
 FlowBase* FlowManager::find_flow(Pdu &pdu, const PortId belowid)
 {
     std::unique_lock<std::mutex> lock(mutex_);
-    FlowId id;
-    if (pdu.get_type() == DATA) {
-        id = pdu.get_src_id();
-        // check if flow already exists
-        if (flows_.find(id) == flows_.end()) {
-            // not found, creating new one
-            LOG_INFO("Creating new inbound flow from (" << pdu.get_src_id() << "->" << pdu.get_dest_id() << ").");
-            FlowProperties props = default_props_;
-            // try to derive properties of new flow from existing local flow
-            for (auto& f : flows_) {
-               if (f.second->get_dest_id() == pdu.get_dest_id()) {
-                   props = f.second->get_props();
-                   LOG_INFO("  .. using properties of existing flow (" << props.pp_string() << ").");
-               }
-            }
-            flows_[id] = std::shared_ptr<FlowBase>(new InboundFlow(this,
-                                                                                     pdu.get_src_id(),
-                                                                                     pdu.get_dest_id(),
-                                                                                     pdu.get_source_addr(),
-                                                                                     pdu.get_dest_addr(),
-                                                                                     props,
-                                                                                     pdu.get_dest_id(),
-                                                                                     belowid,
-                                                                                     default_buffer_size_));
-            // creating buffer for upper layer port if needed
-            if (above_buffers_.find(pdu.get_dest_id()) == above_buffers_.end()) {
-                above_buffers_[pdu.get_dest_id()].reset(new Buffer<Pdu>(default_buffer_size_));
-            }
-        } else {
-            // flow should be an inbound flow if it already exists
-            assert(dynamic_cast<InboundFlow*>(flows_.at(id).get()) != NULL);
+    if (schedulers_.find(belowid) == schedulers_.end())
+        throw GdtpException("Below port " + std::to_string(belowid) + " has no scheduler.");
+
+    if (pdu.get_type() == DATA || pdu.get_type() == REPAIR || pdu.get_type() == SKIP) {
+        const std::pair<Addr, FlowId> key(pdu.get_source_addr(), pdu.get_src_id());
+        std::map<std::pair<Addr, FlowId>, std::shared_ptr<FlowBase> >::iterator it = inbound_flows_.find(key);
+        if (it != inbound_flows_.end())
+            return it->second.get();
+
+        // not found, creating new one
+        LOG_INFO("Creating new inbound flow from (" << pdu.get_src_id() << "->" << pdu.get_dest_id() << ").");
+        FlowProperties props = default_props_;
+        // try to derive properties of new flow from existing local flow
+        for (auto& f : flows_) {
+           if (f.second->get_dest_id() == pdu.get_dest_id()) {
+               props = *f.second->get_props();
+               LOG_INFO("  .. using properties of existing flow (" << props.pp_string() << ").");
+           }
+        }
+        FlowBase* flow = new InboundFlow(this,
+                                         pdu.get_src_id(),
+                                         pdu.get_dest_id(),
+                                         pdu.get_source_addr(),
+                                         pdu.get_dest_addr(),
+                                         props,
+                                         pdu.get_dest_id(),
+                                         belowid,
+                                         default_buffer_size_);
+        inbound_flows_[key] = std::shared_ptr<FlowBase>(flow);
+        pair_flow(flow);
+        // creating buffer for upper layer port if needed
+        if (above_buffers_.find(pdu.get_dest_id()) == above_buffers_.end()) {
+            above_buffers_[pdu.get_dest_id()].reset(new Buffer<Pdu>(default_buffer_size_));
+        }
+        if (receive_handlers_.find(pdu.get_dest_id()) != receive_handlers_.end()) {
+            flow->set_receive_handler(receive_handlers_[pdu.get_dest_id()]);
         }
-    } else
-    if (pdu.get_type() == ACK) {
-        id = pdu.get_dest_id();
+        return flow;
     }
 
-    // finally, return flow object
+    if (pdu.get_type() != ACK && pdu.get_type() != NACK)
+        throw GdtpException("Invalid frame received.");
+
     try {
-        return flows_.at(id).get();
+        return flows_.at(pdu.get_dest_id()).get();
     } catch (const std::out_of_range& e) {
-        throw GdtpException("Flow id " + std::to_string(id) + " is unknown.");
+        throw GdtpException("Flow id " + std::to_string(pdu.get_dest_id()) + " is unknown.");
     }
 }
 
 
+/**
+ * Set the scheduler of a lower layer port, unknown ports are created. Each port
+ * has its own scheduler, hence ports can be served by independent tx threads.
+ * Only possible before initialize(), a tx thread may be waiting in a scheduler
+ * afterwards.
+ */
 void FlowManager::set_scheduler_type(const PortId port, const std::string type)
 {
     std::unique_lock<std::mutex> lock(mutex_);
-    if (port != DEFAULT_BELOW_PORT_ID)
-        throw ParameterException("Defining a scheduler for given lower layer port is not supported at the moment.");
+    if (initialized_)
+        throw ParameterException("Schedulers can't be changed after initialization.");
+    // flows may be queued at the current scheduler
+    for (auto& f : flows_) {
+        const std::shared_ptr<const FlowProperties> props = f.second->get_props();
+        if (f.second->get_below_port_name() == port ||
+            (props->get_striping_mode() != NO_STRIPING && props->get_stripe_ports().count(port) > 0))
+            throw ParameterException("Scheduler can't be changed while flows use port " + std::to_string(port) + ".");
+    }
 
     schedulers_[port] = SchedulerFactory::make_scheduler(type);
 }
 
 
+void FlowManager::set_aggregation_limits(const PortId port, const size_t max_bytes, const uint32_t max_wait)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    try {
+        schedulers_.at(port)->set_aggregation_limits(max_bytes, max_wait);
+    } catch (const std::out_of_range& e) {
+        throw GdtpException("Below port ID " + std::to_string(port) + " is not valid.");
+    }
+}
+
+
 void FlowManager::set_default_source_address(const Addr address)
 {
     std::unique_lock<std::mutex> lock(mutex_);
@@ -320,8 +561,14 @@ void FlowManager::set_default_flow_properties(const FlowProperties props)
 void FlowManager::mark_flow_as_ready(FlowBase* flow)
 {
     //FIXME: acquire lock first?
+    // rate limited flows only compete for the port once their next frame conforms
+    if (not flow->conforms_to_rate())
+        return;
+
     try {
-        schedulers_.at(flow->get_below_port_name())->add_flow(flow);
+        SchedulerBase* scheduler = schedulers_.at(flow->get_below_port_name()).get();
+        scheduler->add_flow(flow);
+        scheduler->signal_event_fd();
     } catch (const std::out_of_range& e) {
         throw GdtpException("No scheduler for below port registered.");
     }
@@ -333,14 +580,10 @@ ArqStats FlowManager::get_stats(FlowId id)
     std::unique_lock<std::mutex> lock(mutex_);
     // check for outbound flows first
     if (flows_.find(id) == flows_.end()) {
-        // now check inbound flows with the provided id
-        for (auto& f : flows_) {
-            if (dynamic_cast<InboundFlow*>(f.second.get()) != NULL) {
-                if (f.second->get_dest_id() == id) {
-                    // access this inbound flow via its unique src_id
-                    return flows_[f.second->get_src_id()]->get_stats();
-                }
-            }
+        // now check inbound flows of the upper layer port with the provided id
+        for (auto& f : inbound_flows_) {
+            if (f.second->get_dest_id() == id)
+                return f.second->get_stats();
         }
     } else {
         return flows_[id]->get_stats();
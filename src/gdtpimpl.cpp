@@ -25,16 +25,21 @@
 #include <stdint.h>
 #include "logger.h"
 #include "gdtpimpl.h"
-#include "protobuf_codec.h"
+#include "codec_factory.h"
+#include "exceptions.h"
 
 namespace libgdtp
 {
 
 Gdtp::GdtpImpl::GdtpImpl() :
     manager_(new FlowManager()),
-    stats_()
+    stats_(),
+    pool_(std::make_shared<PayloadPool>()),
+    codec_(CodecFactory::make_codec("protobuf")),
+    initialized_(false)
 {
     LOG_DEBUG("Constructing GdtpImpl ..");
+    codec_->set_payload_pool(pool_);
     CONFIG_LOGGER();
 }
 
@@ -49,6 +54,10 @@ Gdtp::GdtpImpl::~GdtpImpl()
     LOG_INFO("  Bytes from below:    " << stats_.bytes_from_below);
     LOG_INFO("  Frames from below:   " << stats_.frames_from_below);
     LOG_INFO("  Frames for below:    " << stats_.frames_for_below);
+    LOG_INFO("  PDUs for below:      " << stats_.pdus_for_below);
+    PayloadPool::Stats pool_stats = pool_->get_stats();
+    LOG_INFO("  Heap allocations:    " << pool_stats.heap_allocations);
+    LOG_INFO("  Pool allocations:    " << pool_stats.pool_allocations);
     google::protobuf::ShutdownProtobufLibrary();
     DESTROY_LOGGER()
 }
@@ -58,6 +67,7 @@ void Gdtp::GdtpImpl::initialize()
 {
     LOG_INFO("Initializing GDTP ..");
     manager_->initialize();
+    initialized_ = true;
 }
 
 
@@ -67,6 +77,25 @@ void Gdtp::GdtpImpl::set_scheduler_type(const PortId port, const std::string typ
 }
 
 
+void Gdtp::GdtpImpl::set_aggregation_limits(const PortId port, const size_t max_bytes, const uint32_t max_wait)
+{
+    manager_->set_aggregation_limits(port, max_bytes, max_wait);
+}
+
+
+/**
+ * Only possible before initialize(), the rx and tx threads use the codec
+ * without locking afterwards.
+ */
+void Gdtp::GdtpImpl::set_codec_type(const std::string type)
+{
+    if (initialized_)
+        throw ParameterException("The codec can't be changed after initialization.");
+    codec_ = CodecFactory::make_codec(type);
+    codec_->set_payload_pool(pool_);
+}
+
+
 void Gdtp::GdtpImpl::set_default_source_address(const Addr addr)
 {
     manager_->set_default_source_address(addr);
@@ -91,10 +120,28 @@ void Gdtp::GdtpImpl::modify_properties(const FlowId id, FlowProperties props)
 }
 
 
-void Gdtp::GdtpImpl::handle_data_from_above(std::shared_ptr<Data> sdu, const FlowId id)
+void Gdtp::GdtpImpl::handle_data_from_above(std::shared_ptr<Data>&& sdu, const FlowId id)
+{
+    stats_.bytes_from_above += sdu->size();
+    manager_->handle_sdu_from_above(std::move(sdu), id);
+}
+
+
+void Gdtp::GdtpImpl::handle_data_from_above(std::shared_ptr<Data>&& sdu, const FlowId id, const uint32_t deadline)
 {
     stats_.bytes_from_above += sdu->size();
-    manager_->handle_sdu_from_above(sdu, id);
+    manager_->handle_sdu_from_above(std::move(sdu), id,
+                                    boost::get_system_time() + boost::posix_time::milliseconds(deadline));
+}
+
+
+void Gdtp::GdtpImpl::handle_data_from_above_batch(std::vector<std::shared_ptr<Data> >&& sdus, const FlowId id)
+{
+    for (auto& sdu : sdus) {
+        stats_.bytes_from_above += sdu->size();
+    }
+    manager_->handle_sdus_from_above(sdus, id);
+    sdus.clear();
 }
 
 
@@ -103,17 +150,38 @@ void Gdtp::GdtpImpl::handle_data_from_below(const PortId id, Data& sdu)
     // decode lower layer SDUs into PDU
     PduVector pdus;
     try {
-		ProtobufCodec::decode(sdu, pdus);
-		stats_.bytes_from_below += sdu.size();
-		stats_.frames_from_below++;
-
-		for (Pdu i : pdus) {
-			LOG_INFO("RX " << i.get_type_as_string() << " " << i.get_seq_no() << " from " << i.get_source_addr());
-			manager_->handle_pdu_from_below(id, i);
-		}
-	} catch(const DecodeException &) {
-		LOG_DEBUG("Couldn't decode incoming date.");
+        codec_->decode(sdu, pdus);
+        stats_.bytes_from_below += sdu.size();
+        stats_.frames_from_below++;
+        handle_pdus_from_below(id, pdus);
+    } catch(const DecodeException &) {
+        LOG_DEBUG("Couldn't decode incoming date.");
+    }
+}
+
+
+void Gdtp::GdtpImpl::handle_data_from_below(const PortId id, std::shared_ptr<Data> sdu)
+{
+    // the codec may take over the buffer, so count it first
+    const size_t size = sdu->size();
+    PduVector pdus;
+    try {
+        codec_->decode(sdu, pdus);
+        stats_.bytes_from_below += size;
+        stats_.frames_from_below++;
+        handle_pdus_from_below(id, pdus);
+    } catch(const DecodeException &) {
+        LOG_DEBUG("Couldn't decode incoming date.");
+    }
+}
+
+
+void Gdtp::GdtpImpl::handle_pdus_from_below(const PortId id, PduVector& pdus)
+{
+    for (Pdu& i : pdus) {
+        LOG_INFO("RX " << i.get_type_as_string() << " " << i.get_seq_no() << " from " << i.get_source_addr());
     }
+    manager_->handle_pdus_from_below(id, pdus);
 }
 
 
@@ -128,15 +196,38 @@ void Gdtp::GdtpImpl::get_data_for_below(const FlowId id, Data& data)
     // get PDUs
     PduVector pdus;
     manager_->get_pdus_for_below(pdus, id);
+    encode_pdus(pdus, data);
+}
+
+
+bool Gdtp::GdtpImpl::try_get_data_for_below(const PortId id, Data& data)
+{
+    PduVector pdus;
+    if (not manager_->try_get_pdus_for_below(pdus, id))
+        return false;
+
+    encode_pdus(pdus, data);
+    return true;
+}
 
-    // encode PDU into Protobuf OTA format
-    ProtobufCodec::encode(pdus, data);
+
+int Gdtp::GdtpImpl::get_event_fd(const PortId id)
+{
+    return manager_->get_event_fd(id);
+}
+
+
+void Gdtp::GdtpImpl::encode_pdus(PduVector& pdus, Data& data)
+{
+    // encode PDU into OTA format
+    codec_->encode(pdus, data);
 
     for (auto& p : pdus) {
         LOG_INFO("TX " << p.get_type_as_string() << " " << p.get_seq_no() << " to " << p.get_dest_addr());
     }
     stats_.bytes_for_below += data.size();
     stats_.frames_for_below++;
+    stats_.pdus_for_below += pdus.size();
 }
 
 
@@ -160,11 +251,41 @@ std::shared_ptr<Data> Gdtp::GdtpImpl::get_data_for_above(const FlowId id)
 }
 
 
+size_t Gdtp::GdtpImpl::get_data_for_above_batch(const FlowId id, std::vector<std::shared_ptr<Data> >& data, const size_t max)
+{
+    const size_t first = data.size();
+    const size_t num = manager_->get_sdus_for_above(id, data, max);
+    for (size_t i = first; i < data.size(); i++) {
+        stats_.bytes_for_above += data[i]->size();
+    }
+    return num;
+}
+
+
+void Gdtp::GdtpImpl::register_receive_handler(const FlowId id, ReceiveHandler handler)
+{
+    if (not handler) {
+        manager_->register_receive_handler(id, ReceiveHandler());
+        return;
+    }
+    // account the SDU like get_data_for_above() does
+    manager_->register_receive_handler(id, [this, handler](std::shared_ptr<Data> sdu) {
+        stats_.bytes_for_above += sdu->size();
+        handler(std::move(sdu));
+    });
+}
+
+
 FlowStats Gdtp::GdtpImpl::get_stats(const FlowId id)
 {
     FlowStats flow_stats;
     flow_stats.arq = manager_->get_stats(id); // get arq stats from manager first
     flow_stats.encoder = stats_;
+    if (stats_.frames_for_below > 0)
+        flow_stats.encoder.aggregation_factor = static_cast<float>(stats_.pdus_for_below) / stats_.frames_for_below;
+    PayloadPool::Stats pool_stats = pool_->get_stats();
+    flow_stats.encoder.heap_allocations = pool_stats.heap_allocations;
+    flow_stats.encoder.pool_allocations = pool_stats.pool_allocations;
     return flow_stats;
 }
 
@@ -0,0 +1,212 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "gf256.h"
+#include "exceptions.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GF256_X86
+#endif
+
+namespace libgdtp
+{
+
+static const unsigned POLYNOMIAL = 0x11d;
+
+/**
+ * Tables are built once on first use. Besides the full multiplication table,
+ * each coefficient has the products with all low and high nibbles, which is
+ * what the pshufb based region operations look up.
+ */
+struct Gf256Tables
+{
+    Gf256Tables()
+    {
+        unsigned x = 1;
+        for (int i = 0; i < 255; i++) {
+            exp[i] = x;
+            exp[i + 255] = x;
+            log[x] = i;
+            x <<= 1;
+            if (x & 0x100)
+                x ^= POLYNOMIAL;
+        }
+        exp[510] = exp[0];
+        exp[511] = exp[1];
+        log[0] = 0; // undefined, never used
+
+        for (int a = 0; a < 256; a++) {
+            for (int b = 0; b < 256; b++) {
+                mul[a][b] = (a == 0 || b == 0) ? 0 : exp[log[a] + log[b]];
+            }
+            for (int n = 0; n < 16; n++) {
+                lo[a][n] = mul[a][n];
+                hi[a][n] = mul[a][n << 4];
+            }
+        }
+    }
+
+    uint8_t exp[512];
+    uint8_t log[256];
+    uint8_t mul[256][256];
+    uint8_t lo[256][16];
+    uint8_t hi[256][16];
+};
+
+static const Gf256Tables& get_tables(void)
+{
+    static const Gf256Tables tables;
+    return tables;
+}
+
+
+static void mul_add_scalar(uint8_t* dst, const uint8_t* src, const uint8_t* row, const size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        dst[i] ^= row[src[i]];
+    }
+}
+
+#ifdef GF256_X86
+/**
+ * Process 16 bytes at a time, returns the number of bytes done.
+ */
+__attribute__((target("ssse3")))
+static size_t mul_add_ssse3(uint8_t* dst, const uint8_t* src, const uint8_t* lo, const uint8_t* hi, const size_t len)
+{
+    const __m128i tlo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lo));
+    const __m128i thi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hi));
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i l = _mm_shuffle_epi8(tlo, _mm_and_si128(s, mask));
+        const __m128i h = _mm_shuffle_epi8(thi, _mm_and_si128(_mm_srli_epi64(s, 4), mask));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(d, _mm_xor_si128(l, h)));
+    }
+    return i;
+}
+
+
+/**
+ * Process 32 bytes at a time, returns the number of bytes done.
+ */
+__attribute__((target("avx2")))
+static size_t mul_add_avx2(uint8_t* dst, const uint8_t* src, const uint8_t* lo, const uint8_t* hi, const size_t len)
+{
+    const __m256i tlo = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lo)));
+    const __m256i thi = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hi)));
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i l = _mm256_shuffle_epi8(tlo, _mm256_and_si256(s, mask));
+        const __m256i h = _mm256_shuffle_epi8(thi, _mm256_and_si256(_mm256_srli_epi64(s, 4), mask));
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(d, _mm256_xor_si256(l, h)));
+    }
+    return i;
+}
+#endif
+
+
+static Gf256::Impl detect_impl(void)
+{
+#ifdef GF256_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return Gf256::AVX2;
+    if (__builtin_cpu_supports("ssse3"))
+        return Gf256::SSSE3;
+#endif
+    return Gf256::SCALAR;
+}
+
+
+uint8_t Gf256::mul(const uint8_t a, const uint8_t b)
+{
+    return get_tables().mul[a][b];
+}
+
+
+uint8_t Gf256::inv(const uint8_t a)
+{
+    if (a == 0)
+        throw ParameterException("Zero has no inverse.");
+    const Gf256Tables& t = get_tables();
+    return t.exp[255 - t.log[a]];
+}
+
+
+bool Gf256::is_supported(const Impl impl)
+{
+    // every CPU with AVX2 has SSSE3 as well
+    return impl <= get_best_impl();
+}
+
+
+Gf256::Impl Gf256::get_best_impl(void)
+{
+    static const Impl best = detect_impl();
+    return best;
+}
+
+
+std::string Gf256::get_impl_as_string(const Impl impl)
+{
+    switch (impl) {
+    case SCALAR: return "scalar";
+    case SSSE3: return "SSSE3";
+    case AVX2: return "AVX2";
+    default: return "UNKNOWN";
+    }
+}
+
+
+void Gf256::mul_add_region(uint8_t* dst, const uint8_t* src, const uint8_t c, const size_t len)
+{
+    mul_add_region(dst, src, c, len, get_best_impl());
+}
+
+
+void Gf256::mul_add_region(uint8_t* dst, const uint8_t* src, const uint8_t c, const size_t len, const Impl impl)
+{
+    if (not is_supported(impl))
+        throw ParameterException("GF(256) implementation " + get_impl_as_string(impl) + " isn't supported by this CPU.");
+    if (c == 0)
+        return;
+
+    const Gf256Tables& t = get_tables();
+    size_t done = 0;
+#ifdef GF256_X86
+    if (impl == AVX2)
+        done = mul_add_avx2(dst, src, t.lo[c], t.hi[c], len);
+    // the remainder of the wide loop still fits a narrower register
+    if (impl >= SSSE3)
+        done += mul_add_ssse3(dst + done, src + done, t.lo[c], t.hi[c], len - done);
+#endif
+    mul_add_scalar(dst + done, src + done, t.mul[c], len - done);
+}
+
+} // namespace libgdtp
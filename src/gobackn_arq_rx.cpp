@@ -0,0 +1,132 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "gobackn_arq_rx.h"
+#include "flow_base.h"
+
+namespace libgdtp {
+
+GoBackNArqRx::GoBackNArqRx(FlowBase* flow, size_t buffer_size) :
+    ArqBase(flow, buffer_size),
+    expected_seq_no_(1), // the sender starts numbering with one
+    nack_sent_(false)
+{
+    if (2 * get_props()->get_window_size() > get_props()->get_max_seqno())
+        throw ParameterException("Window size must not exceed half of the sequence number space.");
+}
+
+GoBackNArqRx::~GoBackNArqRx(void)
+{
+    ArqExecutor::get_instance().cancel_all(this);
+}
+
+void GoBackNArqRx::handle_pdu_from_below(Pdu&& pdu)
+{
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    if (pdu.get_type() == DATA)
+        handle_data_pdu(pdu);
+    else
+    if (pdu.get_type() == SKIP)
+        handle_skip_pdu(pdu);
+    else
+        throw GdtpException("Invalid frame received on this flow.");
+
+    stats_.pdus_from_below++;
+}
+
+void GoBackNArqRx::handle_data_pdu(Pdu& pdu)
+{
+    LOG_DEBUG("handle_data_pdu()");
+    const bool reliable = (get_props()->get_transfer_mode() == RELIABLE);
+    const SeqNo max_seq_no = get_props()->get_max_seqno();
+    // without ACKs, the sender never goes back, so accept every new PDU
+    const SeqNo window = reliable ? get_props()->get_window_size() : 1;
+    const SeqNo seq_no = pdu.get_seq_no();
+    SeqNo offset = (seq_no + max_seq_no - expected_seq_no_) % max_seq_no;
+
+    // the sender only sends PDUs up to one window ahead of its oldest outstanding PDU,
+    // so a PDU even further ahead means it has given up on the ones we are waiting for
+    if (offset >= window && offset < max_seq_no - window) {
+        SeqNo new_expected = (seq_no + max_seq_no - window + 1) % max_seq_no;
+        uint32_t num_lost = (new_expected + max_seq_no - expected_seq_no_) % max_seq_no;
+        LOG_INFO("Future frame received, lost " << num_lost << " frames.");
+        stats_.lost_pdus += num_lost;
+        expected_seq_no_ = new_expected;
+        nack_sent_ = false;
+        offset = (seq_no + max_seq_no - expected_seq_no_) % max_seq_no;
+    }
+
+    if (offset == 0) {
+        // pass frame to upper layer, only the payload is moved, the header is still needed for the ACK
+        expected_seq_no_ = (expected_seq_no_ + 1) % max_seq_no;
+        nack_sent_ = false;
+        stats_.sdus_for_above++;
+        stats_.bytes_for_above += pdu.get_payload()->size();
+        flow_->queue_pdu_for_above(std::move(pdu));
+    } else
+    if (offset >= max_seq_no - window) {
+        LOG_INFO("Old frame " << seq_no << " received (expected " << expected_seq_no_ << ").");
+    } else {
+        LOG_INFO("Out-of-order frame " << seq_no << " discarded (expected " << expected_seq_no_ << ").");
+    }
+
+    // the cumulative ACK is sent once the whole frame has been handled
+    if (reliable)
+        ack_data_pdu(pdu, 0);
+
+    // the lower layer keeps the order, so the expected PDU got lost, ask for it only once
+    if (reliable && offset != 0 && offset < window && get_props()->get_nack() && not nack_sent_) {
+        nack_pdu(expected_seq_no_);
+        nack_sent_ = true;
+    }
+}
+
+/**
+ * The sender gave up on all PDUs before the seqno of the SKIP, account the
+ * ones we are still waiting for as lost. The ACK confirms the SKIP.
+ */
+void GoBackNArqRx::handle_skip_pdu(Pdu& pdu)
+{
+    LOG_DEBUG("handle_skip_pdu()");
+    const SeqNo max_seq_no = get_props()->get_max_seqno();
+    const SeqNo offset = (pdu.get_seq_no() + max_seq_no - expected_seq_no_) % max_seq_no;
+    // a repeated SKIP is behind the window already
+    if (offset > 0 && offset <= get_props()->get_window_size()) {
+        LOG_INFO("Skipping to frame " << pdu.get_seq_no() << ", lost " << offset << " frames.");
+        stats_.lost_pdus += offset;
+        expected_seq_no_ = pdu.get_seq_no();
+        nack_sent_ = false;
+    }
+    ack_data_pdu(pdu, 0);
+}
+
+/**
+ * A single cumulative ACK for the last in-order PDU.
+ */
+void GoBackNArqRx::update_ack(Pdu& ack)
+{
+    ack.set_seq_no((expected_seq_no_ + get_props()->get_max_seqno() - 1) % get_props()->get_max_seqno());
+}
+
+ASSIGN_LOGPTR(GoBackNArqRx::logger_, GoBackNArqRx::get_name())
+
+}
@@ -0,0 +1,297 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "gobackn_arq_tx.h"
+#include "flow_base.h"
+
+namespace libgdtp {
+
+GoBackNArqTx::GoBackNArqTx(FlowBase* flow, size_t buffer_size) :
+    ArqBase(flow, buffer_size),
+    timer_id_(0),
+    num_timeouts_(0)
+{
+    if (2 * get_props()->get_window_size() > get_props()->get_max_seqno())
+        throw ParameterException("Window size must not exceed half of the sequence number space.");
+}
+
+
+GoBackNArqTx::~GoBackNArqTx(void)
+{
+    ArqExecutor::get_instance().cancel_all(this);
+}
+
+
+void GoBackNArqTx::service_buffer(void)
+{
+    PduVector pdus;
+    {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        fill_window(pdus);
+    }
+    transmit_pdus(pdus);
+}
+
+
+/**
+ * Enqueue PDUs for the lower layer. The mutex_ must NOT be held, because
+ * the scheduler may call back into frame_transmitted(). The executor and
+ * scheduler threads are shared by all flows and don't wait for space.
+ */
+void GoBackNArqTx::transmit_pdus(PduVector& pdus, const bool wait)
+{
+    for (auto& pdu : pdus) {
+        if (wait)
+            flow_->queue_pdu_for_below(std::move(pdu));
+        else
+            flow_->queue_pdu_for_below_nowait(std::move(pdu));
+    }
+}
+
+
+/**
+ * Move new PDUs from the ARQ buffer into the transmit window as long as there is space.
+ * Must be called with mutex_ held.
+ */
+void GoBackNArqTx::fill_window(PduVector& pdus)
+{
+    Pdu pdu;
+    while (window_.size() < get_props()->get_window_size() && buffer_.tryPop(pdu)) {
+        if (drop_if_late(pdu))
+            continue;
+        assign_seq_no(pdu);
+        LOG_DEBUG("Selecting PDU " << pdu.get_seq_no() << " for " << pdu.get_dest_addr() << " for transmission.");
+        tx_pending_.push_back(pdu.get_seq_no());
+        // the window keeps the PDU for retransmissions, only the copy below is handed out
+        window_.push_back({ std::move(pdu), false, false, boost::system_time() });
+        pdus.push_back(window_.back().pdu);
+        stats_.pdus_for_below++;
+    }
+}
+
+
+/**
+ * Go back to the oldest outstanding PDU and send the whole window again,
+ * or give up on the oldest PDU if it has been sent too often.
+ */
+void GoBackNArqTx::handle_timeout(const ArqExecutor::TimerId id)
+{
+    PduVector pdus;
+    {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        if (id != timer_id_)
+            return; // ACK arrived in the meantime
+
+        timer_id_ = 0;
+        assert(not window_.empty());
+        LOG_DEBUG("ACK timeout for PDU " << window_.front().pdu.get_seq_no() << ".");
+        // give up on the oldest PDUs if their deadline has passed
+        Pdu dropped;
+        bool skip = false;
+        while (not window_.empty() && drop_if_late(window_.front().pdu)) {
+            dropped = std::move(window_.front().pdu);
+            window_.pop_front();
+            skip = true;
+        }
+
+        // only timeouts of the oldest PDU count, the others may have simply been discarded by the receiver
+        if (not skip && ++num_timeouts_ >= get_props()->get_max_retransmission()) {
+            LOG_INFO("Frame lost, maximum number of retransnmissions reached.");
+            dropped = std::move(window_.front().pdu);
+            window_.pop_front();
+            stats_.lost_pdus++;
+            skip = true;
+        }
+
+        if (skip) {
+            // the receiver waits for the dropped PDUs until it gets the SKIP and has
+            // discarded all PDUs after them, so these follow the SKIP once more
+            num_timeouts_ = 0;
+            skip_to(dropped, window_.empty() ? next_seq_no_ : window_.front().pdu.get_seq_no(), pdus);
+            retransmit_window(pdus, false);
+            fill_window(pdus);
+        } else {
+            backoff_ack_timeout();
+            retransmit_window(pdus, false);
+        }
+    }
+    transmit_pdus(pdus, false);
+}
+
+
+/**
+ * Send all outstanding PDUs again. Fast retransmissions happen before the
+ * timer of the oldest PDU has expired.
+ * Must be called with mutex_ held.
+ */
+void GoBackNArqTx::retransmit_window(PduVector& pdus, const bool fast)
+{
+    for (auto& slot : window_) {
+        slot.transmitted = false;
+        slot.retransmitted = true;
+        tx_pending_.push_back(slot.pdu.get_seq_no());
+        pdus.push_back(slot.pdu);
+        stats_.pdus_for_below++;
+        stats_.rtx_pdus++;
+        if (fast)
+            stats_.fast_rtx_pdus++;
+        else
+            stats_.timeout_rtx_pdus++;
+    }
+}
+
+
+/**
+ * (Re)start the timer for the oldest outstanding PDU if it has already been transmitted.
+ * Must be called with mutex_ held.
+ */
+void GoBackNArqTx::restart_timer(void)
+{
+    stop_timer();
+    if (not window_.empty() && window_.front().transmitted) {
+        timer_id_ = ArqExecutor::get_instance().schedule(this, get_ack_timeout(),
+                                    std::bind(&GoBackNArqTx::handle_timeout, this, std::placeholders::_1));
+    }
+}
+
+
+/**
+ * Must be called with mutex_ held.
+ */
+void GoBackNArqTx::stop_timer(void)
+{
+    if (timer_id_ != 0) {
+        ArqExecutor::get_instance().cancel(timer_id_);
+        timer_id_ = 0;
+    }
+}
+
+
+void GoBackNArqTx::handle_pdu_from_below(Pdu&& pdu)
+{
+    PduVector pdus;
+    {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        if (pdu.get_type() == ACK)
+            handle_ack_pdu(pdu);
+        else
+        if (pdu.get_type() == NACK)
+            handle_nack_pdu(pdu, pdus);
+        else
+            throw GdtpException("Invalid frame received on this flow.");
+
+        stats_.pdus_from_below++;
+        fill_window(pdus);
+    }
+    transmit_pdus(pdus);
+}
+
+
+void GoBackNArqTx::handle_ack_pdu(Pdu& pdu)
+{
+    LOG_DEBUG("handle_ack_pdu()");
+    confirm_skip(pdu.get_seq_no());
+    if (window_.empty()) {
+        LOG_DEBUG("Ignoring ACK " << pdu.get_seq_no() << ".");
+        return;
+    }
+
+    // the ACK covers all PDUs up to and including its seqno
+    const SeqNo max_seq_no = get_props()->get_max_seqno();
+    SeqNo offset = (pdu.get_seq_no() + max_seq_no - window_.front().pdu.get_seq_no()) % max_seq_no;
+    if (offset >= window_.size()) {
+        LOG_DEBUG("Ignoring old ACK " << pdu.get_seq_no() << ".");
+        return;
+    }
+
+    LOG_DEBUG("Received ACK " << pdu.get_seq_no() << ".");
+    // the newest acknowledged PDU triggered the ACK
+    if (window_[offset].transmitted && not window_[offset].retransmitted)
+        add_rtt_sample(window_[offset].tx_time);
+    window_.erase(window_.begin(), window_.begin() + offset + 1);
+    num_timeouts_ = 0;
+    restart_timer();
+}
+
+
+/**
+ * The receiver got all PDUs before the NACKed one, but not the PDU itself.
+ * Go back to it right away instead of waiting for the timeout. A NACK for a
+ * PDU that is queued for retransmission already is ignored.
+ * Must be called with mutex_ held.
+ */
+void GoBackNArqTx::handle_nack_pdu(Pdu& pdu, PduVector& pdus)
+{
+    LOG_DEBUG("handle_nack_pdu()");
+    if (window_.empty()) {
+        LOG_DEBUG("Ignoring NACK " << pdu.get_seq_no() << ".");
+        return;
+    }
+
+    const SeqNo max_seq_no = get_props()->get_max_seqno();
+    SeqNo offset = (pdu.get_seq_no() + max_seq_no - window_.front().pdu.get_seq_no()) % max_seq_no;
+    if (offset >= window_.size() || not window_[offset].transmitted) {
+        LOG_DEBUG("Ignoring NACK " << pdu.get_seq_no() << ".");
+        return;
+    }
+
+    LOG_DEBUG("Received NACK " << pdu.get_seq_no() << ", going back.");
+    window_.erase(window_.begin(), window_.begin() + offset);
+    num_timeouts_ = 0;
+    retransmit_window(pdus, true);
+    restart_timer();
+}
+
+
+void GoBackNArqTx::frame_transmitted()
+{
+    PduVector pdus;
+    {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        assert(not tx_pending_.empty());
+        SeqNo seq_no = tx_pending_.front();
+        tx_pending_.pop_front();
+
+        for (auto& slot : window_) {
+            if (slot.pdu.get_seq_no() == seq_no) {
+                slot.transmitted = true;
+                slot.tx_time = boost::get_system_time();
+            }
+        }
+
+        if (get_props()->get_transfer_mode() == UNRELIABLE) {
+            // finish transmission of PDUs in the unreliable case
+            while (not window_.empty() && window_.front().transmitted) {
+                window_.pop_front();
+            }
+            fill_window(pdus);
+        } else
+        if (timer_id_ == 0) {
+            restart_timer();
+        }
+    }
+    transmit_pdus(pdus, false);
+}
+
+ASSIGN_LOGPTR(GoBackNArqTx::logger_, GoBackNArqTx::get_name())
+
+}
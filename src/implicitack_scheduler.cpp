@@ -12,8 +12,8 @@ void ImplicitAckScheduler::add_flow(FlowBase* flow)
 {
     boost::lock_guard<boost::mutex> lock(mutex_);
     // only add connections to queue if they are not serviced yet
-    if (serviced_flows_.find(flow->get_src_id()) == serviced_flows_.end()) {
-        serviced_flows_.insert(flow->get_src_id());
+    if (serviced_flows_.find(flow) == serviced_flows_.end()) {
+        serviced_flows_.insert(flow);
         queue_.push(flow);
     }
     not_empty_cond_.notify_one();
@@ -27,7 +27,7 @@ FlowBase* ImplicitAckScheduler::get_next_flow()
     }
     flow_ = queue_.top();
     queue_.pop();
-    serviced_flows_.erase(flow_->get_src_id());
+    serviced_flows_.erase(flow_);
     return flow_;
 }
 
@@ -44,9 +44,10 @@ void ImplicitAckScheduler::get_pdus_for_below(PduVector &pdus)
 
     Pdu pdu;
     flow_->get_frame_for_below(pdu);
-    pdus.push_back(pdu);
+    const bool is_ack = (pdu.get_type() == ACK);
+    pdus.push_back(std::move(pdu));
 
-    if (pdu.get_type() == ACK) {
+    if (is_ack) {
         // try to enqueue another PDU if this is an ACK
         //boost::this_thread::sleep(boost::posix_time::microseconds(10));
         // FIXME: check locking here
@@ -55,7 +56,7 @@ void ImplicitAckScheduler::get_pdus_for_below(PduVector &pdus)
             flow_->frame_transmitted();
             this->get_next_flow();
             flow_->get_frame_for_below(pdu);
-            pdus.push_back(pdu);
+            pdus.push_back(std::move(pdu));
             counter_++;
         }
     } else {
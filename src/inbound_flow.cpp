@@ -38,17 +38,69 @@ void InboundFlow::print_status(void)
     LOG_INFO("  Total transm. PDUs:     " << stats.pdus_for_below);
     LOG_INFO("  Received PDUs:          " << stats.sdus_for_above);
     LOG_INFO("  Lost PDUs:              " << stats.lost_pdus);
+    LOG_INFO("  FEC repair PDUs:        " << stats.repair_pdus);
+    LOG_INFO("  FEC recovered PDUs:     " << stats.recovered_pdus);
     LOG_INFO("  FER:                    " << stats.fer);
 }
 
-void InboundFlow::handle_frame_from_below(Pdu& pdu)
+/**
+ * Repair PDUs end here, lost DATA PDUs they reconstruct are handled as if
+ * they had been received. Received DATA PDUs are remembered by the decoder.
+ */
+void InboundFlow::handle_frame_from_below(Pdu&& pdu)
+{
+    if (pdu.get_type() == REPAIR) {
+        handle_repair_pdu(std::move(pdu));
+        return;
+    }
+    if (fec_active_ && pdu.get_type() == DATA) {
+        std::unique_lock<std::mutex> lock(fec_mutex_);
+        fec_decoder_->add_pdu(pdu);
+    }
+    deliver_pdu(std::move(pdu));
+}
+
+void InboundFlow::handle_repair_pdu(Pdu&& pdu)
+{
+    PduVector recovered;
+    {
+        std::unique_lock<std::mutex> lock(fec_mutex_);
+        if (not fec_decoder_) {
+            fec_decoder_.reset(new FecDecoder());
+            fec_active_ = true;
+        }
+        fec_decoder_->handle_repair_pdu(pdu, recovered);
+    }
+    repair_pdus_++;
+    recovered_pdus_ += recovered.size();
+    for (auto& p : recovered) {
+        LOG_DEBUG("Recovered PDU " << p.get_seq_no() << " from FEC block.");
+        deliver_pdu(std::move(p));
+    }
+}
+
+void InboundFlow::deliver_pdu(Pdu&& pdu)
 {
     // if broadcast, pass up directly
     if (is_broadcast()) {
-        queue_pdu_for_above(pdu);
-    } else {
-        arq_->handle_pdu_from_below(pdu);
+        queue_pdu_for_above(std::move(pdu));
+        return;
+    }
+
+    // hand a piggybacked ACK to the flow of the reverse direction first
+    FlowBase* paired = paired_flow_;
+    if (pdu.has_piggyback_ack() && paired != NULL) {
+        Pdu ack;
+        ack.set_type(ACK);
+        ack.set_source_addr(pdu.get_source_addr());
+        ack.set_dest_addr(pdu.get_dest_addr());
+        ack.set_src_id(pdu.get_dest_id());
+        ack.set_dest_id(paired->get_src_id());
+        ack.set_seq_no(pdu.get_ack_seq_no());
+        ack.set_sack(pdu.get_sack());
+        paired->handle_frame_from_below(std::move(ack));
     }
+    arq_->handle_pdu_from_below(std::move(pdu));
 }
 
 void InboundFlow::frame_transmitted(void)
@@ -47,6 +47,16 @@ void Gdtp::set_scheduler_type(const std::string type, const PortId port)
     impl_->set_scheduler_type(port, type);
 }
 
+void Gdtp::set_aggregation_limits(const size_t max_bytes, const uint32_t max_wait, const PortId port)
+{
+    impl_->set_aggregation_limits(port, max_bytes, max_wait);
+}
+
+void Gdtp::set_codec_type(const std::string type)
+{
+    impl_->set_codec_type(type);
+}
+
 void Gdtp::set_default_source_address(const Addr source)
 {
     impl_->set_default_source_address(source);
@@ -62,9 +72,29 @@ int Gdtp::allocate_flow(const FlowId id, FlowProperties props)
     return impl_->allocate_flow(id, props);
 }
 
-void Gdtp::handle_data_from_above(std::shared_ptr<Data> sdu, const FlowId id)
+void Gdtp::handle_data_from_above(const std::shared_ptr<Data>& sdu, const FlowId id)
+{
+    impl_->handle_data_from_above(std::shared_ptr<Data>(sdu), id);
+}
+
+void Gdtp::handle_data_from_above(std::shared_ptr<Data>&& sdu, const FlowId id)
+{
+    impl_->handle_data_from_above(std::move(sdu), id);
+}
+
+void Gdtp::handle_data_from_above(const std::shared_ptr<Data>& sdu, const FlowId id, const uint32_t deadline)
+{
+    impl_->handle_data_from_above(std::shared_ptr<Data>(sdu), id, deadline);
+}
+
+void Gdtp::handle_data_from_above(std::shared_ptr<Data>&& sdu, const FlowId id, const uint32_t deadline)
+{
+    impl_->handle_data_from_above(std::move(sdu), id, deadline);
+}
+
+void Gdtp::handle_data_from_above_batch(std::vector<std::shared_ptr<Data> >&& data, const FlowId id)
 {
-    impl_->handle_data_from_above(sdu, id);
+    impl_->handle_data_from_above_batch(std::move(data), id);
 }
 
 void Gdtp::handle_data_from_below(const PortId id, Data& data)
@@ -72,6 +102,11 @@ void Gdtp::handle_data_from_below(const PortId id, Data& data)
     impl_->handle_data_from_below(id, data);
 }
 
+void Gdtp::handle_data_from_below(const PortId id, std::shared_ptr<Data> data)
+{
+    impl_->handle_data_from_below(id, data);
+}
+
 void Gdtp::set_data_transmitted(const FlowId id)
 {
     impl_->set_data_transmitted(id);
@@ -87,6 +122,16 @@ std::shared_ptr<Data> Gdtp::get_data_for_above(const FlowId id)
     return impl_->get_data_for_above(id);
 }
 
+size_t Gdtp::get_data_for_above_batch(const FlowId id, std::vector<std::shared_ptr<Data> >& data, const size_t max)
+{
+    return impl_->get_data_for_above_batch(id, data, max);
+}
+
+void Gdtp::register_receive_handler(const FlowId id, ReceiveHandler handler)
+{
+    impl_->register_receive_handler(id, std::move(handler));
+}
+
 bool Gdtp::has_data_for_below(const PortId id)
 {
     return impl_->has_data_for_below(id);
@@ -97,6 +142,16 @@ void Gdtp::get_data_for_below(const FlowId id, Data& data)
     impl_->get_data_for_below(id, data);
 }
 
+bool Gdtp::try_get_data_for_below(const PortId id, Data& data)
+{
+    return impl_->try_get_data_for_below(id, data);
+}
+
+int Gdtp::get_event_fd(const PortId id)
+{
+    return impl_->get_event_fd(id);
+}
+
 void Gdtp::modify_properties(const FlowId id, const FlowProperties props)
 {
     impl_->modify_properties(id, props);
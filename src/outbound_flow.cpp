@@ -23,10 +23,18 @@
 #include "outbound_flow.h"
 #include "networking_helper.h"
 #include "exceptions.h"
+#include "arq_executor.h"
 
 namespace libgdtp
 {
 
+OutboundFlow::~OutboundFlow()
+{
+    // the FEC timer uses the encoder
+    ArqExecutor::get_instance().cancel_all(this);
+}
+
+
 void OutboundFlow::print_status(void)
 {
     ArqStats stats = get_stats(TOTAL);
@@ -40,8 +48,15 @@ void OutboundFlow::print_status(void)
     LOG_INFO("  Received SDUs:          " << stats.sdus_for_above);
     LOG_INFO("  Total transm. PDUs:     " << stats.pdus_for_below);
     LOG_INFO("  Retransm. PDUs:         " << stats.rtx_pdus);
+    LOG_INFO("    .. fast:              " << stats.fast_rtx_pdus);
+    LOG_INFO("    .. after timeout:     " << stats.timeout_rtx_pdus);
     LOG_INFO("  Lost PDUs:              " << stats.lost_pdus);
+    LOG_INFO("  Dropped late PDUs:      " << stats.dropped_late);
+    LOG_INFO("  FEC repair PDUs:        " << stats.repair_pdus);
     LOG_INFO("  FER:                    " << stats.fer);
+    for (auto& lane : lanes_) {
+        lane->print_status();
+    }
 }
 
 
@@ -51,14 +66,55 @@ void OutboundFlow::print_status(void)
  * transmit queue of the connection.
  *
  * @param the incoming SDU as StackDataSet
+ * @param deadline after which the SDU is dropped, the flow's max latency may shorten it
  */
-void OutboundFlow::handle_frame_from_above(std::shared_ptr<Data> sdu)
+void OutboundFlow::handle_frame_from_above(std::shared_ptr<Data>&& sdu, boost::posix_time::ptime deadline)
 {
     std::unique_lock<std::mutex> lock(mutex_);
 
+    Pdu pdu = make_pdu(std::move(sdu), deadline);
+    if (is_broadcast()) {
+        // send broadcast frames directly without ARQ
+        queue_pdu_for_below(std::move(pdu));
+    } else {
+        // only handle acknowledeged connections with ARQ
+        arq_->handle_pdu_from_above(std::move(pdu));
+    }
+}
+
+
+/**
+ * @brief Same as above for a burst of SDUs, the flow is locked only once and
+ * the ARQ is serviced once per run of free buffer slots.
+ */
+void OutboundFlow::handle_frames_from_above(std::vector<std::shared_ptr<Data> >& sdus, boost::posix_time::ptime deadline)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    PduVector pdus;
+    pdus.reserve(sdus.size());
+    for (auto& sdu : sdus) {
+        pdus.push_back(make_pdu(std::move(sdu), deadline));
+    }
+
+    if (is_broadcast()) {
+        for (auto& pdu : pdus) {
+            queue_pdu_for_below(std::move(pdu));
+        }
+    } else {
+        arq_->handle_pdus_from_above(std::move(pdus));
+    }
+}
+
+
+/**
+ * Frame an SDU, must be called with mutex_ held.
+ */
+Pdu OutboundFlow::make_pdu(std::shared_ptr<Data>&& sdu, boost::posix_time::ptime deadline)
+{
 #ifdef __unix__
     // overwrite addresses if needed
-    if (get_props().get_addressing_mode() == IMPLICIT) {
+    if (get_props()->get_addressing_mode() == IMPLICIT) {
         uint32_t src, dst;
         NetworkingHelper::get_ipv4_addresses(sdu, src, dst);
         src_addr_ = src;
@@ -66,37 +122,59 @@ void OutboundFlow::handle_frame_from_above(std::shared_ptr<Data> sdu)
     }
 #endif
 
-    Pdu pdu(sdu);
+    Pdu pdu(std::move(sdu));
     pdu.set_dest_addr(dest_addr_);
     pdu.set_source_addr(src_addr_);
     pdu.set_type(DATA);
     pdu.set_src_id(src_id_);
     pdu.set_dest_id(dest_id_);
-    pdu.set_seq_no(get_next_seq_no());
-    if (is_broadcast()) {
-        // send broadcast frames directly without ARQ
-        queue_pdu_for_below(pdu);
-    } else {
-        // only handle acknowledeged connections with ARQ
-        arq_->handle_pdu_from_above(pdu);
+    // the ARQ numbers PDUs once they enter its window, late ones never get a seqno
+    if (is_broadcast())
+        pdu.set_seq_no(get_next_seq_no());
+    const uint32_t max_latency = get_props()->get_max_latency();
+    if (max_latency > 0) {
+        deadline = std::min(deadline, boost::get_system_time() + boost::posix_time::milliseconds(max_latency));
     }
+    pdu.set_deadline(deadline);
+    return pdu;
 }
 
 
-void OutboundFlow::handle_frame_from_below(Pdu& pdu)
+void OutboundFlow::handle_frame_from_below(Pdu&& pdu)
 {
     if (is_broadcast()) {
         throw GdtpException("Getting PDU from below on unacknowleged outbound connection.");
     }
 
     // pass PDU to arq instance
-    arq_->handle_pdu_from_below(pdu);
+    arq_->handle_pdu_from_below(std::move(pdu));
+}
+
+
+void OutboundFlow::frame_taken_for_below(const Pdu& pdu)
+{
+    if (fec_encoder_) {
+        std::unique_lock<std::mutex> lock(taken_mutex_);
+        taken_repairs_.push_back(pdu.get_type() == REPAIR);
+    }
 }
 
 
 void OutboundFlow::frame_transmitted(void)
 {
     LOG_DEBUG("frame_transmitted()");
+    if (fec_encoder_) {
+        // repairs of a block closed by the timer may still wait for space
+        queue_fec_pdus(0, false);
+
+        // the ARQ doesn't know about repair PDUs
+        std::unique_lock<std::mutex> lock(taken_mutex_);
+        assert(not taken_repairs_.empty());
+        const bool repair = taken_repairs_.front();
+        taken_repairs_.pop_front();
+        if (repair)
+            return;
+    }
     if (not is_broadcast()) {
         // may have to wait for ACK
         arq_->frame_transmitted();
@@ -104,9 +182,189 @@ void OutboundFlow::frame_transmitted(void)
 }
 
 
+/**
+ * Striped flows hand PDUs to one of their lanes, the scheduler of the lane's port
+ * takes it from there. With FEC, every DATA PDU (including retransmissions) is added
+ * to the current block and the repair PDUs are queued right after the PDU that
+ * completes it. Partial blocks are closed after the maximum FEC delay. Returns
+ * once the PDU has been queued, like for flows without FEC.
+ */
+void OutboundFlow::queue_pdu_for_below(Pdu&& pdu)
+{
+    if (not lanes_.empty()) {
+        select_lane()->queue_pdu_for_below(std::move(pdu));
+        return;
+    }
+    if (not fec_encoder_) {
+        FlowBase::queue_pdu_for_below(std::move(pdu));
+        return;
+    }
+
+    queue_fec_pdus(add_fec_pdu(std::move(pdu)), true);
+}
+
+
+/**
+ * Same as above, but the PDUs that don't fit are queued with the next PDU
+ * or once a frame has been transmitted.
+ */
+void OutboundFlow::queue_pdu_for_below_nowait(Pdu&& pdu)
+{
+    if (not lanes_.empty()) {
+        select_lane()->queue_pdu_for_below_nowait(std::move(pdu));
+        return;
+    }
+    if (not fec_encoder_) {
+        FlowBase::queue_pdu_for_below_nowait(std::move(pdu));
+        return;
+    }
+
+    add_fec_pdu(std::move(pdu));
+    queue_fec_pdus(0, false);
+}
+
+
+/**
+ * Add the PDU to the current FEC block and to fec_pending_.
+ * @return the number of PDUs ever added once the PDU and its repairs are queued
+ */
+uint64_t OutboundFlow::add_fec_pdu(Pdu&& pdu)
+{
+    std::unique_lock<std::mutex> lock(fec_mutex_);
+    PduVector repairs;
+    // SKIPs keep their place in the queue, but aren't protected
+    if (pdu.get_type() == DATA) {
+        fec_encoder_->add_pdu(pdu, repairs);
+        if (fec_encoder_->get_num_pdus() == 1) {
+            const uint32_t block_id = fec_encoder_->get_block_id();
+            ArqExecutor::get_instance().schedule(this, get_props()->get_fec_max_delay(), [this, block_id](const ArqExecutor::TimerId) {
+                handle_fec_timeout(block_id);
+            });
+        }
+    }
+    fec_pending_.push_back(std::move(pdu));
+    fec_added_++;
+    add_repair_pdus(repairs);
+    return fec_added_;
+}
+
+
+/**
+ * Must be called with fec_mutex_ held.
+ */
+void OutboundFlow::add_repair_pdus(PduVector& repairs)
+{
+    repair_pdus_ += repairs.size();
+    for (auto& repair : repairs) {
+        fec_pending_.push_back(std::move(repair));
+    }
+    fec_added_ += repairs.size();
+}
+
+
+/**
+ * Move PDUs from fec_pending_ to the buffer. A single thread queues at a time,
+ * which keeps the order without holding fec_mutex_ on a full buffer. If wait
+ * is set, return once the first count PDUs ever added have been queued,
+ * otherwise queue only as many as fit without blocking.
+ */
+void OutboundFlow::queue_fec_pdus(const uint64_t count, const bool wait)
+{
+    std::unique_lock<std::mutex> lock(fec_mutex_);
+    while (fec_draining_) {
+        if (not wait || fec_queued_ >= count)
+            return;
+        fec_queued_cond_.wait(lock);
+    }
+
+    fec_draining_ = true;
+    while (not fec_pending_.empty() && (not wait || fec_queued_ < count)) {
+        // only the draining thread adds to the buffer, so it can't fill up meanwhile
+        if (not wait && buffer_for_below_.size() >= buffer_for_below_.capacity())
+            break;
+        Pdu pdu = std::move(fec_pending_.front());
+        fec_pending_.pop_front();
+        lock.unlock();
+        FlowBase::queue_pdu_for_below(std::move(pdu));
+        lock.lock();
+        fec_queued_++;
+    }
+    fec_draining_ = false;
+    fec_queued_cond_.notify_all();
+}
+
+
+/**
+ * Runs on the executor thread shared by all flows, hence it never waits for
+ * space in the buffer. Repairs that don't fit are queued with the next PDU
+ * or once a frame has been transmitted.
+ */
+void OutboundFlow::handle_fec_timeout(const uint32_t block_id)
+{
+    {
+        std::unique_lock<std::mutex> lock(fec_mutex_);
+        if (not fec_encoder_->has_open_block() || fec_encoder_->get_block_id() != block_id)
+            return; // the block has been completed in the meantime
+
+        LOG_DEBUG("Closing partial FEC block " << block_id << ".");
+        PduVector repairs;
+        fec_encoder_->flush(repairs);
+        add_repair_pdus(repairs);
+    }
+    queue_fec_pdus(0, false);
+}
+
+
+StripeLane* OutboundFlow::select_lane(void)
+{
+    std::unique_lock<std::mutex> lock(stripe_mutex_);
+    size_t best = 0;
+    if (get_props()->get_striping_mode() == SHORTEST_QUEUE) {
+        // compare (depth + 1) / weight without dividing
+        for (size_t i = 1; i < lanes_.size(); i++) {
+            if ((lanes_[i]->get_below_buffer_size() + 1) * lanes_[best]->get_stripe_weight() <
+                (lanes_[best]->get_below_buffer_size() + 1) * lanes_[i]->get_stripe_weight()) {
+                best = i;
+            }
+        }
+    } else {
+        // smooth weighted round-robin, interleaves the lanes instead of sending bursts
+        int64_t total = 0;
+        for (size_t i = 0; i < lanes_.size(); i++) {
+            lane_credits_[i] += lanes_[i]->get_stripe_weight();
+            total += lanes_[i]->get_stripe_weight();
+            if (lane_credits_[i] > lane_credits_[best])
+                best = i;
+        }
+        lane_credits_[best] -= total;
+    }
+    return lanes_[best].get();
+}
+
+
+void OutboundFlow::set_properties(FlowProperties props)
+{
+    FlowBase::set_properties(props);
+    for (auto& lane : lanes_) {
+        props.set_below_port(lane->get_below_port_name());
+        lane->set_properties(props);
+    }
+}
+
+
+std::vector<FlowBase*> OutboundFlow::get_stripe_lanes(void)
+{
+    std::vector<FlowBase*> lanes;
+    for (auto& lane : lanes_) {
+        lanes.push_back(lane.get());
+    }
+    return lanes;
+}
+
+
 SeqNo OutboundFlow::get_next_seq_no(void)
 {
-    return ((++seq_no_) % get_props().get_max_seqno());
+    return ((++seq_no_) % get_props()->get_max_seqno());
 }
 
 
@@ -0,0 +1,130 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "payload_pool.h"
+
+namespace libgdtp
+{
+
+PayloadPool::PayloadPool(const size_t max_free) :
+    max_free_(max_free),
+    block_size_(0),
+    stats_()
+{
+    free_buffers_.reserve(max_free_);
+    free_blocks_.reserve(max_free_);
+}
+
+
+PayloadPool::~PayloadPool()
+{
+    for (auto& data : free_buffers_) {
+        delete data;
+    }
+    for (auto& block : free_blocks_) {
+        ::operator delete(block);
+    }
+}
+
+
+std::shared_ptr<Data> PayloadPool::allocate(const size_t size)
+{
+    Data* data = NULL;
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        if (not free_buffers_.empty()) {
+            data = free_buffers_.back();
+            free_buffers_.pop_back();
+            stats_.pool_allocations++;
+        } else {
+            stats_.heap_allocations++;
+        }
+    }
+    if (data == NULL) {
+        data = new Data;
+    }
+    // no reallocation if the buffer has been used for a payload of this size before
+    data->resize(size);
+    return std::shared_ptr<Data>(data, Deleter(this), BlockAllocator<Data>(shared_from_this()));
+}
+
+
+std::shared_ptr<Data> PayloadPool::allocate(const uint8_t* begin, const uint8_t* end)
+{
+    std::shared_ptr<Data> data = allocate(0);
+    data->assign(begin, end);
+    return data;
+}
+
+
+PayloadPool::Stats PayloadPool::get_stats(void)
+{
+    boost::mutex::scoped_lock lock(mutex_);
+    return stats_;
+}
+
+
+void PayloadPool::release(Data* data)
+{
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        if (free_buffers_.size() < max_free_) {
+            free_buffers_.push_back(data);
+            return;
+        }
+    }
+    delete data;
+}
+
+
+void* PayloadPool::allocate_block(const size_t size)
+{
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        if (block_size_ == 0) {
+            block_size_ = size;
+        }
+        if (size == block_size_ && not free_blocks_.empty()) {
+            void* block = free_blocks_.back();
+            free_blocks_.pop_back();
+            stats_.pool_allocations++;
+            return block;
+        }
+        stats_.heap_allocations++;
+    }
+    return ::operator new(size);
+}
+
+
+void PayloadPool::release_block(void* block, const size_t size)
+{
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        if (size == block_size_ && free_blocks_.size() < max_free_) {
+            free_blocks_.push_back(block);
+            return;
+        }
+    }
+    ::operator delete(block);
+}
+
+} // namespace libgdtp
@@ -0,0 +1,76 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "rtt_estimator.h"
+
+namespace libgdtp
+{
+
+// gains and limits as recommended by RFC 6298
+static const double ALPHA = 1.0 / 8;
+static const double BETA = 1.0 / 4;
+static const double K = 4;
+static const double GRANULARITY = 1; ///< resolution of the ARQ timers in ms
+static const uint32_t MAX_BACKOFFS = 16;
+
+RttEstimator::RttEstimator() :
+    has_sample_(false),
+    srtt_(0),
+    rttvar_(0),
+    num_backoffs_(0)
+{
+}
+
+
+void RttEstimator::add_sample(const boost::posix_time::time_duration& rtt)
+{
+    const double r = rtt.total_microseconds() / 1000.0;
+    if (not has_sample_) {
+        srtt_ = r;
+        rttvar_ = r / 2;
+        has_sample_ = true;
+    } else {
+        rttvar_ = (1 - BETA) * rttvar_ + BETA * std::abs(srtt_ - r);
+        srtt_ = (1 - ALPHA) * srtt_ + ALPHA * r;
+    }
+    num_backoffs_ = 0;
+}
+
+
+void RttEstimator::backoff(void)
+{
+    // the RTO is clamped anyway, only avoid overflowing the shift
+    num_backoffs_ = std::min(num_backoffs_ + 1, MAX_BACKOFFS);
+}
+
+
+uint32_t RttEstimator::get_rto(const uint32_t initial, const uint32_t min, const uint32_t max) const
+{
+    double rto = has_sample_ ? srtt_ + std::max(GRANULARITY, K * rttvar_) : initial;
+    rto *= (1 << num_backoffs_);
+    rto = std::min<double>(std::round(rto), max);
+    return std::max(min, static_cast<uint32_t>(rto));
+}
+
+} // namespace libgdtp
@@ -21,14 +21,113 @@
  */
 
 #include "scheduler_base.h"
+#ifdef __linux__
+#include <cerrno>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
 
 namespace libgdtp {
 
+SchedulerBase::~SchedulerBase()
+{
+#ifdef __linux__
+    if (event_fd_ >= 0)
+        close(event_fd_);
+#endif
+}
+
+
+/**
+ * Get the PDUs of the next frame only if a flow is waiting. As only the tx
+ * thread of the port takes flows from the scheduler, this doesn't block.
+ * @return false if no flow is waiting
+ */
+bool SchedulerBase::try_get_pdus_for_below(PduVector &pdus)
+{
+    if (not has_waiting_flow())
+        return false;
+
+    get_pdus_for_below(pdus);
+    return true;
+}
+
+
 void SchedulerBase::set_pdus_transmitted(void)
 {
-    boost::mutex::scoped_lock lock(mutex_);
-    assert(flow_ != NULL);
-    flow_->frame_transmitted();
+    FlowBase* flow;
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        assert(flow_ != NULL);
+        flow = flow_;
+    }
+    // notify the flow without holding the lock, the ARQ may enqueue new PDUs
+    flow->frame_transmitted();
+}
+
+
+void SchedulerBase::set_aggregation_limits(const size_t, const uint32_t)
+{
+    throw ParameterException("Scheduler doesn't aggregate PDUs.");
+}
+
+
+int SchedulerBase::get_event_fd(void)
+{
+#ifdef __linux__
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        if (event_fd_ < 0) {
+            event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (event_fd_ < 0)
+                throw GdtpException("Couldn't create event fd.");
+        }
+    }
+    // flows may have been waiting already
+    if (has_waiting_flow())
+        signal_event_fd();
+    return event_fd_;
+#else
+    throw GdtpException("Event fds are only supported on Linux.");
+#endif
+}
+
+
+/**
+ * Make the event fd readable, called whenever a flow becomes ready.
+ */
+void SchedulerBase::signal_event_fd(void)
+{
+#ifdef __linux__
+    // only write if the fd isn't readable already, this saves a syscall per PDU
+    if (event_fd_ < 0 || event_set_.exchange(true))
+        return;
+
+    uint64_t one = 1;
+    if (write(event_fd_, &one, sizeof(one)) != sizeof(one))
+        event_set_ = false;
+#endif
+}
+
+
+/**
+ * Drain the event fd once no flow is waiting anymore, called by the tx thread
+ * after it took a frame.
+ */
+void SchedulerBase::update_event_fd(void)
+{
+#ifdef __linux__
+    if (event_fd_ < 0 || has_waiting_flow())
+        return;
+
+    // drain first, a flow becoming ready meanwhile then writes again
+    uint64_t count;
+    if (read(event_fd_, &count, sizeof(count)) < 0 && errno != EAGAIN)
+        throw GdtpException("Couldn't read event fd.");
+    event_set_ = false;
+    if (has_waiting_flow())
+        signal_event_fd();
+#endif
 }
 
 } // namespace libgdtp
@@ -0,0 +1,192 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "selectiverepeat_arq_rx.h"
+#include "flow_base.h"
+
+namespace libgdtp {
+
+SelectiveRepeatArqRx::SelectiveRepeatArqRx(FlowBase* flow, size_t buffer_size) :
+    ArqBase(flow, buffer_size),
+    rx_base_(1), // the sender starts numbering with one
+    rx_next_(1)
+{
+    if (2 * get_props()->get_window_size() > get_props()->get_max_seqno())
+        throw ParameterException("Window size must not exceed half of the sequence number space.");
+}
+
+SelectiveRepeatArqRx::~SelectiveRepeatArqRx(void)
+{
+    ArqExecutor::get_instance().cancel_all(this);
+}
+
+void SelectiveRepeatArqRx::handle_pdu_from_below(Pdu&& pdu)
+{
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    if (pdu.get_type() == DATA)
+        handle_data_pdu(pdu);
+    else
+    if (pdu.get_type() == SKIP)
+        handle_skip_pdu(pdu);
+    else
+        throw GdtpException("Invalid frame received on this flow.");
+
+    stats_.pdus_from_below++;
+}
+
+void SelectiveRepeatArqRx::handle_data_pdu(Pdu& pdu)
+{
+    LOG_DEBUG("handle_data_pdu()");
+    const bool reliable = (get_props()->get_transfer_mode() == RELIABLE);
+    const SeqNo max_seq_no = get_props()->get_max_seqno();
+    // without ACKs, the sender never waits for us, so don't wait for missing PDUs either
+    const SeqNo window = reliable ? get_props()->get_window_size() : 1;
+    const SeqNo seq_no = pdu.get_seq_no();
+    const SeqNo offset = (seq_no + max_seq_no - rx_base_) % max_seq_no;
+
+    // the ACK is sent once the whole frame has been handled, it covers all PDUs received so far
+    if (reliable)
+        ack_data_pdu(pdu, 0);
+
+    // we have to consider three cases ..
+    // - offset < window, the PDU is inside the receive window
+    // - offset >= max_seq_no - window, this is an old PDU whose ACK got lost, acknowledge again
+    // - otherwise, the sender has moved its window beyond ours, which it only does after giving
+    //   up on the PDUs in between. Hence, slide our window such that this PDU is the last one in it
+    if (offset >= window) {
+        if (offset >= max_seq_no - window) {
+            LOG_INFO("Old frame " << seq_no << " received (expected " << rx_base_ << ").");
+            return;
+        }
+        advance_window((seq_no + max_seq_no - window + 1) % max_seq_no);
+    }
+
+    if (reliable && get_props()->get_nack())
+        detect_gap(seq_no);
+
+    if (reorder_buffer_.find(seq_no) != reorder_buffer_.end()) {
+        LOG_INFO("Duplicate frame received.");
+        return;
+    }
+    reorder_buffer_[seq_no] = std::move(pdu);
+    deliver_in_order();
+}
+
+/**
+ * The sender gave up on all PDUs before the seqno of the SKIP, pass up those
+ * we hold and account the others as lost. The ACK confirms the SKIP.
+ */
+void SelectiveRepeatArqRx::handle_skip_pdu(Pdu& pdu)
+{
+    LOG_DEBUG("handle_skip_pdu()");
+    const SeqNo max_seq_no = get_props()->get_max_seqno();
+    const SeqNo offset = (pdu.get_seq_no() + max_seq_no - rx_base_) % max_seq_no;
+    // a repeated SKIP is behind the window already
+    if (offset > 0 && offset <= get_props()->get_window_size()) {
+        LOG_INFO("Skipping to frame " << pdu.get_seq_no() << " (expected " << rx_base_ << ").");
+        advance_window(pdu.get_seq_no());
+    }
+    ack_data_pdu(pdu, 0);
+}
+
+/**
+ * The lower layer keeps the order of PDUs, hence all PDUs between the highest
+ * seqno received so far and this one have been lost. Retransmissions arrive
+ * below that seqno and don't trigger further NACKs.
+ */
+void SelectiveRepeatArqRx::detect_gap(const SeqNo seq_no)
+{
+    const SeqNo max_seq_no = get_props()->get_max_seqno();
+    const SeqNo window = get_props()->get_window_size();
+    // the window may have been moved beyond rx_next_
+    if ((rx_next_ + max_seq_no - rx_base_) % max_seq_no > window)
+        rx_next_ = rx_base_;
+
+    const SeqNo gap = (seq_no + max_seq_no - rx_next_) % max_seq_no;
+    if (gap >= window)
+        return; // PDU below rx_next_
+
+    for (SeqNo i = 0; i < gap; i++) {
+        nack_pdu((rx_next_ + i) % max_seq_no);
+    }
+    rx_next_ = (seq_no + 1) % max_seq_no;
+}
+
+/**
+ * The ACK is cumulative up to the PDU before rx_base_, PDUs in the reorder
+ * buffer are marked in the SACK bitmap.
+ */
+void SelectiveRepeatArqRx::update_ack(Pdu& ack)
+{
+    const SeqNo max_seq_no = get_props()->get_max_seqno();
+    uint64_t sack = 0;
+    for (auto& it : reorder_buffer_) {
+        const SeqNo offset = (it.first + max_seq_no - rx_base_) % max_seq_no;
+        if (offset < 64)
+            sack |= uint64_t(1) << offset;
+    }
+    ack.set_seq_no((rx_base_ + max_seq_no - 1) % max_seq_no);
+    ack.set_sack(sack);
+}
+
+/**
+ * Move the lower edge of the receive window up to new_base. PDUs that are
+ * still missing by then are accounted as lost.
+ */
+void SelectiveRepeatArqRx::advance_window(const SeqNo new_base)
+{
+    const SeqNo max_seq_no = get_props()->get_max_seqno();
+    SeqNo num_slots = (new_base + max_seq_no - rx_base_) % max_seq_no;
+    for (SeqNo i = 0; i < num_slots; i++) {
+        std::map<SeqNo, Pdu>::iterator it = reorder_buffer_.find(rx_base_);
+        if (it == reorder_buffer_.end()) {
+            stats_.lost_pdus++;
+        } else {
+            stats_.sdus_for_above++;
+            stats_.bytes_for_above += it->second.get_payload()->size();
+            flow_->queue_pdu_for_above(std::move(it->second));
+            reorder_buffer_.erase(it);
+        }
+        rx_base_ = (rx_base_ + 1) % max_seq_no;
+    }
+    deliver_in_order();
+}
+
+/**
+ * Pass all consecutive PDUs starting at rx_base_ to the upper layer.
+ */
+void SelectiveRepeatArqRx::deliver_in_order(void)
+{
+    const SeqNo max_seq_no = get_props()->get_max_seqno();
+    std::map<SeqNo, Pdu>::iterator it;
+    while ((it = reorder_buffer_.find(rx_base_)) != reorder_buffer_.end()) {
+        stats_.sdus_for_above++;
+        stats_.bytes_for_above += it->second.get_payload()->size();
+        flow_->queue_pdu_for_above(std::move(it->second));
+        reorder_buffer_.erase(it);
+        rx_base_ = (rx_base_ + 1) % max_seq_no;
+    }
+}
+
+ASSIGN_LOGPTR(SelectiveRepeatArqRx::logger_, SelectiveRepeatArqRx::get_name())
+
+}
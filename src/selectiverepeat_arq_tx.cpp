@@ -0,0 +1,327 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "selectiverepeat_arq_tx.h"
+#include "flow_base.h"
+
+namespace libgdtp {
+
+SelectiveRepeatArqTx::SelectiveRepeatArqTx(FlowBase* flow, size_t buffer_size) :
+    ArqBase(flow, buffer_size)
+{
+    if (2 * get_props()->get_window_size() > get_props()->get_max_seqno())
+        throw ParameterException("Window size must not exceed half of the sequence number space.");
+}
+
+
+SelectiveRepeatArqTx::~SelectiveRepeatArqTx(void)
+{
+    ArqExecutor::get_instance().cancel_all(this);
+}
+
+
+void SelectiveRepeatArqTx::service_buffer(void)
+{
+    PduVector pdus;
+    {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        fill_window(pdus);
+    }
+    transmit_pdus(pdus);
+}
+
+
+/**
+ * Enqueue PDUs for the lower layer. The mutex_ must NOT be held, because
+ * the scheduler may call back into frame_transmitted(). The executor and
+ * scheduler threads are shared by all flows and don't wait for space.
+ */
+void SelectiveRepeatArqTx::transmit_pdus(PduVector& pdus, const bool wait)
+{
+    for (auto& pdu : pdus) {
+        if (wait)
+            flow_->queue_pdu_for_below(std::move(pdu));
+        else
+            flow_->queue_pdu_for_below_nowait(std::move(pdu));
+    }
+}
+
+
+/**
+ * Move new PDUs from the ARQ buffer into the transmit window as long as there is space.
+ * Must be called with mutex_ held.
+ */
+void SelectiveRepeatArqTx::fill_window(PduVector& pdus)
+{
+    Pdu pdu;
+    while (window_.size() < get_props()->get_window_size() && buffer_.tryPop(pdu)) {
+        if (drop_if_late(pdu))
+            continue;
+        assign_seq_no(pdu);
+        LOG_DEBUG("Selecting PDU " << pdu.get_seq_no() << " for " << pdu.get_dest_addr() << " for transmission.");
+        tx_pending_.push_back(pdu.get_seq_no());
+        // the window keeps the PDU for retransmissions, only the copy below is handed out
+        window_.push_back({ std::move(pdu), 1, false, false, 0, 0, boost::system_time() });
+        pdus.push_back(window_.back().pdu);
+        stats_.pdus_for_below++;
+    }
+}
+
+
+/**
+ * Retransmit the PDU whose timer has expired or give up on it.
+ */
+void SelectiveRepeatArqTx::handle_timeout(const ArqExecutor::TimerId id)
+{
+    PduVector pdus;
+    {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        TxSlot* slot = NULL;
+        for (auto& it : window_) {
+            if (it.timer_id == id)
+                slot = &it;
+        }
+        if (slot == NULL || slot->done)
+            return; // ACK arrived in the meantime
+
+        LOG_DEBUG("ACK timeout for PDU " << slot->pdu.get_seq_no() << ".");
+        slot->timer_id = 0;
+        // a burst of timeouts of PDUs sent with the same timeout only backs off once
+        if (slot->timeout >= get_ack_timeout())
+            backoff_ack_timeout();
+        retransmit(*slot, pdus, false);
+        slide_window(pdus);
+        fill_window(pdus);
+    }
+    transmit_pdus(pdus, false);
+}
+
+
+/**
+ * Send a PDU again or give up on it. The caller has to slide the window afterwards.
+ * Fast retransmissions happen before the timer of the PDU has expired.
+ * Must be called with mutex_ held.
+ */
+void SelectiveRepeatArqTx::retransmit(TxSlot& slot, PduVector& pdus, const bool fast)
+{
+    if (slot.num_tx >= get_props()->get_max_retransmission()) {
+        LOG_INFO("Frame lost, maximum number of retransnmissions reached.");
+        slot.done = true;
+        slot.abandoned = true;
+        stats_.lost_pdus++;
+    } else
+    if (drop_if_late(slot.pdu)) {
+        slot.done = true;
+        slot.abandoned = true;
+    } else {
+        slot.num_tx++;
+        tx_pending_.push_back(slot.pdu.get_seq_no());
+        pdus.push_back(slot.pdu);
+        stats_.pdus_for_below++;
+        stats_.rtx_pdus++;
+        if (fast)
+            stats_.fast_rtx_pdus++;
+        else
+            stats_.timeout_rtx_pdus++;
+    }
+}
+
+
+/**
+ * Remove all completed PDUs from the head of the window. If some of them
+ * have been given up, the receiver is told to skip up to the new head.
+ * Must be called with mutex_ held.
+ */
+void SelectiveRepeatArqTx::slide_window(PduVector& pdus)
+{
+    Pdu abandoned;
+    bool skip = false;
+    while (not window_.empty() && window_.front().done) {
+        if (window_.front().abandoned) {
+            abandoned = std::move(window_.front().pdu);
+            skip = true;
+        }
+        window_.pop_front();
+    }
+    if (skip)
+        skip_to(abandoned, window_.empty() ? next_seq_no_ : window_.front().pdu.get_seq_no(), pdus);
+}
+
+
+SelectiveRepeatArqTx::TxSlot* SelectiveRepeatArqTx::find_slot(const SeqNo seq_no)
+{
+    for (auto& slot : window_) {
+        if (slot.pdu.get_seq_no() == seq_no)
+            return &slot;
+    }
+    return NULL;
+}
+
+
+void SelectiveRepeatArqTx::handle_pdu_from_below(Pdu&& pdu)
+{
+    PduVector pdus;
+    {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        if (pdu.get_type() == ACK)
+            handle_ack_pdu(pdu, pdus);
+        else
+        if (pdu.get_type() == NACK)
+            handle_nack_pdu(pdu, pdus);
+        else
+            throw GdtpException("Invalid frame received on this flow.");
+
+        stats_.pdus_from_below++;
+        fill_window(pdus);
+    }
+    transmit_pdus(pdus);
+}
+
+
+/**
+ * The ACK covers all PDUs up to and including its seqno and those marked in its
+ * SACK bitmap. Outstanding PDUs that were sent before the newest acknowledged one
+ * have been lost as long as the lower layer keeps the order, only these holes are
+ * retransmitted right away.
+ * Must be called with mutex_ held.
+ */
+void SelectiveRepeatArqTx::handle_ack_pdu(Pdu& pdu, PduVector& pdus)
+{
+    LOG_DEBUG("handle_ack_pdu()");
+    confirm_skip(pdu.get_seq_no());
+    const SeqNo max_seq_no = get_props()->get_max_seqno();
+    const SeqNo window = get_props()->get_window_size();
+    const uint64_t sack = pdu.get_sack();
+
+    TxSlot* newest = NULL; // most recently transmitted PDU acknowledged by this ACK
+    for (auto& slot : window_) {
+        if (slot.done)
+            continue;
+        // PDUs up to the cumulative ACK wrap around to the end of the seqno space
+        const SeqNo offset = (slot.pdu.get_seq_no() + max_seq_no - pdu.get_seq_no() - 1) % max_seq_no;
+        const bool acked = (offset >= max_seq_no - window) || (offset < 64 && ((sack >> offset) & 1));
+        if (not acked)
+            continue;
+
+        LOG_DEBUG("Received ACK for PDU " << slot.pdu.get_seq_no() << ".");
+        slot.done = true;
+        ArqExecutor::get_instance().cancel(slot.timer_id);
+        slot.timer_id = 0;
+        if (newest == NULL || newest->tx_time < slot.tx_time)
+            newest = &slot;
+    }
+    if (newest == NULL) {
+        LOG_DEBUG("Ignoring ACK " << pdu.get_seq_no() << ".");
+        return;
+    }
+    if (newest->num_tx == 1)
+        add_rtt_sample(newest->tx_time);
+
+    // striped flows are reordered by the ports, their holes are left to the timers,
+    // receivers that send NACKs report holes on their own, and holes of FEC flows
+    // may still be filled by the repair PDUs of the block
+    if (get_props()->get_striping_mode() != NO_STRIPING || get_props()->get_nack() ||
+        get_props()->get_fec_data_pdus() > 0) {
+        slide_window(pdus);
+        return;
+    }
+
+    const boost::system_time newest_tx_time = newest->tx_time;
+    for (auto& slot : window_) {
+        // skip PDUs that are already queued for retransmission
+        if (slot.done || slot.timer_id == 0 || not (slot.tx_time < newest_tx_time))
+            continue;
+        LOG_DEBUG("PDU " << slot.pdu.get_seq_no() << " is missing, retransmitting.");
+        ArqExecutor::get_instance().cancel(slot.timer_id);
+        slot.timer_id = 0;
+        retransmit(slot, pdus, true);
+    }
+    slide_window(pdus);
+}
+
+
+/**
+ * Retransmit the PDUs the receiver reported missing right away. PDUs that are
+ * already queued for retransmission are skipped, so a NACK that crosses a
+ * retransmission doesn't cause another one.
+ * Must be called with mutex_ held.
+ */
+void SelectiveRepeatArqTx::handle_nack_pdu(Pdu& pdu, PduVector& pdus)
+{
+    LOG_DEBUG("handle_nack_pdu()");
+    // striped flows are reordered by the ports, the receiver can't tell a gap from a late PDU
+    if (get_props()->get_striping_mode() != NO_STRIPING) {
+        LOG_DEBUG("Ignoring NACK " << pdu.get_seq_no() << " of striped flow.");
+        return;
+    }
+
+    const SeqNo max_seq_no = get_props()->get_max_seqno();
+    const uint64_t bitmap = pdu.get_sack();
+    for (auto& slot : window_) {
+        if (slot.done || slot.timer_id == 0)
+            continue;
+        const SeqNo offset = (slot.pdu.get_seq_no() + max_seq_no - pdu.get_seq_no()) % max_seq_no;
+        const bool requested = (offset == 0) || (offset <= 64 && ((bitmap >> (offset - 1)) & 1));
+        if (not requested)
+            continue;
+
+        LOG_DEBUG("PDU " << slot.pdu.get_seq_no() << " requested by NACK, retransmitting.");
+        ArqExecutor::get_instance().cancel(slot.timer_id);
+        slot.timer_id = 0;
+        retransmit(slot, pdus, true);
+    }
+    slide_window(pdus);
+}
+
+
+void SelectiveRepeatArqTx::frame_transmitted()
+{
+    PduVector pdus;
+    {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        assert(not tx_pending_.empty());
+        SeqNo seq_no = tx_pending_.front();
+        tx_pending_.pop_front();
+
+        TxSlot* slot = find_slot(seq_no);
+        if (slot == NULL || slot->done)
+            return;
+
+        if (get_props()->get_transfer_mode() == UNRELIABLE) {
+            // finish transmission of this PDU in the unreliable case
+            slot->done = true;
+            slide_window(pdus);
+            fill_window(pdus);
+        } else {
+            // start retransmission timer
+            slot->tx_time = boost::get_system_time();
+            slot->timeout = get_ack_timeout();
+            slot->timer_id = ArqExecutor::get_instance().schedule(this, slot->timeout,
+                                    std::bind(&SelectiveRepeatArqTx::handle_timeout, this, std::placeholders::_1));
+        }
+    }
+    transmit_pdus(pdus, false);
+}
+
+ASSIGN_LOGPTR(SelectiveRepeatArqTx::logger_, SelectiveRepeatArqTx::get_name())
+
+}
@@ -32,7 +32,12 @@ StopWaitArqRx::StopWaitArqRx(FlowBase* flow, size_t buffer_size) :
     expected_seq_no_(0)
 {}
 
-void StopWaitArqRx::handle_pdu_from_below(Pdu& pdu)
+StopWaitArqRx::~StopWaitArqRx(void)
+{
+    ArqExecutor::get_instance().cancel_all(this);
+}
+
+void StopWaitArqRx::handle_pdu_from_below(Pdu&& pdu)
 {
     boost::unique_lock<boost::mutex> lock(mutex_);
     if (pdu.get_type() != DATA)
@@ -63,7 +68,7 @@ void StopWaitArqRx::handle_data_pdu(Pdu& pdu)
         LOG_INFO("Duplicate frame received.");
         valid_frame = false;
     } else
-    if (seq_no < expected_seq_no_ && seq_no > get_props().get_max_seqno() / 2) {
+    if (seq_no < expected_seq_no_ && seq_no > get_props()->get_max_seqno() / 2) {
         LOG_INFO("Old frame received (expected " << expected_seq_no_ << ").");
         valid_frame = false;
         ack_no = (expected_seq_no_ == 0) ? 0 : expected_seq_no_ - 1; // send ack for previous PDU
@@ -74,38 +79,22 @@ void StopWaitArqRx::handle_data_pdu(Pdu& pdu)
         stats_.lost_pdus += num_lost;
     }
 
-    // return ACK if flow is reliable
-    if (get_props().get_transfer_mode() == RELIABLE) {
-        Pdu ack = get_ack_for_data_frame(pdu, ack_no);
-        LOG_INFO("Transmitting ACK " << ack.get_seq_no());
-        flow_->queue_pdu_for_below(ack);
-        stats_.pdus_for_below++;
-    }
+    // return ACK if flow is reliable, it is sent once the whole frame has been handled
+    if (get_props()->get_transfer_mode() == RELIABLE)
+        ack_data_pdu(pdu, ack_no);
 
     // pass frame to upper layer
     if (valid_frame) {
         assert(seq_no != last_seq_no_);
-        flow_->queue_pdu_for_above(pdu);
-        expected_seq_no_ = (ack_no + 1) % get_props().get_max_seqno();
+        expected_seq_no_ = (ack_no + 1) % get_props()->get_max_seqno();
         stats_.sdus_for_above++;
         stats_.bytes_for_above += pdu.get_payload()->size();
+        flow_->queue_pdu_for_above(std::move(pdu));
     }
 
     last_seq_no_ = seq_no;
 }
 
-Pdu StopWaitArqRx::get_ack_for_data_frame(Pdu &data, const SeqNo seqno)
-{
-    Pdu ack;
-    ack.set_type(ACK);
-    ack.set_dest_addr(data.get_source_addr());
-    ack.set_source_addr(data.get_dest_addr());
-    ack.set_src_id(data.get_dest_id());
-    ack.set_dest_id(data.get_src_id());
-    ack.set_seq_no(seqno);
-    return ack;
-}
-
 ASSIGN_LOGPTR(StopWaitArqRx::logger_, StopWaitArqRx::get_name())
 
 }
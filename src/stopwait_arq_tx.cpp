@@ -28,104 +28,116 @@ namespace libgdtp {
 
 StopWaitArqTx::StopWaitArqTx(FlowBase* flow, size_t buffer_size) :
     ArqBase(flow, buffer_size),
-    tx_seq_no_(0)
+    num_tx_(0),
+    timer_id_(0)
 {
-    // start transmit thread
-    arq_thread_ = boost::thread(&StopWaitArqTx::arq_thread_function, this);
 }
 
 
 StopWaitArqTx::~StopWaitArqTx(void)
 {
-    tx_cond_.notify_one();
-    timer_cond_.notify_one();
-    arq_thread_.interrupt();
-    arq_thread_.join();
+    ArqExecutor::get_instance().cancel_all(this);
 }
 
 
-void StopWaitArqTx::arq_thread_function(void)
+void StopWaitArqTx::service_buffer(void)
 {
-    try {
-        while (true) {
-            boost::this_thread::interruption_point();
-            Pdu tmp;
-            buffer_.popFront(tmp);
-            transmit_pdu(tmp);
-        }
-    }
-    catch(boost::thread_interrupted)
+    PduVector pdus;
     {
-        LOG_INFO("ARQ thread " << boost::this_thread::get_id() << " was interrupted.");
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        start_next_pdu(pdus);
     }
+    transmit_pdus(pdus);
 }
 
 
-void StopWaitArqTx::transmit_pdu(Pdu& pdu)
+/**
+ * Take the next PDU from the buffer if no other PDU is being served.
+ * Must be called with mutex_ held.
+ */
+void StopWaitArqTx::start_next_pdu(PduVector& pdus)
 {
-    boost::unique_lock<boost::mutex> lock(mutex_);
-    tx_seq_no_ = pdu.get_seq_no();
-    LOG_DEBUG("Selecting PDU " << tx_seq_no_ << " for " << pdu.get_dest_addr() << " for transmission.");
-
-    int num_tx = 0;
-    state_ = IDLE;
-    while (state_ != FINISHED) {
-        // enqueue frame
-        flow_->queue_pdu_for_below(pdu);
-        state_ = WAITING_FOR_TX;
-        stats_.pdus_for_below++;
-        num_tx++;
-
-        // waiting for actual transmission
-        LOG_DEBUG("Waiting for " << num_tx << ". transmission.");
-        while (state_ != TX_OVER) {
-            tx_cond_.wait(lock);
-        }
-        state_ = WAITING_FOR_ACK;
+    if (state_ != IDLE)
+        return;
 
-        // finish transmission of this PDU in the unreliable case
-        if (get_props().get_transfer_mode() == UNRELIABLE)
+    do {
+        if (not buffer_.tryPop(tx_pdu_))
             return;
+    } while (drop_if_late(tx_pdu_));
+    assign_seq_no(tx_pdu_);
+
+    LOG_DEBUG("Selecting PDU " << tx_pdu_.get_seq_no() << " for " << tx_pdu_.get_dest_addr() << " for transmission.");
+    num_tx_ = 1;
+    state_ = WAITING_FOR_TX;
+    stats_.pdus_for_below++;
+    pdus.push_back(tx_pdu_);
+}
 
-        // waiting for ACK
-        LOG_DEBUG("Waiting for ACK ..");
-        boost::system_time const timeout = boost::get_system_time() +
-                            boost::posix_time::milliseconds(get_props().get_ack_timeout());
-        while (state_ == WAITING_FOR_ACK) {
-            if (timer_cond_.timed_wait(lock, timeout) == false) {
-                state_ = TIMEOUT;
-            }
-        }
 
-        switch (state_) {
-        case TIMEOUT:
-            LOG_DEBUG("ACK timeout.");
-            if (num_tx >= get_props().get_max_retransmission()) {
-                LOG_INFO("Frame lost, maximum number of retransnmissions reached.");
-                state_ = FINISHED;
-                stats_.lost_pdus++;
-            } else {
-                stats_.rtx_pdus++;
-            }
-            break;
-        case FINISHED:
-            LOG_DEBUG("Got ACK!");
-            break;
-        default:
-            throw GdtpException("Invalid state");
+/**
+ * Enqueue PDUs for the lower layer. The mutex_ must NOT be held, because
+ * the scheduler may call back into frame_transmitted(). The executor and
+ * scheduler threads are shared by all flows and don't wait for space.
+ */
+void StopWaitArqTx::transmit_pdus(PduVector& pdus, const bool wait)
+{
+    for (auto& pdu : pdus) {
+        if (wait)
+            flow_->queue_pdu_for_below(std::move(pdu));
+        else
+            flow_->queue_pdu_for_below_nowait(std::move(pdu));
+    }
+}
+
+
+void StopWaitArqTx::handle_timeout(const ArqExecutor::TimerId id)
+{
+    PduVector pdus;
+    {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        if (id != timer_id_)
+            return; // ACK arrived in the meantime
+
+        timer_id_ = 0;
+        assert(state_ == WAITING_FOR_ACK);
+        LOG_DEBUG("ACK timeout.");
+        if (num_tx_ >= get_props()->get_max_retransmission()) {
+            LOG_INFO("Frame lost, maximum number of retransnmissions reached.");
+            stats_.lost_pdus++;
+            state_ = IDLE;
+            start_next_pdu(pdus);
+        } else
+        if (drop_if_late(tx_pdu_)) {
+            state_ = IDLE;
+            start_next_pdu(pdus);
+        } else {
+            LOG_DEBUG("Waiting for " << num_tx_ + 1 << ". transmission.");
+            backoff_ack_timeout();
+            num_tx_++;
+            state_ = WAITING_FOR_TX;
+            stats_.pdus_for_below++;
+            stats_.rtx_pdus++;
+            stats_.timeout_rtx_pdus++;
+            pdus.push_back(tx_pdu_);
         }
     }
+    transmit_pdus(pdus, false);
 }
 
 
-void StopWaitArqTx::handle_pdu_from_below(Pdu& pdu)
+void StopWaitArqTx::handle_pdu_from_below(Pdu&& pdu)
 {
-    boost::unique_lock<boost::mutex> lock(mutex_);
-    if (pdu.get_type() != ACK)
-        throw GdtpException("Invalid frame received on this flow.");
+    PduVector pdus;
+    {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        if (pdu.get_type() != ACK)
+            throw GdtpException("Invalid frame received on this flow.");
 
-    handle_ack_pdu(pdu);
-    stats_.pdus_from_below++;
+        handle_ack_pdu(pdu);
+        stats_.pdus_from_below++;
+        start_next_pdu(pdus);
+    }
+    transmit_pdus(pdus);
 }
 
 
@@ -134,14 +146,18 @@ void StopWaitArqTx::handle_ack_pdu(Pdu& pdu)
     LOG_DEBUG("handle_ack_pdu()");
     if (state_ == WAITING_FOR_ACK) {
         uint32_t seq_no = pdu.get_seq_no();
+        uint32_t tx_seq_no = tx_pdu_.get_seq_no();
         LOG_DEBUG("pdu seq no: " << seq_no);
-        LOG_DEBUG("tx seq no: " << tx_seq_no_);
+        LOG_DEBUG("tx seq no: " << tx_seq_no);
 
-        if (seq_no == tx_seq_no_) {
+        if (seq_no == tx_seq_no) {
             LOG_DEBUG("Received correct ack.");
-            state_ = FINISHED;
-            timer_cond_.notify_one();
-        } else if (seq_no < tx_seq_no_) {
+            if (num_tx_ == 1)
+                add_rtt_sample(tx_time_);
+            ArqExecutor::get_instance().cancel(timer_id_);
+            timer_id_ = 0;
+            state_ = IDLE;
+        } else if (seq_no < tx_seq_no) {
             LOG_DEBUG("Received old ack.");
         } else {
             LOG_ERROR("Received future ACK.");
@@ -154,10 +170,23 @@ void StopWaitArqTx::handle_ack_pdu(Pdu& pdu)
 
 void StopWaitArqTx::frame_transmitted()
 {
-    boost::unique_lock<boost::mutex> lock(mutex_);
-    assert(state_ == WAITING_FOR_TX);
-    state_ = TX_OVER;
-    tx_cond_.notify_one();
+    PduVector pdus;
+    {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        assert(state_ == WAITING_FOR_TX);
+        if (get_props()->get_transfer_mode() == UNRELIABLE) {
+            // finish transmission of this PDU in the unreliable case
+            state_ = IDLE;
+            start_next_pdu(pdus);
+        } else {
+            LOG_DEBUG("Waiting for ACK ..");
+            state_ = WAITING_FOR_ACK;
+            tx_time_ = boost::get_system_time();
+            timer_id_ = ArqExecutor::get_instance().schedule(this, get_ack_timeout(),
+                                    std::bind(&StopWaitArqTx::handle_timeout, this, std::placeholders::_1));
+        }
+    }
+    transmit_pdus(pdus, false);
 }
 
 ASSIGN_LOGPTR(StopWaitArqTx::logger_, StopWaitArqTx::get_name())
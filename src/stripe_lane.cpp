@@ -0,0 +1,49 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "stripe_lane.h"
+#include "exceptions.h"
+
+namespace libgdtp
+{
+
+void StripeLane::handle_frame_from_below(Pdu&&)
+{
+    throw GdtpException("Frames from below are handled by the striped flow itself.");
+}
+
+
+void StripeLane::print_status(void)
+{
+    LOG_INFO("  Stripe port:            " << get_below_port_name() << " (weight " << weight_ << ")");
+}
+
+
+void StripeLane::frame_transmitted(void)
+{
+    // the ARQ of the owner doesn't care which port carried the PDU
+    owner_->frame_transmitted();
+}
+
+ASSIGN_LOGPTR(StripeLane::logger_, StripeLane::get_name())
+
+} // namespace libgdtp
@@ -0,0 +1,95 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "token_bucket.h"
+
+namespace libgdtp
+{
+
+TokenBucket::TokenBucket(const uint32_t rate, const uint32_t burst) :
+    rate_(rate),
+    burst_(burst),
+    tokens_(burst),
+    last_refill_(boost::get_system_time())
+{
+}
+
+
+void TokenBucket::configure(const uint32_t rate, const uint32_t burst)
+{
+    boost::mutex::scoped_lock lock(mutex_);
+    refill();
+    // a bucket that has been unlimited so far starts full
+    tokens_ = (rate_ == 0) ? burst : std::min<double>(tokens_, burst);
+    rate_ = rate;
+    burst_ = burst;
+}
+
+
+uint32_t TokenBucket::get_wait_time(const size_t size)
+{
+    boost::mutex::scoped_lock lock(mutex_);
+    if (rate_ == 0)
+        return 0;
+
+    refill();
+    const double needed = std::min<double>(size, burst_);
+    if (tokens_ >= needed)
+        return 0;
+    return std::max<uint32_t>(1, static_cast<uint32_t>(std::ceil((needed - tokens_) * 1000 / rate_)));
+}
+
+
+void TokenBucket::consume(const size_t size)
+{
+    boost::mutex::scoped_lock lock(mutex_);
+    if (rate_ == 0)
+        return;
+
+    refill();
+    tokens_ -= size;
+}
+
+
+double TokenBucket::get_tokens(void)
+{
+    boost::mutex::scoped_lock lock(mutex_);
+    if (rate_ != 0)
+        refill();
+    return tokens_;
+}
+
+
+/**
+ * Must be called with mutex_ held.
+ */
+void TokenBucket::refill(void)
+{
+    const boost::system_time now = boost::get_system_time();
+    const double elapsed = (now - last_refill_).total_microseconds() / 1e6;
+    tokens_ = std::min<double>(tokens_ + elapsed * rate_, burst_);
+    last_refill_ = now;
+}
+
+} // namespace libgdtp
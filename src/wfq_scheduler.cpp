@@ -0,0 +1,127 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "wfq_scheduler.h"
+
+namespace libgdtp
+{
+
+void WfqScheduler::add_flow(FlowBase* flow)
+{
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    // only add flows to queue if they are not serviced yet
+    if (serviced_flows_.find(flow) == serviced_flows_.end()) {
+        serviced_flows_.insert(flow);
+        // a flow that has been idle must not benefit from it
+        FlowTag& tag = tags_[flow];
+        tag_next_frame(flow, tag, std::max(virtual_time_, tag.finish));
+    }
+    not_empty_cond_.notify_one();
+}
+
+
+/**
+ * Apply a changed weight to the frame the flow is currently waiting with.
+ */
+void WfqScheduler::flow_modified(FlowBase* flow)
+{
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    std::unordered_map<FlowBase*, FlowTag>::iterator it = tags_.find(flow);
+    if (it != tags_.end() && it->second.queued) {
+        queue_.erase(it->second.pos);
+        tag_next_frame(flow, it->second, it->second.start);
+    }
+}
+
+
+/**
+ * Compute the finish time of the flow's next frame and queue the flow.
+ * Must be called with mutex_ held.
+ */
+void WfqScheduler::tag_next_frame(FlowBase* flow, FlowTag& tag, const double start)
+{
+    if (not flow->get_next_frame_size(tag.size)) {
+        tag.queued = false;
+        return;
+    }
+    tag.start = start;
+    tag.finish = start + tag.size / static_cast<double>(flow->get_weight());
+    tag.pos = queue_.insert(std::make_pair(tag.finish, flow));
+    tag.queued = true;
+}
+
+
+FlowBase* WfqScheduler::get_next_flow()
+{
+    boost::mutex::scoped_lock lock(mutex_);
+    while (queue_.empty()) {
+        not_empty_cond_.wait(lock);
+    }
+    flow_ = queue_.begin()->second;
+    queue_.erase(queue_.begin());
+    FlowTag& tag = tags_[flow_];
+    tag.queued = false;
+    virtual_time_ = tag.finish;
+    return flow_;
+}
+
+
+/**
+ * Queue the flow again with its next frame, or let it go idle.
+ */
+void WfqScheduler::requeue_flow(FlowBase* flow)
+{
+    boost::mutex::scoped_lock lock(mutex_);
+    FlowTag& tag = tags_[flow];
+    // rate limited flows come back via add_flow() once they conform again
+    if (flow->conforms_to_rate()) {
+        tag_next_frame(flow, tag, tag.finish);
+    } else {
+        tag.queued = false;
+    }
+    if (not tag.queued) {
+        serviced_flows_.erase(flow);
+    }
+}
+
+
+void WfqScheduler::get_pdus_for_below(PduVector &pdus)
+{
+    this->get_next_flow();
+    assert(flow_ != NULL);
+
+    Pdu pdu;
+    flow_->get_frame_for_below(pdu);
+    pdus.push_back(std::move(pdu));
+    requeue_flow(flow_);
+}
+
+
+bool WfqScheduler::has_waiting_flow(void)
+{
+    boost::mutex::scoped_lock lock(mutex_);
+    return (not queue_.empty());
+}
+
+ASSIGN_LOGPTR(WfqScheduler::logger_, WfqScheduler::get_name())
+
+} // namespace libgdtp
@@ -0,0 +1,143 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#define BOOST_TEST_MODULE ArqExecutor_test
+
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include "timer_wheel.h"
+#include "arq_executor.h"
+#include "libgdtp.h"
+#include "test_helpers.h"
+
+using namespace std;
+using namespace libgdtp;
+
+using namespace boost;
+using namespace boost::unit_test;
+
+BOOST_AUTO_TEST_SUITE(ArqExecutor_test)
+
+BOOST_AUTO_TEST_CASE(TimerWheel_test)
+{
+    TimerWheel wheel;
+    std::vector<TimerWheel::TimerId> expired;
+
+    // timers on all levels of the wheel
+    wheel.add(1, 5);
+    wheel.add(2, 100);
+    wheel.add(3, 5000);
+    wheel.add(4, 300000);
+
+    wheel.advance(4, expired);
+    BOOST_CHECK(expired.empty());
+    BOOST_CHECK(wheel.next_expiry() <= 5);
+
+    wheel.advance(5, expired);
+    BOOST_REQUIRE(expired.size() == 1);
+    BOOST_CHECK(expired[0] == 1);
+
+    expired.clear();
+    wheel.advance(99, expired);
+    BOOST_CHECK(expired.empty());
+    wheel.advance(100, expired);
+    BOOST_REQUIRE(expired.size() == 1);
+    BOOST_CHECK(expired[0] == 2);
+
+    expired.clear();
+    wheel.advance(4999, expired);
+    BOOST_CHECK(expired.empty());
+    wheel.advance(5000, expired);
+    BOOST_REQUIRE(expired.size() == 1);
+    BOOST_CHECK(expired[0] == 3);
+
+    expired.clear();
+    wheel.advance(300000, expired);
+    BOOST_REQUIRE(expired.size() == 1);
+    BOOST_CHECK(expired[0] == 4);
+    BOOST_CHECK(wheel.is_empty());
+}
+
+BOOST_AUTO_TEST_CASE(Executor_test)
+{
+    ArqExecutor& executor = ArqExecutor::get_instance();
+    std::atomic<int> fired(0);
+    int owner;
+
+    ArqExecutor::TimerId id1 = executor.schedule(&owner, 10, [&](ArqExecutor::TimerId) { fired += 1; });
+    ArqExecutor::TimerId id2 = executor.schedule(&owner, 20, [&](ArqExecutor::TimerId) { fired += 10; });
+    executor.schedule(&owner, 30, [&](ArqExecutor::TimerId) { fired += 100; });
+    BOOST_CHECK(id1 != 0 && id2 != 0 && id1 != id2);
+
+    executor.cancel(id2);
+    boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+    BOOST_CHECK(fired == 101);
+
+    // pending timers must not fire after their owner cancelled them
+    executor.schedule(&owner, 10, [&](ArqExecutor::TimerId) { fired += 1000; });
+    executor.cancel_all(&owner);
+    boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+    BOOST_CHECK(fired == 101);
+}
+
+BOOST_AUTO_TEST_CASE(StalledPort_test)
+{
+    // nothing is taken from the receiver's port, so its delayed ACKs fill the buffer
+    Gdtp tx_prot, rx_prot;
+    setup_pair(tx_prot, rx_prot);
+
+    FlowProperties props(RELIABLE);
+    props.set_arq_type(SELECTIVE_REPEAT);
+    props.set_ack_timeout(20);
+    props.set_ack_delay(5);
+    FlowId id = tx_prot.allocate_flow(1000, props);
+    rx_prot.allocate_flow(1000, props);
+    for (int i = 0; i < 8; i++) {
+        tx_prot.handle_data_from_above(std::make_shared<Data>(10, i), id);
+    }
+
+    // the retransmissions stop once the executor thread blocks on the full buffer
+    const int NUM_FRAMES = 40;
+    const boost::system_time deadline = boost::get_system_time() + boost::posix_time::seconds(10);
+    int num_frames = 0;
+    while (num_frames < NUM_FRAMES && boost::get_system_time() < deadline) {
+        Data frame;
+        if (not tx_prot.try_get_data_for_below(DEFAULT_BELOW_PORT_ID, frame)) {
+            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+            continue;
+        }
+        tx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+        rx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, frame);
+        num_frames++;
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    }
+    BOOST_CHECK(num_frames == NUM_FRAMES);
+
+    // the ACKs that didn't fit are sent once the port drains
+    exchange_frames(rx_prot, tx_prot, {});
+    BOOST_CHECK(tx_prot.get_stats(id).arq.rtx_pdus > 0);
+    for (int i = 0; i < 8; i++) {
+        BOOST_REQUIRE(rx_prot.has_data_for_above(1000));
+        BOOST_CHECK(rx_prot.get_data_for_above(1000)->at(0) == i);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
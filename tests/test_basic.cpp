@@ -54,6 +54,19 @@ BOOST_AUTO_TEST_CASE(Init_test)
 }
 
 
+BOOST_AUTO_TEST_CASE(Codec_test)
+{
+    Gdtp prot;
+    BOOST_CHECK_NO_THROW(prot.set_codec_type("binary"));
+    BOOST_CHECK_NO_THROW(prot.set_codec_type("protobuf"));
+    BOOST_CHECK_THROW(prot.set_codec_type("foo"), GdtpException);
+    prot.initialize();
+
+    // frames may be in flight, hence the codec is fixed by initialize()
+    BOOST_CHECK_THROW(prot.set_codec_type("binary"), ParameterException);
+}
+
+
 BOOST_AUTO_TEST_CASE(Call_test)
 {
     Gdtp prot;
@@ -0,0 +1,155 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#define BOOST_TEST_MODULE Buffer_test
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+#include "buffer.h"
+#include "spsc_buffer.h"
+#include "pdu.h"
+
+using namespace std;
+
+using namespace boost;
+using namespace boost::unit_test;
+
+BOOST_AUTO_TEST_SUITE(Buffer_test)
+
+BOOST_AUTO_TEST_CASE(SpscBuffer_test)
+{
+    SpscBuffer<int> buffer(3);
+    int value;
+
+    BOOST_CHECK(buffer.isEmpty());
+    BOOST_CHECK(buffer.capacity() == 3);
+    BOOST_CHECK(buffer.tryPop(value) == false);
+
+    buffer.pushBack(1);
+    buffer.pushBack(2);
+    buffer.pushBack(3);
+    BOOST_CHECK(buffer.size() == 3);
+    BOOST_CHECK(buffer.isNotEmpty());
+
+    buffer.popFront(value);
+    BOOST_CHECK(value == 1);
+    buffer.pushBack(4);
+    for (int i = 2; i <= 4; i++) {
+        BOOST_REQUIRE(buffer.tryPop(value));
+        BOOST_CHECK(value == i);
+    }
+    BOOST_CHECK(buffer.isEmpty());
+}
+
+BOOST_AUTO_TEST_CASE(SpscBuffer_Threaded_test)
+{
+    const int NUM_ITEMS = 100000;
+    SpscBuffer<int> buffer(4);
+
+    // producer blocks on a full buffer, consumer on an empty one
+    boost::thread producer([&] {
+        for (int i = 0; i < NUM_ITEMS; i++) {
+            buffer.pushBack(i);
+        }
+    });
+
+    bool in_order = true;
+    for (int i = 0; i < NUM_ITEMS; i++) {
+        int value;
+        buffer.popFront(value);
+        if (value != i)
+            in_order = false;
+    }
+    producer.join();
+    BOOST_CHECK(in_order);
+    BOOST_CHECK(buffer.isEmpty());
+}
+
+BOOST_AUTO_TEST_CASE(Batch_test)
+{
+    Buffer<int> buffer(4);
+    std::vector<int> values;
+
+    // push more than fits, a consumer makes room in the meantime
+    std::vector<int> input;
+    for (int i = 0; i < 10; i++) {
+        input.push_back(i);
+    }
+    boost::thread producer([&] { buffer.pushBackBatch(input); });
+
+    while (values.size() < input.size()) {
+        size_t num = buffer.popFrontBatch(values, 3);
+        BOOST_CHECK(num >= 1 && num <= 3);
+    }
+    producer.join();
+    BOOST_CHECK(values == input);
+    BOOST_CHECK(buffer.isEmpty());
+}
+
+BOOST_AUTO_TEST_CASE(Move_test)
+{
+    // neither buffer may take an extra reference on the payload
+    std::shared_ptr<libgdtp::Data> payload = std::make_shared<libgdtp::Data>(10, 0xaa);
+    Buffer<libgdtp::Pdu> buffer(2);
+    SpscBuffer<libgdtp::Pdu> spsc_buffer(2);
+    libgdtp::Pdu pdu(payload);
+    BOOST_CHECK(payload.use_count() == 2);
+
+    buffer.pushBack(std::move(pdu));
+    BOOST_CHECK(payload.use_count() == 2);
+    buffer.popFront(pdu);
+    BOOST_CHECK(payload.use_count() == 2);
+
+    spsc_buffer.pushBack(std::move(pdu));
+    BOOST_CHECK(payload.use_count() == 2);
+    spsc_buffer.popFront(pdu);
+    BOOST_CHECK(payload.use_count() == 2);
+
+    std::vector<libgdtp::Pdu> pdus;
+    pdus.push_back(std::move(pdu));
+    buffer.pushBackBatch(std::move(pdus));
+    pdus.clear();
+    BOOST_CHECK(buffer.popFrontBatch(pdus, 1) == 1);
+    BOOST_CHECK(payload.use_count() == 2);
+
+    BOOST_CHECK(pdus[0].release_payload() == payload);
+    BOOST_CHECK(payload.use_count() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(TryPush_test)
+{
+    Buffer<libgdtp::Pdu> buffer(1);
+    std::shared_ptr<libgdtp::Data> payload = std::make_shared<libgdtp::Data>(10, 0xaa);
+    libgdtp::Pdu first(payload), second(payload);
+    BOOST_CHECK(buffer.tryPushBack(first));
+    BOOST_CHECK(first.get_payload() == NULL);
+
+    // a full buffer leaves the PDU with the caller
+    BOOST_CHECK(not buffer.tryPushBack(second));
+    BOOST_CHECK(second.get_payload() == payload);
+    BOOST_CHECK(buffer.size() == 1);
+
+    buffer.popFront(first);
+    BOOST_CHECK(buffer.tryPushBack(second));
+    BOOST_CHECK(buffer.size() == 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
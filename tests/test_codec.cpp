@@ -23,8 +23,13 @@
 #define BOOST_TEST_MODULE Codec_test
 
 #include <boost/test/unit_test.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
 #include "libgdtp.h"
 #include "protobuf_codec.h"
+#include "binary_codec.h"
+#include "codec_factory.h"
 #include "exceptions.h"
 
 using namespace std;
@@ -33,6 +38,56 @@ using namespace libgdtp;
 using namespace boost;
 using namespace boost::unit_test;
 
+// every codec has to pass the conformance tests below
+static const std::vector<std::string> codec_types = {"protobuf", "binary"};
+
+static uint64_t random_value(boost::mt19937& rng, const uint64_t max)
+{
+    boost::random::uniform_int_distribution<uint64_t> dist(0, max);
+    return dist(rng);
+}
+
+static Pdu make_random_pdu(boost::mt19937& rng)
+{
+    const Type types[] = {DATA, ACK, BROADCAST, NACK, REPAIR, SKIP};
+    Type type = types[random_value(rng, 5)];
+
+    // ACKs, NACKs and SKIPs usually don't carry a payload
+    size_t payload_size = (type == ACK || type == NACK || type == SKIP) ? 0 : random_value(rng, 200);
+    std::shared_ptr<Data> payload = make_shared<Data>(payload_size);
+    for (auto& byte : *payload) {
+        byte = random_value(rng, 255);
+    }
+
+    Pdu pdu(payload);
+    pdu.set_type(type);
+    pdu.set_source_addr(random_value(rng, UINT64_MAX));
+    pdu.set_dest_addr(random_value(rng, UINT64_MAX));
+    pdu.set_src_id(random_value(rng, UINT32_MAX));
+    pdu.set_dest_id(random_value(rng, UINT32_MAX));
+    pdu.set_seq_no(random_value(rng, UINT64_MAX));
+    if (type == ACK || type == NACK)
+        pdu.set_sack(random_value(rng, UINT64_MAX));
+    // DATA may carry an ACK for the reverse direction
+    if (type == DATA && random_value(rng, 1))
+        pdu.set_piggyback_ack(random_value(rng, UINT64_MAX), random_value(rng, UINT64_MAX));
+    return pdu;
+}
+
+static bool pdus_equal(Pdu& a, Pdu& b)
+{
+    return a.get_type() == b.get_type() &&
+           a.get_source_addr() == b.get_source_addr() &&
+           a.get_dest_addr() == b.get_dest_addr() &&
+           a.get_src_id() == b.get_src_id() &&
+           a.get_dest_id() == b.get_dest_id() &&
+           a.get_seq_no() == b.get_seq_no() &&
+           a.get_sack() == b.get_sack() &&
+           a.has_piggyback_ack() == b.has_piggyback_ack() &&
+           a.get_ack_seq_no() == b.get_ack_seq_no() &&
+           *a.get_payload() == *b.get_payload();
+}
+
 BOOST_AUTO_TEST_SUITE(Codec_test)
 
 BOOST_AUTO_TEST_CASE(ProtobufCodec_test)
@@ -53,11 +108,11 @@ BOOST_AUTO_TEST_CASE(ProtobufCodec_test)
 
     // create an empty lower layer SDU and encode PDU
     std::shared_ptr<Data> frame = make_shared<Data>();
-    ProtobufCodec::encode(pdus, *frame.get());
+    ProtobufCodec().encode(pdus, *frame.get());
 
     // create an empty PDU and decode lower layer SDU into it
     pdus.clear();
-    ProtobufCodec::decode(*frame.get(), pdus);
+    ProtobufCodec().decode(*frame.get(), pdus);
     BOOST_CHECK(pdus.size() == 1);
 
     // verify incoming PDU equals outgoing PDU
@@ -84,7 +139,7 @@ BOOST_AUTO_TEST_CASE(ProtobufEncoderSmallNetwork_test)
 
     // create an empty lower layer SDU and encode PDU
     std::shared_ptr<Data> frame = make_shared<Data>();
-    ProtobufCodec::encode(pdus, *frame.get());
+    ProtobufCodec().encode(pdus, *frame.get());
 
     BOOST_CHECK(frame->size() == 26);
 }
@@ -108,9 +163,235 @@ BOOST_AUTO_TEST_CASE(ProtobufEncoderBigNetwork_test)
 
     // create an empty lower layer frame and encode PDU
     std::shared_ptr<Data> frame = make_shared<Data>();
-    ProtobufCodec::encode(pdus, *frame.get());
+    ProtobufCodec().encode(pdus, *frame.get());
 
     BOOST_CHECK(frame->size() == 46);
 }
 
+
+BOOST_AUTO_TEST_CASE(BinaryCodec_test)
+{
+    // create two dummy PDUs, one without payload
+    std::shared_ptr<Data> payload = make_shared<Data>(10, 0xff);
+    Pdu data_pdu(payload);
+    data_pdu.set_source_addr(4294967294);
+    data_pdu.set_dest_addr(2);
+    data_pdu.set_type(DATA);
+    data_pdu.set_src_id(4294967293);
+    data_pdu.set_dest_id(99);
+    data_pdu.set_seq_no(4294967292);
+    data_pdu.set_piggyback_ack(3, 0x9);
+
+    Pdu ack_pdu;
+    ack_pdu.set_source_addr(2);
+    ack_pdu.set_dest_addr(1);
+    ack_pdu.set_type(ACK);
+    ack_pdu.set_src_id(99);
+    ack_pdu.set_dest_id(1);
+    ack_pdu.set_seq_no(7);
+    ack_pdu.set_sack(0x5);
+
+    PduVector pdus;
+    pdus.push_back(data_pdu);
+    pdus.push_back(ack_pdu);
+
+    std::shared_ptr<Data> frame = make_shared<Data>();
+    BinaryCodec().encode(pdus, *frame.get());
+    BOOST_CHECK(frame->size() == BinaryCodec::FRAME_TRAILER_SIZE + 2 * BinaryCodec::PDU_HEADER_SIZE + 10);
+
+    pdus.clear();
+    BinaryCodec().decode(*frame.get(), pdus);
+    BOOST_REQUIRE(pdus.size() == 2);
+
+    // verify incoming PDUs equal outgoing PDUs
+    BOOST_CHECK(pdus[0].get_source_addr() == data_pdu.get_source_addr());
+    BOOST_CHECK(pdus[0].get_dest_addr() == data_pdu.get_dest_addr());
+    BOOST_CHECK(pdus[0].get_src_id() == data_pdu.get_src_id());
+    BOOST_CHECK(pdus[0].get_dest_id() == data_pdu.get_dest_id());
+    BOOST_CHECK(pdus[0].get_seq_no() == data_pdu.get_seq_no());
+    BOOST_CHECK(pdus[0].get_type() == DATA);
+    BOOST_CHECK(pdus[0].has_piggyback_ack());
+    BOOST_CHECK(pdus[0].get_ack_seq_no() == 3);
+    BOOST_CHECK(pdus[0].get_sack() == 0x9);
+    BOOST_CHECK(*pdus[0].get_payload() == *payload);
+    BOOST_CHECK(pdus[1].get_type() == ACK);
+    BOOST_CHECK(not pdus[1].has_piggyback_ack());
+    BOOST_CHECK(pdus[1].get_seq_no() == 7);
+    BOOST_CHECK(pdus[1].get_sack() == 0x5);
+    BOOST_CHECK(pdus[1].get_payload()->empty());
+}
+
+
+BOOST_AUTO_TEST_CASE(BinaryCodecInvalid_test)
+{
+    std::shared_ptr<Data> payload = make_shared<Data>(10, 0xff);
+    Pdu outgoing_pdu(payload);
+    PduVector pdus;
+    pdus.push_back(outgoing_pdu);
+
+    Data frame;
+    BinaryCodec().encode(pdus, frame);
+
+    // truncated payload
+    Data truncated(frame.begin(), frame.end() - 1);
+    pdus.clear();
+    BOOST_CHECK_THROW(BinaryCodec().decode(truncated, pdus), DecodeException);
+
+    // unknown version
+    Data wrong_version(frame);
+    wrong_version.back() = BinaryCodec::VERSION + 1;
+    BOOST_CHECK_THROW(BinaryCodec().decode(wrong_version, pdus), DecodeException);
+
+    // empty frame
+    Data empty;
+    BOOST_CHECK_THROW(BinaryCodec().decode(empty, pdus), DecodeException);
+    BOOST_CHECK(pdus.empty());
+}
+
+
+BOOST_AUTO_TEST_CASE(BinaryCodecZeroCopy_test)
+{
+    // a jumbo SDU followed by a small one
+    std::shared_ptr<Data> payload1 = make_shared<Data>(9000, 0xaa);
+    std::shared_ptr<Data> payload2 = make_shared<Data>(10, 0xbb);
+    PduVector pdus;
+    pdus.push_back(Pdu(payload1));
+    pdus.push_back(Pdu(payload2));
+
+    BinaryCodec codec;
+    std::shared_ptr<Data> frame = make_shared<Data>();
+    codec.encode(pdus, *frame);
+    const uint8_t* frame_data = frame->data();
+
+    pdus.clear();
+    codec.decode(frame, pdus);
+    BOOST_REQUIRE(pdus.size() == 2);
+
+    // the first payload is the frame buffer itself
+    BOOST_CHECK(pdus[0].get_payload() == frame);
+    BOOST_CHECK(pdus[0].get_payload()->data() == frame_data);
+    BOOST_CHECK(*pdus[0].get_payload() == *payload1);
+    BOOST_CHECK(*pdus[1].get_payload() == *payload2);
+}
+
+
+BOOST_AUTO_TEST_CASE(CodecFactory_test)
+{
+    for (auto& type : codec_types) {
+        BOOST_CHECK(CodecFactory::make_codec(type) != nullptr);
+    }
+    BOOST_CHECK_THROW(CodecFactory::make_codec("foo"), GdtpException);
+}
+
+
+BOOST_AUTO_TEST_CASE(ConformanceRoundTrip_test)
+{
+    const int NUM_FRAMES = 500;
+    for (auto& type : codec_types) {
+        std::unique_ptr<CodecBase> codec = CodecFactory::make_codec(type);
+        boost::mt19937 rng(42);
+        for (int i = 0; i < NUM_FRAMES; i++) {
+            PduVector outgoing;
+            size_t num_pdus = 1 + random_value(rng, 7);
+            for (size_t j = 0; j < num_pdus; j++) {
+                outgoing.push_back(make_random_pdu(rng));
+            }
+
+            Data frame;
+            codec->encode(outgoing, frame);
+            PduVector incoming;
+            codec->decode(frame, incoming);
+
+            // decode once more, handing over ownership of the frame
+            PduVector incoming_owned;
+            codec->decode(make_shared<Data>(frame), incoming_owned);
+
+            BOOST_REQUIRE_MESSAGE(incoming.size() == outgoing.size(), "codec " << type);
+            BOOST_REQUIRE_MESSAGE(incoming_owned.size() == outgoing.size(), "codec " << type);
+            for (size_t j = 0; j < num_pdus; j++) {
+                BOOST_CHECK_MESSAGE(pdus_equal(incoming[j], outgoing[j]), "codec " << type << " frame " << i << " PDU " << j);
+                BOOST_CHECK_MESSAGE(pdus_equal(incoming_owned[j], outgoing[j]), "codec " << type << " frame " << i << " PDU " << j);
+            }
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(ConformanceFuzz_test)
+{
+    const int NUM_MUTATIONS = 2000;
+    for (auto& type : codec_types) {
+        std::unique_ptr<CodecBase> codec = CodecFactory::make_codec(type);
+        boost::mt19937 rng(23);
+        int num_rejected = 0;
+        for (int i = 0; i < NUM_MUTATIONS; i++) {
+            PduVector pdus;
+            pdus.push_back(make_random_pdu(rng));
+            pdus.push_back(make_random_pdu(rng));
+            Data frame;
+            codec->encode(pdus, frame);
+
+            // truncate, corrupt or extend the frame
+            switch (random_value(rng, 2)) {
+            case 0:
+                frame.resize(random_value(rng, frame.size() - 1));
+                break;
+            case 1:
+                for (int j = 0; j < 4; j++) {
+                    frame[random_value(rng, frame.size() - 1)] = random_value(rng, 255);
+                }
+                break;
+            case 2:
+                frame.insert(frame.end(), 1 + random_value(rng, 16), random_value(rng, 255));
+                break;
+            }
+
+            // a codec may accept a corrupted frame, but it must not fail in any other way
+            pdus.clear();
+            try {
+                codec->decode(frame, pdus);
+            } catch (const DecodeException&) {
+                num_rejected++;
+            }
+        }
+        BOOST_CHECK_MESSAGE(num_rejected > 0, "codec " << type << " accepted all corrupted frames");
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(ConformancePerformance_test)
+{
+    const int NUM_FRAMES = 20000;
+    std::shared_ptr<Data> payload = make_shared<Data>(100, 0xaa);
+    Pdu pdu(payload);
+    pdu.set_source_addr(1);
+    pdu.set_dest_addr(2);
+    pdu.set_src_id(3);
+    pdu.set_dest_id(4);
+
+    for (auto& type : codec_types) {
+        std::unique_ptr<CodecBase> codec = CodecFactory::make_codec(type);
+        PduVector pdus(1, pdu);
+        Data frame;
+
+        boost::posix_time::ptime start = boost::posix_time::microsec_clock::local_time();
+        for (int i = 0; i < NUM_FRAMES; i++) {
+            pdus[0].set_seq_no(i);
+            codec->encode(pdus, frame);
+        }
+        boost::posix_time::time_duration encode_time = boost::posix_time::microsec_clock::local_time() - start;
+
+        start = boost::posix_time::microsec_clock::local_time();
+        for (int i = 0; i < NUM_FRAMES; i++) {
+            pdus.clear();
+            codec->decode(frame, pdus);
+        }
+        boost::posix_time::time_duration decode_time = boost::posix_time::microsec_clock::local_time() - start;
+        BOOST_CHECK(pdus.size() == 1);
+
+        std::cout << "Codec " << type << ": encode " << encode_time.total_nanoseconds() / NUM_FRAMES
+                  << " ns/PDU, decode " << decode_time.total_nanoseconds() / NUM_FRAMES << " ns/PDU" << std::endl;
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,145 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#define BOOST_TEST_MODULE EventLoop_test
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include <sys/epoll.h>
+#include <poll.h>
+#include "libgdtp.h"
+
+using namespace std;
+using namespace libgdtp;
+
+using namespace boost;
+using namespace boost::unit_test;
+
+#define PAYLOAD_SIZE_SHORT 10
+
+BOOST_AUTO_TEST_SUITE(EventLoop_test)
+
+static bool is_readable(const int fd)
+{
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    return poll(&pfd, 1, 0) == 1;
+}
+
+
+BOOST_AUTO_TEST_CASE(Try_get_test)
+{
+    Gdtp prot;
+    prot.set_codec_type("binary");
+    prot.initialize();
+
+    FlowProperties props;
+    props.set_transfer_mode(UNRELIABLE);
+    FlowId id = prot.allocate_flow(1, props);
+
+    // nothing is pending, hence neither blocks
+    Data frame;
+    BOOST_CHECK(prot.try_get_data_for_below(DEFAULT_BELOW_PORT_ID, frame) == false);
+    const int fd = prot.get_event_fd(DEFAULT_BELOW_PORT_ID);
+    BOOST_CHECK(is_readable(fd) == false);
+
+    prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, 1), id);
+    prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, 2), id);
+    BOOST_CHECK(is_readable(fd) == true);
+
+    // the fd stays readable until all frames have been taken
+    std::vector<uint8_t> patterns;
+    while (is_readable(fd)) {
+        BOOST_REQUIRE(prot.try_get_data_for_below(DEFAULT_BELOW_PORT_ID, frame) == true);
+        patterns.push_back(frame[0]); // binary frames start with the payload
+        prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+    }
+    BOOST_REQUIRE(patterns.size() == 2);
+    BOOST_CHECK(patterns[0] == 1);
+    BOOST_CHECK(patterns[1] == 2);
+    BOOST_CHECK(prot.try_get_data_for_below(DEFAULT_BELOW_PORT_ID, frame) == false);
+}
+
+
+BOOST_AUTO_TEST_CASE(Epoll_test)
+{
+    Gdtp node1;
+    node1.set_default_source_address(1);
+    node1.set_default_destination_address(2);
+    node1.set_codec_type("binary");
+    node1.initialize();
+
+    Gdtp node2;
+    node2.set_default_source_address(2);
+    node2.set_default_destination_address(1);
+    node2.set_codec_type("binary");
+    node2.initialize();
+
+    FlowProperties props;
+    props.set_arq_type(SELECTIVE_REPEAT);
+    FlowId id = node1.allocate_flow(1, props);
+    node2.allocate_flow(1, props);
+
+    // both nodes are driven by a single epoll loop without any extra threads
+    Gdtp* nodes[2] = { &node1, &node2 };
+    const int epfd = epoll_create1(0);
+    BOOST_REQUIRE(epfd >= 0);
+    for (int i = 0; i < 2; i++) {
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.u32 = i;
+        BOOST_REQUIRE(epoll_ctl(epfd, EPOLL_CTL_ADD, nodes[i]->get_event_fd(DEFAULT_BELOW_PORT_ID), &ev) == 0);
+    }
+
+    // handing SDUs down would block once the ARQ buffer is full, so send a window at a time
+    const uint32_t num_sdus = 5 * props.get_window_size();
+    uint32_t num_sent = 0, num_received = 0;
+    while (num_received < num_sdus) {
+        if (num_sent == num_received) {
+            for (uint32_t i = 0; i < props.get_window_size(); i++) {
+                node1.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, num_sent++), id);
+            }
+        }
+
+        struct epoll_event events[2];
+        const int n = epoll_wait(epfd, events, 2, 1000);
+        BOOST_REQUIRE(n > 0);
+        for (int e = 0; e < n; e++) {
+            const int i = events[e].data.u32;
+            Data frame;
+            while (nodes[i]->try_get_data_for_below(DEFAULT_BELOW_PORT_ID, frame)) {
+                nodes[1 - i]->handle_data_from_below(DEFAULT_BELOW_PORT_ID, frame);
+                nodes[i]->set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+            }
+        }
+        while (node2.has_data_for_above(1)) {
+            BOOST_CHECK(node2.get_data_for_above(1)->at(0) == uint8_t(num_received));
+            num_received++;
+        }
+    }
+    close(epfd);
+
+    ArqStats stats = node1.get_stats(id).arq;
+    BOOST_CHECK(stats.sdus_from_above == num_sdus);
+    BOOST_CHECK(stats.rtx_pdus == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,344 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#define BOOST_TEST_MODULE Fec_test
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include "libgdtp.h"
+#include "exceptions.h"
+#include "gf256.h"
+#include "fec_encoder.h"
+#include "fec_decoder.h"
+#include "test_helpers.h"
+
+using namespace std;
+using namespace libgdtp;
+
+using namespace boost;
+using namespace boost::unit_test;
+
+#define DEFAULT_ID 1
+#define PAYLOAD_SIZE_SHORT 10
+#define NUM_PDUS 8
+
+BOOST_AUTO_TEST_SUITE(Fec_test)
+
+static uint32_t random_value(boost::mt19937& rng, const uint32_t max)
+{
+    boost::random::uniform_int_distribution<uint32_t> dist(0, max);
+    return dist(rng);
+}
+
+
+BOOST_AUTO_TEST_CASE(Field_test)
+{
+    for (int a = 1; a < 256; a++) {
+        BOOST_CHECK(Gf256::mul(a, Gf256::inv(a)) == 1);
+        BOOST_CHECK(Gf256::mul(a, 1) == a);
+        BOOST_CHECK(Gf256::mul(a, 0) == 0);
+    }
+    BOOST_CHECK(Gf256::mul(2, 128) == 0x1d); // reduced by the polynomial
+    BOOST_CHECK_THROW(Gf256::inv(0), ParameterException);
+}
+
+
+BOOST_AUTO_TEST_CASE(Region_test)
+{
+    // every vectorised implementation has to match the scalar one, including odd lengths
+    std::cout << "Best GF(256) implementation: " << Gf256::get_impl_as_string(Gf256::get_best_impl()) << std::endl;
+    boost::mt19937 rng(42);
+    const Gf256::Impl impls[] = {Gf256::SSSE3, Gf256::AVX2};
+    for (auto impl : impls) {
+        if (not Gf256::is_supported(impl))
+            continue;
+        for (int c = 0; c < 256; c++) {
+            const size_t len = random_value(rng, 100);
+            Data src(len), dst(len);
+            for (size_t i = 0; i < len; i++) {
+                src[i] = random_value(rng, 255);
+                dst[i] = random_value(rng, 255);
+            }
+            Data expected(dst);
+            Gf256::mul_add_region(expected.data(), src.data(), c, len, Gf256::SCALAR);
+            Gf256::mul_add_region(dst.data(), src.data(), c, len, impl);
+            BOOST_CHECK(dst == expected);
+        }
+    }
+}
+
+
+/**
+ * Encode blocks of k PDUs with random sizes, lose up to m of them and as
+ * many repairs as possible while the block stays recoverable.
+ */
+static void check_recovery(const size_t k, const size_t m, boost::mt19937& rng)
+{
+    FecEncoder encoder(k, m);
+    PduVector repairs;
+    PduVector pdus;
+    for (size_t i = 0; i < k; i++) {
+        std::shared_ptr<Data> payload = make_shared<Data>(1 + random_value(rng, 200));
+        for (auto& byte : *payload) {
+            byte = random_value(rng, 255);
+        }
+        Pdu pdu(payload);
+        pdu.set_seq_no(i + 100);
+        pdus.push_back(pdu);
+        encoder.add_pdu(pdu, repairs);
+    }
+    BOOST_REQUIRE(repairs.size() == m);
+    BOOST_CHECK(encoder.has_open_block() == false);
+
+    // lose num_lost data PDUs and keep exactly as many repairs
+    const size_t num_lost = 1 + random_value(rng, std::min(k, m) - 1);
+    std::vector<size_t> order(k);
+    for (size_t i = 0; i < k; i++) {
+        order[i] = i;
+    }
+    for (size_t i = k - 1; i > 0; i--) {
+        std::swap(order[i], order[random_value(rng, i)]);
+    }
+    std::vector<bool> lost(k, false);
+    for (size_t i = 0; i < num_lost; i++) {
+        lost[order[i]] = true;
+    }
+
+    FecDecoder decoder;
+    for (size_t i = 0; i < k; i++) {
+        if (not lost[i])
+            decoder.add_pdu(pdus[i]);
+    }
+    PduVector recovered;
+    size_t first_repair = random_value(rng, m - num_lost);
+    for (size_t j = first_repair; j < first_repair + num_lost; j++) {
+        BOOST_CHECK(recovered.empty());
+        decoder.handle_repair_pdu(repairs[j], recovered);
+    }
+
+    BOOST_REQUIRE(recovered.size() == num_lost);
+    for (auto& pdu : recovered) {
+        const size_t index = pdu.get_seq_no() - 100;
+        BOOST_REQUIRE(index < k);
+        BOOST_CHECK(lost[index]);
+        BOOST_CHECK(pdu.get_type() == DATA);
+        BOOST_CHECK(*pdu.get_payload() == *pdus[index].get_payload());
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(Recovery_test)
+{
+    boost::mt19937 rng(42);
+    for (int i = 0; i < 200; i++) {
+        const size_t k = 1 + random_value(rng, 15);
+        const size_t m = 1 + random_value(rng, 5);
+        check_recovery(k, m, rng);
+    }
+    // the largest block the field allows
+    check_recovery(200, 56, rng);
+}
+
+
+BOOST_AUTO_TEST_CASE(PartialBlock_test)
+{
+    FecEncoder encoder(8, 2);
+    PduVector repairs;
+    Pdu pdu1(make_shared<Data>(PAYLOAD_SIZE_SHORT, 1));
+    pdu1.set_seq_no(1);
+    Pdu pdu2(make_shared<Data>(PAYLOAD_SIZE_SHORT + 5, 2));
+    pdu2.set_seq_no(2);
+    encoder.add_pdu(pdu1, repairs);
+    encoder.add_pdu(pdu2, repairs);
+    BOOST_CHECK(repairs.empty());
+    BOOST_CHECK(encoder.get_num_pdus() == 2);
+    encoder.flush(repairs);
+    BOOST_REQUIRE(repairs.size() == 2);
+    BOOST_CHECK(repairs[0].get_type() == REPAIR);
+    BOOST_CHECK(encoder.get_block_id() == 1);
+
+    // a stale PDU with the same seqno doesn't count as received
+    FecDecoder decoder;
+    Pdu stale(make_shared<Data>(PAYLOAD_SIZE_SHORT, 7));
+    stale.set_seq_no(1);
+    decoder.add_pdu(stale);
+    decoder.add_pdu(pdu2);
+    PduVector recovered;
+    decoder.handle_repair_pdu(repairs[1], recovered);
+    BOOST_REQUIRE(recovered.size() == 1);
+    BOOST_CHECK(*recovered[0].get_payload() == *pdu1.get_payload());
+
+    // invalid repairs are ignored
+    Pdu invalid(make_shared<Data>(3, 0));
+    invalid.set_type(REPAIR);
+    recovered.clear();
+    decoder.handle_repair_pdu(invalid, recovered);
+    BOOST_CHECK(recovered.empty());
+}
+
+
+/**
+ * Send NUM_PDUS SDUs with the payloads 1, 2, 3, .. and hand all frames but
+ * the lost ones to the receiver.
+ * @return the number of frames sent
+ */
+static size_t transfer(Gdtp& tx_prot, Gdtp& rx_prot, const FlowId id, const std::set<size_t>& lost)
+{
+    for (int i = 0; i < NUM_PDUS; i++) {
+        tx_prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, i + 1), id);
+    }
+    return exchange_frames(tx_prot, rx_prot, lost);
+}
+
+
+BOOST_AUTO_TEST_CASE(Broadcast_test)
+{
+    Gdtp tx_prot, rx_prot;
+    setup_pair(tx_prot, rx_prot, "fifo", 127);
+
+    FlowProperties props(UNRELIABLE);
+    props.set_fec(4, 1);
+    FlowId id = tx_prot.allocate_flow(DEFAULT_ID, props);
+    rx_prot.allocate_flow(DEFAULT_ID, props);
+
+    // one data PDU of each block is lost, frames 4 and 9 are the repairs
+    std::set<size_t> lost = {1, 7};
+    BOOST_CHECK(transfer(tx_prot, rx_prot, id, lost) == NUM_PDUS + 2);
+
+    std::set<uint8_t> received;
+    while (rx_prot.has_data_for_above(DEFAULT_ID)) {
+        received.insert(rx_prot.get_data_for_above(DEFAULT_ID)->at(0));
+    }
+    BOOST_CHECK(received.size() == NUM_PDUS);
+    BOOST_CHECK(tx_prot.get_stats(id).arq.repair_pdus == 2);
+}
+
+
+BOOST_AUTO_TEST_CASE(Reliable_test)
+{
+    Gdtp tx_prot, rx_prot;
+    setup_pair(tx_prot, rx_prot);
+
+    FlowProperties props(RELIABLE);
+    props.set_arq_type(SELECTIVE_REPEAT);
+    props.set_ack_timeout(1000);
+    props.set_fec(4, 2);
+    FlowId id = tx_prot.allocate_flow(DEFAULT_ID, props);
+
+    // the receiver only learns about FEC from the first repair, so the losses
+    // happen in the second block (frames 6 to 9), before any ACK could reveal them
+    std::set<size_t> lost = {8, 9};
+    transfer(tx_prot, rx_prot, id, lost);
+
+    for (int i = 0; i < NUM_PDUS; i++) {
+        BOOST_REQUIRE(rx_prot.has_data_for_above(DEFAULT_ID));
+        BOOST_CHECK(rx_prot.get_data_for_above(DEFAULT_ID)->at(0) == i + 1);
+    }
+    // the ARQ never noticed the losses
+    ArqStats stats = tx_prot.get_stats(id).arq;
+    BOOST_CHECK(stats.rtx_pdus == 0);
+    BOOST_CHECK(stats.repair_pdus == 4);
+    BOOST_CHECK(tx_prot.has_data_for_below(DEFAULT_BELOW_PORT_ID) == false);
+}
+
+
+BOOST_AUTO_TEST_CASE(MaxDelay_test)
+{
+    Gdtp prot;
+    prot.set_default_source_address(1);
+    prot.set_default_destination_address(127);
+    prot.initialize();
+
+    FlowProperties props(UNRELIABLE);
+    props.set_fec(8, 1);
+    props.set_fec_max_delay(20);
+    FlowId id = prot.allocate_flow(DEFAULT_ID, props);
+    prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, 1), id);
+
+    Data frame;
+    BOOST_REQUIRE(prot.try_get_data_for_below(DEFAULT_BELOW_PORT_ID, frame));
+    prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+    BOOST_CHECK(prot.has_data_for_below(DEFAULT_BELOW_PORT_ID) == false);
+
+    // the partial block is closed after the maximum delay
+    boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+    BOOST_REQUIRE(prot.try_get_data_for_below(DEFAULT_BELOW_PORT_ID, frame));
+    prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+    BOOST_CHECK(prot.get_stats(id).arq.repair_pdus == 1);
+}
+
+
+BOOST_AUTO_TEST_CASE(FullBuffer_test)
+{
+    Gdtp prot;
+    prot.set_default_source_address(1);
+    prot.set_default_destination_address(127);
+    prot.initialize();
+
+    FlowProperties props(UNRELIABLE);
+    props.set_fec(8, 1);
+    props.set_fec_max_delay(20);
+    FlowId full = prot.allocate_flow(DEFAULT_ID, props);
+    FlowId other = prot.allocate_flow(DEFAULT_ID + 1, props);
+
+    // 29 SDUs and 3 repairs fill the buffer of 2 * window * (1 + repairs) PDUs
+    const size_t num_sdus = 29;
+    for (size_t i = 0; i < num_sdus; i++) {
+        prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, i), full);
+    }
+    prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, 1), other);
+
+    // the repair that doesn't fit doesn't keep the timers of other flows from firing
+    boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+    BOOST_CHECK(prot.get_stats(other).arq.repair_pdus == 1);
+    BOOST_CHECK(prot.get_stats(full).arq.repair_pdus == 4);
+
+    // it is queued once there is space again
+    size_t num_frames = 0;
+    Data frame;
+    while (prot.try_get_data_for_below(DEFAULT_BELOW_PORT_ID, frame)) {
+        prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+        num_frames++;
+    }
+    BOOST_CHECK(num_frames == num_sdus + 4 + 2);
+}
+
+
+BOOST_AUTO_TEST_CASE(InvalidParameters_test)
+{
+    Gdtp prot;
+    prot.initialize();
+
+    FlowProperties props;
+    props.set_fec(8, 0);
+    BOOST_CHECK_THROW(prot.allocate_flow(DEFAULT_ID, props), ParameterException);
+    props.set_fec(200, 57);
+    BOOST_CHECK_THROW(prot.allocate_flow(DEFAULT_ID, props), ParameterException);
+    props.set_fec(8, 2);
+    props.set_striping_mode(WEIGHTED_ROUND_ROBIN);
+    props.add_stripe_port(DEFAULT_BELOW_PORT_ID);
+    BOOST_CHECK_THROW(prot.allocate_flow(DEFAULT_ID, props), ParameterException);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
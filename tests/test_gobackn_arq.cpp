@@ -0,0 +1,240 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#define BOOST_TEST_MODULE GoBackNArq_test
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+#include "libgdtp.h"
+#include "test_helpers.h"
+
+using namespace std;
+using namespace libgdtp;
+
+using namespace boost;
+using namespace boost::unit_test;
+
+#define DEFAULT_ID 1000 // beyond the flow ids, so get_stats() finds the inbound flow of the port
+#define ACK_TIMEOUT 100
+#define WINDOW_SIZE 4
+
+BOOST_AUTO_TEST_SUITE(GoBackNArq_test)
+
+BOOST_AUTO_TEST_CASE(Window_test)
+{
+    FlowProperties props;
+    props.set_arq_type(GO_BACK_N);
+    props.set_window_size(WINDOW_SIZE);
+    props.set_ack_timeout(ACK_TIMEOUT);
+
+    Gdtp tx_prot;
+    tx_prot.set_default_source_address(1);
+    tx_prot.set_default_destination_address(2);
+    tx_prot.initialize();
+
+    Gdtp rx_prot;
+    rx_prot.set_default_source_address(2);
+    rx_prot.initialize();
+
+    // create flow on both sides to make sure the receiver uses the same ARQ
+    FlowId id = tx_prot.allocate_flow(DEFAULT_ID, props);
+    rx_prot.allocate_flow(DEFAULT_ID, props);
+
+    // a full window of SDUs should be sent without waiting for any ACK
+    for (int i = 0; i < WINDOW_SIZE + 1; i++) {
+        std::shared_ptr<Data> sdu = make_shared<Data>(10 + i, 0xff);
+        tx_prot.handle_data_from_above(sdu, id);
+    }
+    boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+
+    size_t counter = 0;
+    while (tx_prot.has_data_for_below(DEFAULT_BELOW_PORT_ID)) {
+        Data frame;
+        tx_prot.get_data_for_below(DEFAULT_BELOW_PORT_ID, frame);
+        rx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, frame);
+        tx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+        counter++;
+    }
+    BOOST_CHECK(counter == WINDOW_SIZE);
+
+    // feed all ACKs back, this opens the window for the last SDU
+    while (rx_prot.has_data_for_below(DEFAULT_BELOW_PORT_ID)) {
+        Data ack;
+        rx_prot.get_data_for_below(DEFAULT_BELOW_PORT_ID, ack);
+        tx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, ack);
+        rx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+    }
+    boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+    BOOST_CHECK(tx_prot.has_data_for_below(DEFAULT_BELOW_PORT_ID) == true);
+
+    FlowStats stats = rx_prot.get_stats(DEFAULT_ID);
+    BOOST_CHECK(stats.arq.sdus_for_above == WINDOW_SIZE);
+    BOOST_CHECK(stats.arq.pdus_for_below == WINDOW_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(GoBack_test)
+{
+    FlowProperties props;
+    props.set_arq_type(GO_BACK_N);
+    props.set_window_size(WINDOW_SIZE);
+    props.set_ack_timeout(ACK_TIMEOUT);
+
+    Gdtp tx_prot;
+    tx_prot.set_default_source_address(1);
+    tx_prot.set_default_destination_address(2);
+    tx_prot.initialize();
+
+    Gdtp rx_prot;
+    rx_prot.set_default_source_address(2);
+    rx_prot.initialize();
+
+    FlowId id = tx_prot.allocate_flow(DEFAULT_ID, props);
+    rx_prot.allocate_flow(DEFAULT_ID, props);
+
+    // send three SDUs of different size
+    for (int i = 0; i < 3; i++) {
+        std::shared_ptr<Data> sdu = make_shared<Data>(10 + i, 0xff);
+        tx_prot.handle_data_from_above(sdu, id);
+    }
+    boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+
+    // lose the first frame
+    for (int i = 0; i < 3; i++) {
+        Data frame;
+        tx_prot.get_data_for_below(DEFAULT_BELOW_PORT_ID, frame);
+        if (i != 0)
+            rx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, frame);
+        tx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+    }
+
+    // the other two are discarded by the receiver
+    BOOST_CHECK(rx_prot.has_data_for_above(DEFAULT_ID) == false);
+
+    // feed the (useless) cumulative ACKs back
+    while (rx_prot.has_data_for_below(DEFAULT_BELOW_PORT_ID)) {
+        Data ack;
+        rx_prot.get_data_for_below(DEFAULT_BELOW_PORT_ID, ack);
+        tx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, ack);
+        rx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+    }
+
+    // after the timeout, the whole window is sent again
+    boost::this_thread::sleep(boost::posix_time::milliseconds(2 * ACK_TIMEOUT));
+    size_t counter = 0;
+    while (tx_prot.has_data_for_below(DEFAULT_BELOW_PORT_ID)) {
+        Data frame;
+        tx_prot.get_data_for_below(DEFAULT_BELOW_PORT_ID, frame);
+        rx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, frame);
+        tx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+        counter++;
+    }
+    BOOST_CHECK(counter == 3);
+
+    // now all SDUs are passed up in order
+    for (size_t i = 0; i < 3; i++) {
+        BOOST_REQUIRE(rx_prot.has_data_for_above(DEFAULT_ID) == true);
+        std::shared_ptr<Data> sdu = rx_prot.get_data_for_above(DEFAULT_ID);
+        BOOST_CHECK(sdu->size() == 10 + i);
+    }
+
+    // the last ACK alone acknowledges everything
+    Data ack;
+    while (rx_prot.has_data_for_below(DEFAULT_BELOW_PORT_ID)) {
+        rx_prot.get_data_for_below(DEFAULT_BELOW_PORT_ID, ack);
+        rx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+    }
+    tx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, ack);
+    boost::this_thread::sleep(boost::posix_time::milliseconds(2 * ACK_TIMEOUT));
+    BOOST_CHECK(tx_prot.has_data_for_below(DEFAULT_BELOW_PORT_ID) == false);
+
+    FlowStats stats = tx_prot.get_stats(id);
+    BOOST_CHECK(stats.arq.rtx_pdus == 3);
+}
+
+BOOST_AUTO_TEST_CASE(LateSkip_test)
+{
+    FlowProperties props;
+    props.set_arq_type(GO_BACK_N);
+    props.set_window_size(WINDOW_SIZE);
+    props.set_ack_timeout(ACK_TIMEOUT);
+
+    Gdtp tx_prot, rx_prot;
+    setup_pair(tx_prot, rx_prot);
+    FlowId id = tx_prot.allocate_flow(DEFAULT_ID, props);
+    rx_prot.allocate_flow(DEFAULT_ID, props);
+
+    // lose the first SDU, the receiver discards the second one
+    tx_prot.handle_data_from_above(make_shared<Data>(10, 1), id, ACK_TIMEOUT / 2);
+    tx_prot.handle_data_from_above(make_shared<Data>(10, 2), id);
+    BOOST_CHECK(exchange_frames(tx_prot, rx_prot, {0}) == 2);
+    BOOST_CHECK(rx_prot.has_data_for_above(DEFAULT_ID) == false);
+
+    // the first SDU expires before the timeout, the SKIP is followed by the second one
+    boost::this_thread::sleep(boost::posix_time::milliseconds(3 * ACK_TIMEOUT / 2));
+    BOOST_CHECK(exchange_frames(tx_prot, rx_prot, {}) == 2);
+    BOOST_REQUIRE(rx_prot.has_data_for_above(DEFAULT_ID) == true);
+    BOOST_CHECK(rx_prot.get_data_for_above(DEFAULT_ID)->at(0) == 2);
+    BOOST_CHECK(tx_prot.get_stats(id).arq.dropped_late == 1);
+    BOOST_CHECK(rx_prot.get_stats(DEFAULT_ID).arq.lost_pdus == 1);
+
+    boost::this_thread::sleep(boost::posix_time::milliseconds(2 * ACK_TIMEOUT));
+    BOOST_CHECK(tx_prot.has_data_for_below(DEFAULT_BELOW_PORT_ID) == false);
+}
+
+BOOST_AUTO_TEST_CASE(MaxRetransmission_test)
+{
+    FlowProperties props;
+    props.set_arq_type(GO_BACK_N);
+    props.set_window_size(WINDOW_SIZE);
+    props.set_ack_timeout(ACK_TIMEOUT);
+    props.set_max_retransmissions(2);
+
+    Gdtp tx_prot, rx_prot;
+    setup_pair(tx_prot, rx_prot);
+    FlowId id = tx_prot.allocate_flow(DEFAULT_ID, props);
+    rx_prot.allocate_flow(DEFAULT_ID, props);
+
+    // the first SDU never gets through, the receiver discards the second one each time
+    tx_prot.handle_data_from_above(make_shared<Data>(10, 1), id);
+    tx_prot.handle_data_from_above(make_shared<Data>(10, 2), id);
+    BOOST_CHECK(exchange_frames(tx_prot, rx_prot, {0}) == 2);
+    boost::this_thread::sleep(boost::posix_time::milliseconds(3 * ACK_TIMEOUT / 2));
+    BOOST_CHECK(exchange_frames(tx_prot, rx_prot, {0}) == 2);
+    BOOST_CHECK(rx_prot.has_data_for_above(DEFAULT_ID) == false);
+
+    // after the second timeout, the sender gives up and sends the SKIP ahead of the second SDU
+    boost::this_thread::sleep(boost::posix_time::milliseconds(3 * ACK_TIMEOUT / 2));
+    BOOST_CHECK(exchange_frames(tx_prot, rx_prot, {}) == 2);
+    BOOST_REQUIRE(rx_prot.has_data_for_above(DEFAULT_ID) == true);
+    BOOST_CHECK(rx_prot.get_data_for_above(DEFAULT_ID)->at(0) == 2);
+
+    // later SDUs pass right away
+    tx_prot.handle_data_from_above(make_shared<Data>(10, 3), id);
+    BOOST_CHECK(exchange_frames(tx_prot, rx_prot, {}) == 1);
+    BOOST_REQUIRE(rx_prot.has_data_for_above(DEFAULT_ID) == true);
+    BOOST_CHECK(rx_prot.get_data_for_above(DEFAULT_ID)->at(0) == 3);
+
+    BOOST_CHECK(tx_prot.get_stats(id).arq.lost_pdus == 1);
+    BOOST_CHECK(rx_prot.get_stats(DEFAULT_ID).arq.lost_pdus == 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,104 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef TEST_HELPERS_H
+#define TEST_HELPERS_H
+
+#include <set>
+#include <boost/thread.hpp>
+#include "libgdtp.h"
+
+/**
+ * Initialize two protocol instances with the addresses 1 and 2 that send to
+ * each other using the binary codec, optionally with another scheduler or
+ * another destination of tx_prot.
+ */
+inline void setup_pair(libgdtp::Gdtp& tx_prot, libgdtp::Gdtp& rx_prot, const std::string scheduler = "",
+                       const libgdtp::Addr destination = 2)
+{
+    tx_prot.set_default_source_address(1);
+    tx_prot.set_default_destination_address(destination);
+    if (not scheduler.empty())
+        tx_prot.set_scheduler_type(scheduler);
+    tx_prot.set_codec_type("binary");
+    tx_prot.initialize();
+
+    rx_prot.set_default_source_address(2);
+    rx_prot.set_default_destination_address(1);
+    if (not scheduler.empty())
+        rx_prot.set_scheduler_type(scheduler);
+    rx_prot.set_codec_type("binary");
+    rx_prot.initialize();
+}
+
+
+/**
+ * Wait for the next frame of the sender and hand it to the receiver after
+ * the given delay in ms.
+ */
+inline void forward_frame(libgdtp::Gdtp& from, libgdtp::Gdtp& to, const uint32_t delay = 0)
+{
+    libgdtp::Data frame;
+    from.get_data_for_below(DEFAULT_BELOW_PORT_ID, frame);
+    from.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+    if (delay > 0)
+        boost::this_thread::sleep(boost::posix_time::milliseconds(delay));
+    to.handle_data_from_below(DEFAULT_BELOW_PORT_ID, frame);
+}
+
+
+/**
+ * Pass one SDU filled with the pattern from tx to rx and the ACK back, the
+ * SDU is delayed by the given time in ms.
+ */
+inline void transfer_sdu(libgdtp::Gdtp& tx_prot, libgdtp::Gdtp& rx_prot, const libgdtp::FlowId id,
+                         const size_t size, const uint8_t pattern, const uint32_t delay = 0)
+{
+    tx_prot.handle_data_from_above(std::make_shared<libgdtp::Data>(size, pattern), id);
+    forward_frame(tx_prot, rx_prot, delay);
+    forward_frame(rx_prot, tx_prot);
+}
+
+
+/**
+ * Pass frames in both directions until neither side has one left, the frames
+ * of tx_prot whose index is in lost are dropped.
+ * @return the number of frames sent by tx_prot
+ */
+inline size_t exchange_frames(libgdtp::Gdtp& tx_prot, libgdtp::Gdtp& rx_prot, const std::set<size_t>& lost)
+{
+    size_t num_frames = 0;
+    libgdtp::Data frame;
+    while (tx_prot.try_get_data_for_below(DEFAULT_BELOW_PORT_ID, frame)) {
+        tx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+        if (lost.count(num_frames++) == 0)
+            rx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, frame);
+        libgdtp::Data answer;
+        while (rx_prot.try_get_data_for_below(DEFAULT_BELOW_PORT_ID, answer)) {
+            rx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+            tx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, answer);
+        }
+    }
+    return num_frames;
+}
+
+#endif // TEST_HELPERS_H
@@ -0,0 +1,196 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#define BOOST_TEST_MODULE Nack_test
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include "libgdtp.h"
+
+using namespace std;
+using namespace libgdtp;
+
+using namespace boost;
+using namespace boost::unit_test;
+
+#define DEFAULT_ID 1
+#define PAYLOAD_SIZE_SHORT 10
+#define NUM_PDUS 3
+
+BOOST_AUTO_TEST_SUITE(Nack_test)
+
+/**
+ * Send NUM_PDUS PDUs with the payloads 1, 2, 3, .. and lose the second one.
+ * @return the frames that are received, i.e. the first and the third
+ */
+static std::vector<Data> send_with_gap(Gdtp& tx_prot, Gdtp& rx_prot, const ArqType type, const uint32_t ack_timeout, FlowId& id)
+{
+    tx_prot.set_default_source_address(1);
+    tx_prot.set_default_destination_address(2);
+    tx_prot.set_codec_type("binary");
+    tx_prot.initialize();
+
+    rx_prot.set_default_source_address(2);
+    rx_prot.set_default_destination_address(1);
+    rx_prot.set_codec_type("binary");
+    rx_prot.initialize();
+
+    FlowProperties props(RELIABLE);
+    props.set_arq_type(type);
+    props.set_ack_timeout(ack_timeout);
+    props.set_nack(true);
+    id = tx_prot.allocate_flow(DEFAULT_ID, props);
+    rx_prot.allocate_flow(DEFAULT_ID, props);
+
+    std::vector<Data> frames;
+    for (int i = 0; i < NUM_PDUS; i++) {
+        Data frame;
+        tx_prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, i + 1), id);
+        tx_prot.get_data_for_below(DEFAULT_BELOW_PORT_ID, frame);
+        tx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+        if (i != 1)
+            frames.push_back(frame);
+    }
+    return frames;
+}
+
+
+/**
+ * Hand a frame to the receiver and collect its answers.
+ */
+static std::vector<Data> receive(Gdtp& rx_prot, Data& frame)
+{
+    std::vector<Data> answers;
+    rx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, frame);
+    Data answer;
+    while (rx_prot.try_get_data_for_below(DEFAULT_BELOW_PORT_ID, answer)) {
+        rx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+        answers.push_back(answer);
+    }
+    return answers;
+}
+
+
+static void check_delivery(Gdtp& rx_prot)
+{
+    for (int i = 0; i < NUM_PDUS; i++) {
+        BOOST_REQUIRE(rx_prot.has_data_for_above(DEFAULT_ID));
+        BOOST_CHECK(rx_prot.get_data_for_above(DEFAULT_ID)->at(0) == i + 1);
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(SelectiveRepeat_test)
+{
+    Gdtp tx_prot, rx_prot;
+    FlowId id;
+    std::vector<Data> frames = send_with_gap(tx_prot, rx_prot, SELECTIVE_REPEAT, 1000, id);
+
+    // the gap is reported by a NACK in front of the ACK
+    std::vector<Data> answers = receive(rx_prot, frames[0]);
+    BOOST_REQUIRE(answers.size() == 1);
+    tx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, answers[0]);
+    answers = receive(rx_prot, frames[1]);
+    BOOST_REQUIRE(answers.size() == 2);
+    for (auto& answer : answers) {
+        tx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, answer);
+    }
+
+    // only the missing PDU is sent again, long before the timeout
+    Data frame;
+    BOOST_REQUIRE(tx_prot.try_get_data_for_below(DEFAULT_BELOW_PORT_ID, frame));
+    tx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+    BOOST_CHECK(frame.at(0) == 2);
+    BOOST_CHECK(tx_prot.has_data_for_below(DEFAULT_BELOW_PORT_ID) == false);
+    ArqStats stats = tx_prot.get_stats(id).arq;
+    BOOST_CHECK(stats.rtx_pdus == 1);
+    BOOST_CHECK(stats.fast_rtx_pdus == 1);
+    BOOST_CHECK(stats.timeout_rtx_pdus == 0);
+
+    // the retransmission doesn't trigger another NACK
+    answers = receive(rx_prot, frame);
+    BOOST_CHECK(answers.size() == 1);
+    check_delivery(rx_prot);
+}
+
+
+BOOST_AUTO_TEST_CASE(GoBackN_test)
+{
+    Gdtp tx_prot, rx_prot;
+    FlowId id;
+    std::vector<Data> frames = send_with_gap(tx_prot, rx_prot, GO_BACK_N, 1000, id);
+
+    std::vector<Data> answers = receive(rx_prot, frames[0]);
+    BOOST_REQUIRE(answers.size() == 1);
+    tx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, answers[0]);
+    answers = receive(rx_prot, frames[1]);
+    BOOST_REQUIRE(answers.size() == 2);
+    for (auto& answer : answers) {
+        tx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, answer);
+    }
+
+    // the sender goes back to the missing PDU right away
+    for (int i = 2; i <= NUM_PDUS; i++) {
+        Data frame;
+        BOOST_REQUIRE(tx_prot.try_get_data_for_below(DEFAULT_BELOW_PORT_ID, frame));
+        tx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+        BOOST_CHECK(frame.at(0) == i);
+        receive(rx_prot, frame);
+    }
+    BOOST_CHECK(tx_prot.has_data_for_below(DEFAULT_BELOW_PORT_ID) == false);
+    ArqStats stats = tx_prot.get_stats(id).arq;
+    BOOST_CHECK(stats.fast_rtx_pdus == 2);
+    BOOST_CHECK(stats.timeout_rtx_pdus == 0);
+    check_delivery(rx_prot);
+}
+
+
+BOOST_AUTO_TEST_CASE(NackLost_test)
+{
+    Gdtp tx_prot, rx_prot;
+    FlowId id;
+    std::vector<Data> frames = send_with_gap(tx_prot, rx_prot, SELECTIVE_REPEAT, 100, id);
+
+    // only the ACK arrives, the sender leaves the hole in its SACK to the NACK
+    std::vector<Data> answers = receive(rx_prot, frames[0]);
+    BOOST_REQUIRE(answers.size() == 1);
+    tx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, answers[0]);
+    answers = receive(rx_prot, frames[1]);
+    BOOST_REQUIRE(answers.size() == 2);
+    tx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, answers[1]);
+    BOOST_CHECK(tx_prot.has_data_for_below(DEFAULT_BELOW_PORT_ID) == false);
+
+    // hence the timer has to recover the PDU
+    boost::this_thread::sleep(boost::posix_time::milliseconds(250));
+    Data frame;
+    BOOST_REQUIRE(tx_prot.try_get_data_for_below(DEFAULT_BELOW_PORT_ID, frame));
+    tx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+    BOOST_CHECK(frame.at(0) == 2);
+    ArqStats stats = tx_prot.get_stats(id).arq;
+    BOOST_CHECK(stats.fast_rtx_pdus == 0);
+    BOOST_CHECK(stats.timeout_rtx_pdus == 1);
+
+    receive(rx_prot, frame);
+    check_delivery(rx_prot);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
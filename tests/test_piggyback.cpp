@@ -0,0 +1,162 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#define BOOST_TEST_MODULE Piggyback_test
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include "libgdtp.h"
+#include "exceptions.h"
+#include "test_helpers.h"
+
+using namespace std;
+using namespace libgdtp;
+
+using namespace boost;
+using namespace boost::unit_test;
+
+#define DEFAULT_ID 1000 // beyond the flow ids, so get_stats() finds the inbound flow of the port
+#define PAYLOAD_SIZE_SHORT 10
+
+BOOST_AUTO_TEST_SUITE(Piggyback_test)
+
+/**
+ * Take the single frame waiting at the sender and hand it to the receiver.
+ */
+static void forward(Gdtp& from, Gdtp& to)
+{
+    Data frame;
+    BOOST_REQUIRE(from.try_get_data_for_below(DEFAULT_BELOW_PORT_ID, frame));
+    from.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+    BOOST_REQUIRE(from.has_data_for_below(DEFAULT_BELOW_PORT_ID) == false);
+    to.handle_data_from_below(DEFAULT_BELOW_PORT_ID, frame);
+}
+
+
+BOOST_AUTO_TEST_CASE(RequestResponse_test)
+{
+    const int NUM_ROUNDS = 20;
+    const ArqType arq_types[] = {STOP_AND_WAIT, SELECTIVE_REPEAT, GO_BACK_N};
+    for (auto& arq_type : arq_types) {
+        Gdtp client, server;
+        setup_pair(client, server);
+
+        // the delay is long enough for the ACKs to always wait for the next request or response
+        FlowProperties props(RELIABLE);
+        props.set_arq_type(arq_type);
+        props.set_ack_timeout(1000);
+        props.set_ack_delay(500);
+        FlowId client_id = client.allocate_flow(DEFAULT_ID, props);
+        FlowId server_id = server.allocate_flow(DEFAULT_ID, props);
+
+        for (int i = 0; i < NUM_ROUNDS; i++) {
+            // the request carries the ACK of the previous response and vice versa
+            client.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, i), client_id);
+            forward(client, server);
+            BOOST_REQUIRE(server.has_data_for_above(DEFAULT_ID));
+            BOOST_CHECK(server.get_data_for_above(DEFAULT_ID)->at(0) == i);
+
+            server.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, i), server_id);
+            forward(server, client);
+            BOOST_REQUIRE(client.has_data_for_above(DEFAULT_ID));
+            BOOST_CHECK(client.get_data_for_above(DEFAULT_ID)->at(0) == i);
+        }
+
+        // no ACK was sent on its own, nothing had to be sent again
+        ArqStats server_rx = server.get_stats(DEFAULT_ID).arq;
+        ArqStats client_rx = client.get_stats(DEFAULT_ID).arq;
+        BOOST_CHECK(server_rx.piggybacked_acks == NUM_ROUNDS);
+        BOOST_CHECK(server_rx.pdus_for_below == 0);
+        BOOST_CHECK(client_rx.piggybacked_acks == NUM_ROUNDS - 1);
+        BOOST_CHECK(client_rx.pdus_for_below == 0);
+        BOOST_CHECK(client.get_stats(client_id).arq.rtx_pdus == 0);
+        BOOST_CHECK(server.get_stats(server_id).arq.rtx_pdus == 0);
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(DelayedAck_test)
+{
+    Gdtp client, server;
+    setup_pair(client, server);
+
+    FlowProperties props(RELIABLE);
+    props.set_arq_type(SELECTIVE_REPEAT);
+    props.set_ack_timeout(300);
+    props.set_ack_delay(50);
+    FlowId client_id = client.allocate_flow(DEFAULT_ID, props);
+    server.allocate_flow(DEFAULT_ID, props);
+
+    // without a response, the ACK is held back only until the delay has passed
+    client.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, 1), client_id);
+    forward(client, server);
+    BOOST_CHECK(server.has_data_for_below(DEFAULT_BELOW_PORT_ID) == false);
+    boost::this_thread::sleep(boost::posix_time::milliseconds(150));
+    forward(server, client);
+    BOOST_CHECK(server.get_stats(DEFAULT_ID).arq.pdus_for_below == 1);
+    BOOST_CHECK(server.get_stats(DEFAULT_ID).arq.piggybacked_acks == 0);
+
+    // the ACK arrived before the timeout, so the request isn't sent again
+    boost::this_thread::sleep(boost::posix_time::milliseconds(300));
+    BOOST_CHECK(client.has_data_for_below(DEFAULT_BELOW_PORT_ID) == false);
+    BOOST_CHECK(client.get_stats(client_id).arq.rtx_pdus == 0);
+}
+
+BOOST_AUTO_TEST_CASE(SharedFlowId_test)
+{
+    Gdtp client, server;
+    setup_pair(client, server);
+
+    // the server uses up all flow ids, so one of its flows has the id of the client's flow
+    FlowProperties props(RELIABLE);
+    props.set_arq_type(SELECTIVE_REPEAT);
+    FlowId client_id = client.allocate_flow(DEFAULT_ID, props);
+    std::map<FlowId, PortId> server_ports;
+    for (PortId port = DEFAULT_ID + 1; port <= DEFAULT_ID + MAX_NUM_FLOWS + 1; port++) {
+        server_ports[server.allocate_flow(port, props)] = port;
+    }
+    BOOST_REQUIRE(server_ports.count(client_id) == 1);
+    BOOST_CHECK_THROW(server.allocate_flow(DEFAULT_ID + MAX_NUM_FLOWS + 2, props), GdtpException);
+
+    // DATA of the client ends up at the inbound flow of the server, not at its outbound flow
+    for (int i = 0; i < 3; i++) {
+        transfer_sdu(client, server, client_id, PAYLOAD_SIZE_SHORT, i);
+        BOOST_REQUIRE(server.has_data_for_above(DEFAULT_ID));
+        BOOST_CHECK(server.get_data_for_above(DEFAULT_ID)->at(0) == i);
+    }
+
+    // and vice versa for the flow of the server with the same id
+    const PortId port = server_ports[client_id];
+    for (int i = 0; i < 3; i++) {
+        transfer_sdu(server, client, client_id, PAYLOAD_SIZE_SHORT, i);
+        BOOST_REQUIRE(client.has_data_for_above(port));
+        BOOST_CHECK(client.get_data_for_above(port)->at(0) == i);
+    }
+
+    boost::this_thread::sleep(boost::posix_time::milliseconds(200));
+    BOOST_CHECK(client.has_data_for_below(DEFAULT_BELOW_PORT_ID) == false);
+    BOOST_CHECK(server.has_data_for_below(DEFAULT_BELOW_PORT_ID) == false);
+    BOOST_CHECK(client.get_stats(client_id).arq.rtx_pdus == 0);
+    BOOST_CHECK(server.get_stats(client_id).arq.rtx_pdus == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
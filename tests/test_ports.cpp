@@ -0,0 +1,279 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#define BOOST_TEST_MODULE Port_test
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include "libgdtp.h"
+#include "exceptions.h"
+
+using namespace std;
+using namespace libgdtp;
+
+using namespace boost;
+using namespace boost::unit_test;
+
+#define SECOND_BELOW_PORT_ID 1
+#define PAYLOAD_SIZE_SHORT 10
+
+BOOST_AUTO_TEST_SUITE(Port_test)
+
+BOOST_AUTO_TEST_CASE(Allocation_test)
+{
+    Gdtp prot;
+    prot.set_scheduler_type("priority", SECOND_BELOW_PORT_ID);
+    prot.initialize();
+
+    FlowProperties props;
+    props.set_below_port(SECOND_BELOW_PORT_ID + 1);
+    BOOST_CHECK_THROW(prot.allocate_flow(1, props), ParameterException);
+
+    props.set_below_port(SECOND_BELOW_PORT_ID);
+    FlowId id = prot.allocate_flow(1, props);
+
+    // neither the port of a flow nor the scheduler of a used port may change
+    props.set_below_port(DEFAULT_BELOW_PORT_ID);
+    BOOST_CHECK_THROW(prot.modify_properties(id, props), ParameterException);
+    // nor anything else the flow has been built with
+    props.set_below_port(SECOND_BELOW_PORT_ID);
+    props.set_window_size(2 * props.get_window_size());
+    BOOST_CHECK_THROW(prot.modify_properties(id, props), ParameterException);
+    props.set_window_size(props.get_window_size() / 2);
+    props.set_fec(8, 1);
+    BOOST_CHECK_THROW(prot.modify_properties(id, props), ParameterException);
+    BOOST_CHECK_THROW(prot.set_scheduler_type("fifo", SECOND_BELOW_PORT_ID), ParameterException);
+
+    // ports and schedulers are fixed once the tx threads may run
+    BOOST_CHECK_THROW(prot.set_scheduler_type("fifo", DEFAULT_BELOW_PORT_ID), ParameterException);
+    BOOST_CHECK_THROW(prot.set_scheduler_type("fifo", SECOND_BELOW_PORT_ID + 1), ParameterException);
+}
+
+
+BOOST_AUTO_TEST_CASE(Independent_ports_test)
+{
+    Gdtp tx_prot;
+    tx_prot.set_default_source_address(1);
+    tx_prot.set_default_destination_address(2);
+    tx_prot.set_scheduler_type("fifo", SECOND_BELOW_PORT_ID);
+    tx_prot.set_codec_type("binary");
+    tx_prot.initialize();
+
+    Gdtp rx_prot;
+    rx_prot.set_default_source_address(2);
+    rx_prot.set_default_destination_address(1);
+    rx_prot.set_scheduler_type("fifo", SECOND_BELOW_PORT_ID);
+    rx_prot.set_codec_type("binary");
+    rx_prot.initialize();
+
+    FlowProperties props;
+    FlowId id1 = tx_prot.allocate_flow(1, props);
+    props.set_below_port(SECOND_BELOW_PORT_ID);
+    FlowId id2 = tx_prot.allocate_flow(2, props);
+
+    // a tx thread waiting on the first port doesn't hold up the second one
+    Data frame1;
+    boost::thread tx_thread([&tx_prot, &frame1]() {
+        tx_prot.get_data_for_below(DEFAULT_BELOW_PORT_ID, frame1);
+        tx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+    });
+
+    tx_prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, 2), id2);
+    BOOST_REQUIRE(tx_prot.has_data_for_below(SECOND_BELOW_PORT_ID) == true);
+    Data frame2;
+    tx_prot.get_data_for_below(SECOND_BELOW_PORT_ID, frame2);
+    tx_prot.set_data_transmitted(SECOND_BELOW_PORT_ID);
+    BOOST_CHECK(frame2[0] == 2); // binary frames start with the payload
+
+    // the receiver acknowledges on the port the frame arrived on
+    rx_prot.handle_data_from_below(SECOND_BELOW_PORT_ID, frame2);
+    BOOST_CHECK(rx_prot.has_data_for_above(2) == true);
+    BOOST_CHECK(rx_prot.has_data_for_below(DEFAULT_BELOW_PORT_ID) == false);
+    BOOST_REQUIRE(rx_prot.has_data_for_below(SECOND_BELOW_PORT_ID) == true);
+    Data ack;
+    rx_prot.get_data_for_below(SECOND_BELOW_PORT_ID, ack);
+    rx_prot.set_data_transmitted(SECOND_BELOW_PORT_ID);
+    tx_prot.handle_data_from_below(SECOND_BELOW_PORT_ID, ack);
+
+    tx_prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, 1), id1);
+    tx_thread.join();
+    BOOST_CHECK(frame1[0] == 1);
+
+    ArqStats stats = tx_prot.get_stats(id2).arq;
+    BOOST_CHECK(stats.pdus_for_below == 1);
+    BOOST_CHECK(stats.pdus_from_below == 1);
+    BOOST_CHECK(stats.rtx_pdus == 0);
+}
+
+/**
+ * Get all frames that are queued for a port.
+ */
+static std::vector<Data> drain_port(Gdtp& prot, const PortId port)
+{
+    std::vector<Data> frames;
+    while (prot.has_data_for_below(port)) {
+        Data frame;
+        prot.get_data_for_below(port, frame);
+        prot.set_data_transmitted(port);
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+
+BOOST_AUTO_TEST_CASE(Striping_test)
+{
+    Gdtp tx_prot;
+    tx_prot.set_default_source_address(1);
+    tx_prot.set_default_destination_address(2);
+    tx_prot.set_scheduler_type("fifo", SECOND_BELOW_PORT_ID);
+    tx_prot.set_codec_type("binary");
+    tx_prot.initialize();
+
+    Gdtp rx_prot;
+    rx_prot.set_default_source_address(2);
+    rx_prot.set_default_destination_address(1);
+    rx_prot.set_scheduler_type("fifo", SECOND_BELOW_PORT_ID);
+    rx_prot.set_codec_type("binary");
+    rx_prot.initialize();
+
+    FlowProperties props;
+    props.set_arq_type(SELECTIVE_REPEAT);
+    props.set_striping_mode(WEIGHTED_ROUND_ROBIN);
+    props.add_stripe_port(DEFAULT_BELOW_PORT_ID, 1);
+    props.add_stripe_port(SECOND_BELOW_PORT_ID + 1, 3);
+    BOOST_CHECK_THROW(tx_prot.allocate_flow(1, props), ParameterException);
+
+    FlowProperties valid_props;
+    valid_props.set_arq_type(SELECTIVE_REPEAT);
+    valid_props.set_striping_mode(WEIGHTED_ROUND_ROBIN);
+    valid_props.add_stripe_port(DEFAULT_BELOW_PORT_ID, 1);
+    valid_props.add_stripe_port(SECOND_BELOW_PORT_ID, 3);
+    FlowId id = tx_prot.allocate_flow(1, valid_props);
+
+    // register the flow at the receiver to get an SR receiver
+    FlowProperties rx_props;
+    rx_props.set_arq_type(SELECTIVE_REPEAT);
+    rx_prot.allocate_flow(1, rx_props);
+
+    // a full window is spread 1:3 across both ports
+    const size_t num_sdus = valid_props.get_window_size();
+    for (size_t i = 0; i < num_sdus; i++) {
+        tx_prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, i), id);
+    }
+    std::vector<Data> frames1 = drain_port(tx_prot, DEFAULT_BELOW_PORT_ID);
+    std::vector<Data> frames2 = drain_port(tx_prot, SECOND_BELOW_PORT_ID);
+    BOOST_CHECK(frames1.size() == num_sdus / 4);
+    BOOST_CHECK(frames2.size() == 3 * num_sdus / 4);
+
+    // the faster port delivers first, the receiver restores the order
+    for (auto& frame : frames2) {
+        rx_prot.handle_data_from_below(SECOND_BELOW_PORT_ID, frame);
+    }
+    for (auto& frame : frames1) {
+        rx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, frame);
+    }
+    for (size_t i = 0; i < num_sdus; i++) {
+        BOOST_REQUIRE(rx_prot.has_data_for_above(1) == true);
+        std::shared_ptr<Data> sdu = rx_prot.get_data_for_above(1);
+        BOOST_CHECK(sdu->at(0) == uint8_t(i));
+    }
+
+    // ACKs travel back on the port the flow was first seen on
+    BOOST_CHECK(rx_prot.has_data_for_below(DEFAULT_BELOW_PORT_ID) == false);
+    for (auto& ack : drain_port(rx_prot, SECOND_BELOW_PORT_ID)) {
+        tx_prot.handle_data_from_below(SECOND_BELOW_PORT_ID, ack);
+    }
+
+    ArqStats stats = tx_prot.get_stats(id).arq;
+    BOOST_CHECK(stats.pdus_for_below == num_sdus);
+    BOOST_CHECK(stats.pdus_from_below == num_sdus);
+    BOOST_CHECK(stats.rtx_pdus == 0);
+
+    // striping is fixed at flow creation
+    valid_props.set_striping_mode(SHORTEST_QUEUE);
+    BOOST_CHECK_THROW(tx_prot.modify_properties(id, valid_props), ParameterException);
+}
+
+
+BOOST_AUTO_TEST_CASE(Shortest_queue_test)
+{
+    Gdtp prot;
+    prot.set_scheduler_type("fifo", SECOND_BELOW_PORT_ID);
+    prot.set_codec_type("binary");
+    prot.initialize();
+
+    FlowProperties props;
+    props.set_transfer_mode(UNRELIABLE);
+    props.set_arq_type(SELECTIVE_REPEAT);
+    props.set_striping_mode(SHORTEST_QUEUE);
+    props.add_stripe_port(DEFAULT_BELOW_PORT_ID);
+    props.add_stripe_port(SECOND_BELOW_PORT_ID);
+    FlowId id = prot.allocate_flow(1, props);
+
+    // the first port drains faster, hence it gets more PDUs
+    for (int i = 0; i < 4; i++) {
+        prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, i), id);
+    }
+    BOOST_CHECK(drain_port(prot, DEFAULT_BELOW_PORT_ID).size() == 2);
+    for (int i = 0; i < 4; i++) {
+        prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, i), id);
+    }
+    BOOST_CHECK(drain_port(prot, DEFAULT_BELOW_PORT_ID).size() == 3);
+    BOOST_CHECK(drain_port(prot, SECOND_BELOW_PORT_ID).size() == 3);
+}
+
+
+BOOST_AUTO_TEST_CASE(Striped_rate_test)
+{
+    Gdtp prot;
+    prot.set_scheduler_type("fifo", SECOND_BELOW_PORT_ID);
+    prot.set_codec_type("binary");
+    prot.initialize();
+
+    FlowProperties props;
+    props.set_transfer_mode(UNRELIABLE);
+    props.set_arq_type(SELECTIVE_REPEAT);
+    props.set_striping_mode(WEIGHTED_ROUND_ROBIN);
+    props.add_stripe_port(DEFAULT_BELOW_PORT_ID);
+    props.add_stripe_port(SECOND_BELOW_PORT_ID);
+    props.set_rate(100);
+    props.set_burst(2 * PAYLOAD_SIZE_SHORT);
+    FlowId id = prot.allocate_flow(1, props);
+
+    // one SDU per port empties the bucket
+    for (int i = 0; i < 2; i++) {
+        prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, i), id);
+    }
+    BOOST_CHECK(drain_port(prot, DEFAULT_BELOW_PORT_ID).size() == 1);
+    BOOST_CHECK(drain_port(prot, SECOND_BELOW_PORT_ID).size() == 1);
+    BOOST_CHECK(prot.get_stats(id).arq.tokens < PAYLOAD_SIZE_SHORT);
+
+    // the rate applies to the flow as a whole, not to each of its ports
+    for (int i = 2; i < 4; i++) {
+        prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, i), id);
+    }
+    BOOST_CHECK(prot.has_data_for_below(DEFAULT_BELOW_PORT_ID) == false);
+    BOOST_CHECK(prot.has_data_for_below(SECOND_BELOW_PORT_ID) == false);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
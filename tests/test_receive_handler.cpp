@@ -0,0 +1,107 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#define BOOST_TEST_MODULE ReceiveHandler_test
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include "libgdtp.h"
+#include "test_helpers.h"
+
+using namespace std;
+using namespace libgdtp;
+
+using namespace boost;
+using namespace boost::unit_test;
+
+#define DEFAULT_ID 1000 // beyond the flow ids, so get_stats() finds the inbound flow of the port
+#define PAYLOAD_SIZE_SHORT 10
+
+BOOST_AUTO_TEST_SUITE(ReceiveHandler_test)
+
+BOOST_AUTO_TEST_CASE(Callback_test)
+{
+    Gdtp tx_prot, rx_prot;
+    setup_pair(tx_prot, rx_prot);
+
+    FlowId id = tx_prot.allocate_flow(DEFAULT_ID);
+
+    // register before the inbound flow exists
+    std::vector<uint8_t> received;
+    boost::thread::id handler_thread;
+    rx_prot.register_receive_handler(DEFAULT_ID, [&](std::shared_ptr<Data> sdu) {
+        received.push_back(sdu->at(0));
+        handler_thread = boost::this_thread::get_id();
+    });
+
+    // SDUs bypass the buffer and are delivered on the thread feeding data from below
+    transfer_sdu(tx_prot, rx_prot, id, PAYLOAD_SIZE_SHORT, 1);
+    transfer_sdu(tx_prot, rx_prot, id, PAYLOAD_SIZE_SHORT, 2);
+    BOOST_REQUIRE(received.size() == 2);
+    BOOST_CHECK(received[0] == 1);
+    BOOST_CHECK(received[1] == 2);
+    BOOST_CHECK(handler_thread == boost::this_thread::get_id());
+    BOOST_CHECK(rx_prot.has_data_for_above(DEFAULT_ID) == false);
+    BOOST_CHECK(rx_prot.get_stats(DEFAULT_ID).encoder.bytes_for_above == 2 * PAYLOAD_SIZE_SHORT);
+
+    // without handler, SDUs are queued again
+    rx_prot.register_receive_handler(DEFAULT_ID, ReceiveHandler());
+    transfer_sdu(tx_prot, rx_prot, id, PAYLOAD_SIZE_SHORT, 3);
+    BOOST_CHECK(received.size() == 2);
+    BOOST_REQUIRE(rx_prot.has_data_for_above(DEFAULT_ID) == true);
+    BOOST_CHECK(rx_prot.get_data_for_above(DEFAULT_ID)->at(0) == 3);
+}
+
+BOOST_AUTO_TEST_CASE(Echo_test)
+{
+    Gdtp tx_prot, rx_prot;
+    setup_pair(tx_prot, rx_prot);
+
+    // the ACK is delayed, so the echo takes it along
+    FlowProperties props(RELIABLE);
+    props.set_arq_type(SELECTIVE_REPEAT);
+    props.set_ack_delay(500);
+    FlowId id = tx_prot.allocate_flow(DEFAULT_ID, props);
+    FlowId echo_id = rx_prot.allocate_flow(DEFAULT_ID, props);
+
+    // the handler answers and hands the answer to the lower layer right away
+    Data echo;
+    bool sent = false;
+    rx_prot.register_receive_handler(DEFAULT_ID, [&](std::shared_ptr<Data> sdu) {
+        rx_prot.handle_data_from_above(sdu, echo_id);
+        sent = rx_prot.try_get_data_for_below(DEFAULT_BELOW_PORT_ID, echo);
+        rx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+    });
+
+    tx_prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, 1), id);
+    forward_frame(tx_prot, rx_prot);
+    BOOST_REQUIRE(sent);
+    BOOST_CHECK(rx_prot.has_data_for_below(DEFAULT_BELOW_PORT_ID) == false);
+    BOOST_CHECK(rx_prot.get_stats(DEFAULT_ID).arq.piggybacked_acks == 1);
+
+    tx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, echo);
+    BOOST_REQUIRE(tx_prot.has_data_for_above(DEFAULT_ID));
+    BOOST_CHECK(tx_prot.get_data_for_above(DEFAULT_ID)->at(0) == 1);
+    BOOST_CHECK(tx_prot.get_stats(id).arq.rtx_pdus == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,114 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#define BOOST_TEST_MODULE RttEstimator_test
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include "libgdtp.h"
+#include "rtt_estimator.h"
+#include "test_helpers.h"
+
+using namespace std;
+using namespace libgdtp;
+
+using namespace boost;
+using namespace boost::unit_test;
+
+#define DEFAULT_ID 1
+#define PAYLOAD_SIZE_SHORT 10
+#define INITIAL_TIMEOUT 500
+#define DELAY 20
+
+BOOST_AUTO_TEST_SUITE(RttEstimator_test)
+
+BOOST_AUTO_TEST_CASE(Estimator_test)
+{
+    RttEstimator rtt;
+    BOOST_CHECK(rtt.get_rto(100, 10, 10000) == 100);
+
+    // first sample: SRTT = R, RTTVAR = R/2
+    rtt.add_sample(boost::posix_time::milliseconds(20));
+    BOOST_CHECK_CLOSE(rtt.get_srtt(), 20.0, 0.01);
+    BOOST_CHECK(rtt.get_rto(100, 10, 10000) == 60);
+
+    // each timeout doubles the RTO up to the maximum
+    rtt.backoff();
+    BOOST_CHECK(rtt.get_rto(100, 10, 10000) == 120);
+    rtt.backoff();
+    BOOST_CHECK(rtt.get_rto(100, 10, 10000) == 240);
+    BOOST_CHECK(rtt.get_rto(100, 10, 200) == 200);
+
+    // a new sample ends the backoff, RTTVAR decays
+    rtt.add_sample(boost::posix_time::milliseconds(20));
+    BOOST_CHECK_CLOSE(rtt.get_srtt(), 20.0, 0.01);
+    BOOST_CHECK(rtt.get_rto(100, 10, 10000) == 50);
+    BOOST_CHECK(rtt.get_rto(100, 80, 10000) == 80);
+}
+
+
+BOOST_AUTO_TEST_CASE(Adaptive_test)
+{
+    Gdtp tx_prot, rx_prot;
+    setup_pair(tx_prot, rx_prot);
+
+    FlowProperties props(RELIABLE);
+    props.set_ack_timeout(INITIAL_TIMEOUT);
+    FlowId id = tx_prot.allocate_flow(DEFAULT_ID, props);
+
+    // the static timeout is reported without the opt-in, each SDU is delayed
+    transfer_sdu(tx_prot, rx_prot, id, PAYLOAD_SIZE_SHORT, 1, DELAY);
+    rx_prot.get_data_for_above(DEFAULT_ID);
+    FlowStats stats = tx_prot.get_stats(id);
+    BOOST_CHECK(stats.arq.rto == INITIAL_TIMEOUT);
+    BOOST_CHECK(stats.arq.srtt == 0);
+
+    props.set_adaptive_rto(true);
+    tx_prot.modify_properties(id, props);
+    for (int i = 0; i < 5; i++) {
+        transfer_sdu(tx_prot, rx_prot, id, PAYLOAD_SIZE_SHORT, 1, DELAY);
+        rx_prot.get_data_for_above(DEFAULT_ID);
+    }
+    stats = tx_prot.get_stats(id);
+    BOOST_CHECK(stats.arq.srtt >= DELAY && stats.arq.srtt < 3 * DELAY);
+    BOOST_CHECK(stats.arq.rto >= props.get_min_rto() && stats.arq.rto < INITIAL_TIMEOUT);
+    const float srtt = stats.arq.srtt;
+
+    // lose the first transmission, the retransmission waits twice as long
+    tx_prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, 1), id);
+    Data frame;
+    tx_prot.get_data_for_below(DEFAULT_BELOW_PORT_ID, frame);
+    tx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+    const uint32_t rto = tx_prot.get_stats(id).arq.rto;
+    tx_prot.get_data_for_below(DEFAULT_BELOW_PORT_ID, frame);
+    tx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+    stats = tx_prot.get_stats(id);
+    BOOST_CHECK(stats.arq.rtx_pdus == 1);
+    BOOST_CHECK(stats.arq.rto + 1 >= 2 * rto && stats.arq.rto <= 2 * rto + 1); // both are rounded
+
+    // the ACK of a retransmitted PDU is no RTT sample (Karn)
+    rx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, frame);
+    forward_frame(rx_prot, tx_prot);
+    BOOST_CHECK(tx_prot.get_stats(id).arq.srtt == srtt);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
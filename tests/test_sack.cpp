@@ -0,0 +1,175 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#define BOOST_TEST_MODULE Sack_test
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include "libgdtp.h"
+#include "test_helpers.h"
+#include "../examples/channel.h"
+
+using namespace std;
+using namespace libgdtp;
+
+using namespace boost;
+using namespace boost::unit_test;
+
+#define DEFAULT_ID 1
+#define PAYLOAD_SIZE_SHORT 10
+
+BOOST_AUTO_TEST_SUITE(Sack_test)
+
+BOOST_AUTO_TEST_CASE(Hole_test)
+{
+    Gdtp tx_prot, rx_prot;
+    setup_pair(tx_prot, rx_prot);
+
+    // timers never fire during the test
+    FlowProperties props(RELIABLE);
+    props.set_arq_type(SELECTIVE_REPEAT);
+    props.set_ack_timeout(1000);
+    FlowId id = tx_prot.allocate_flow(DEFAULT_ID, props);
+    rx_prot.allocate_flow(DEFAULT_ID, props);
+
+    std::vector<Data> frames(3);
+    for (int i = 0; i < 3; i++) {
+        tx_prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, i + 1), id);
+        tx_prot.get_data_for_below(DEFAULT_BELOW_PORT_ID, frames[i]);
+        tx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    }
+
+    // the second frame is lost, each received frame is answered by one ACK
+    Data ack;
+    rx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, frames[0]);
+    rx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, frames[2]);
+    for (int i = 0; i < 2; i++) {
+        BOOST_REQUIRE(rx_prot.try_get_data_for_below(DEFAULT_BELOW_PORT_ID, ack));
+        rx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+        tx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, ack);
+    }
+    BOOST_CHECK(rx_prot.has_data_for_below(DEFAULT_BELOW_PORT_ID) == false);
+
+    // the SACK reveals the hole, only the missing PDU is sent again right away
+    Data frame;
+    BOOST_REQUIRE(tx_prot.try_get_data_for_below(DEFAULT_BELOW_PORT_ID, frame));
+    tx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+    BOOST_CHECK(frame.at(0) == 2);
+    BOOST_CHECK(tx_prot.has_data_for_below(DEFAULT_BELOW_PORT_ID) == false);
+    BOOST_CHECK(tx_prot.get_stats(id).arq.rtx_pdus == 1);
+
+    rx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, frame);
+    for (int i = 0; i < 3; i++) {
+        BOOST_REQUIRE(rx_prot.has_data_for_above(DEFAULT_ID));
+        BOOST_CHECK(rx_prot.get_data_for_above(DEFAULT_ID)->at(0) == i + 1);
+    }
+}
+
+
+static void feed(Gdtp& prot, const FlowId id, const int num_sdus)
+{
+    for (int i = 0; i < num_sdus; i++) {
+        prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, i % 256), id);
+    }
+}
+
+
+/**
+ * Pass all frames waiting at a port into the channel.
+ * @return the number of frames
+ */
+static int transmit(Gdtp& prot, Channel& channel)
+{
+    int num_frames = 0;
+    Data frame;
+    while (prot.try_get_data_for_below(DEFAULT_BELOW_PORT_ID, frame)) {
+        prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+        channel.pushBack(frame);
+        num_frames++;
+    }
+    return num_frames;
+}
+
+
+static int receive(Gdtp& prot, Channel& channel)
+{
+    int num_frames = 0;
+    Data frame;
+    while (channel.tryPop(frame)) {
+        prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, frame);
+        num_frames++;
+    }
+    return num_frames;
+}
+
+
+BOOST_AUTO_TEST_CASE(Lossy_test)
+{
+    const int NUM_SDUS = 200;
+    Gdtp tx_prot, rx_prot;
+    setup_pair(tx_prot, rx_prot, "aggregate");
+
+    FlowProperties props(RELIABLE);
+    props.set_arq_type(SELECTIVE_REPEAT);
+    props.set_window_size(16);
+    props.set_ack_timeout(20);
+    props.set_max_retransmissions(20);
+    FlowId id = tx_prot.allocate_flow(DEFAULT_ID, props);
+    rx_prot.allocate_flow(DEFAULT_ID, props);
+
+    // a burst may complete more SDUs than the upper layer buffer holds
+    std::vector<uint8_t> received;
+    rx_prot.register_receive_handler(DEFAULT_ID, [&](std::shared_ptr<Data> sdu) {
+        received.push_back(sdu->at(0));
+    });
+
+    Channel forward(1000, 0.2), backward(1000, 0.2);
+    boost::thread feeder(feed, boost::ref(tx_prot), id, NUM_SDUS);
+    int num_ack_frames = 0;
+    const boost::system_time end = boost::get_system_time() + boost::posix_time::seconds(30);
+    while (received.size() < NUM_SDUS && boost::get_system_time() < end) {
+        int num_frames = transmit(tx_prot, forward);
+        num_frames += receive(rx_prot, forward);
+        const int num_acks = transmit(rx_prot, backward);
+        num_ack_frames += num_acks;
+        num_frames += num_acks + receive(tx_prot, backward);
+        if (num_frames == 0) {
+            // wait for new SDUs or retransmission timeouts
+            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+        }
+    }
+    feeder.join();
+
+    BOOST_REQUIRE(received.size() == NUM_SDUS);
+    for (int i = 0; i < NUM_SDUS; i++) {
+        BOOST_CHECK(received[i] == i % 256);
+    }
+    BOOST_CHECK(tx_prot.get_stats(id).arq.lost_pdus == 0);
+
+    // one ACK per aggregated frame instead of one per PDU
+    const float acks_per_sdu = num_ack_frames / float(NUM_SDUS);
+    BOOST_TEST_MESSAGE("ACK frames per SDU: " << acks_per_sdu);
+    BOOST_CHECK(acks_per_sdu < 0.5);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
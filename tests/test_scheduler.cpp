@@ -25,6 +25,7 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/thread.hpp>
 #include "libgdtp.h"
+#include "exceptions.h"
 
 using namespace std;
 using namespace libgdtp;
@@ -131,6 +132,211 @@ BOOST_AUTO_TEST_CASE(priority_scheduler_test)
 }
 
 
+BOOST_AUTO_TEST_CASE(drr_scheduler_test)
+{
+    const int NUM_SDUS = 16;
+    const size_t BULK_SIZE = 1000;
+    const size_t SMALL_SIZE = 100;
+    FlowProperties props;
+    props.set_transfer_mode(UNRELIABLE);
+    props.set_arq_type(SELECTIVE_REPEAT);
+
+    Gdtp prot;
+    prot.set_default_source_address(0);
+    prot.set_default_destination_address(1);
+    prot.set_scheduler_type("drr");
+    prot.initialize();
+
+    FlowId bulk_id = prot.allocate_flow(1, props);
+    FlowId small_id = prot.allocate_flow(2, props);
+
+    // the bulk flow is backlogged first and would get most of the capacity with FIFO
+    for (int i = 0; i < NUM_SDUS; i++) {
+        prot.handle_data_from_above(make_shared<Data>(BULK_SIZE, 0xff), bulk_id);
+    }
+    for (int i = 0; i < NUM_SDUS; i++) {
+        prot.handle_data_from_above(make_shared<Data>(SMALL_SIZE, 0xff), small_id);
+    }
+
+    // transmit until all small SDUs are gone
+    size_t bulk_bytes = 0, small_bytes = 0;
+    while (small_bytes < NUM_SDUS * SMALL_SIZE) {
+        Data frame;
+        prot.get_data_for_below(DEFAULT_BELOW_PORT_ID, frame);
+        prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+        if (frame.size() > BULK_SIZE)
+            bulk_bytes += BULK_SIZE;
+        else
+            small_bytes += SMALL_SIZE;
+    }
+
+    // both flows have had the same share of bytes, plus at most one quantum
+    BOOST_CHECK(bulk_bytes <= small_bytes + props.get_quantum());
+    BOOST_CHECK(bulk_bytes >= small_bytes - props.get_quantum());
+
+    // send remaining frames
+    while (prot.has_data_for_below(DEFAULT_BELOW_PORT_ID)) {
+        Data frame;
+        prot.get_data_for_below(DEFAULT_BELOW_PORT_ID, frame);
+        prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+        bulk_bytes += BULK_SIZE;
+    }
+    BOOST_CHECK(bulk_bytes == NUM_SDUS * BULK_SIZE);
+
+    // a flow without quantum would never be serviced
+    props.set_quantum(0);
+    BOOST_CHECK_THROW(prot.allocate_flow(3, props), ParameterException);
+    BOOST_CHECK_THROW(prot.modify_properties(small_id, props), ParameterException);
+}
+
+
+BOOST_AUTO_TEST_CASE(wfq_scheduler_test)
+{
+    const int NUM_FLOWS = 3;
+    const int NUM_SDUS = 16;
+    const uint32_t weights[NUM_FLOWS] = { 70, 20, 10 };
+    FlowProperties props;
+    props.set_transfer_mode(UNRELIABLE);
+    props.set_arq_type(SELECTIVE_REPEAT);
+
+    Gdtp prot;
+    prot.set_default_source_address(0);
+    prot.set_default_destination_address(1);
+    prot.set_scheduler_type("wfq");
+    prot.set_codec_type("binary");
+    prot.initialize();
+
+    // the payload pattern identifies the flow, frames start with the payload in binary format
+    FlowId ids[NUM_FLOWS];
+    for (int i = 0; i < NUM_FLOWS; i++) {
+        props.set_weight(weights[i]);
+        ids[i] = prot.allocate_flow(i + 1, props);
+    }
+    for (int i = NUM_FLOWS - 1; i >= 0; i--) {
+        for (int j = 0; j < NUM_SDUS; j++) {
+            prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_LONG, i), ids[i]);
+        }
+    }
+
+    // count frames per flow
+    int num_frames[NUM_FLOWS] = { 0 };
+    auto transmit = [&](const int num) {
+        for (int i = 0; i < num; i++) {
+            Data frame;
+            prot.get_data_for_below(DEFAULT_BELOW_PORT_ID, frame);
+            prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+            BOOST_REQUIRE(frame.size() > 0 && frame[0] < NUM_FLOWS);
+            num_frames[frame[0]]++;
+        }
+    };
+
+    // all flows are backlogged, so 20 frames should be split 14/4/2
+    transmit(20);
+    BOOST_CHECK(std::abs(num_frames[0] - 14) <= 1);
+    BOOST_CHECK(std::abs(num_frames[1] - 4) <= 1);
+    BOOST_CHECK(std::abs(num_frames[2] - 2) <= 1);
+
+    // swap weights of the first and the last flow while they are active
+    props.set_weight(weights[2]);
+    prot.modify_properties(ids[0], props);
+    props.set_weight(weights[0]);
+    prot.modify_properties(ids[2], props);
+    std::fill(num_frames, num_frames + NUM_FLOWS, 0);
+    transmit(10);
+    BOOST_CHECK(num_frames[2] >= 6);
+    BOOST_CHECK(num_frames[0] <= 2);
+
+    // a flow without weight would never get a share of the port
+    props.set_weight(0);
+    BOOST_CHECK_THROW(prot.allocate_flow(NUM_FLOWS + 1, props), ParameterException);
+    BOOST_CHECK_THROW(prot.modify_properties(ids[0], props), ParameterException);
+}
+
+
+BOOST_AUTO_TEST_CASE(edf_scheduler_test)
+{
+    FlowProperties props;
+    props.set_transfer_mode(UNRELIABLE);
+
+    Gdtp prot;
+    prot.set_default_source_address(0);
+    prot.set_default_destination_address(1);
+    prot.set_scheduler_type("edf");
+    prot.set_codec_type("binary");
+    prot.initialize();
+
+    FlowId id1 = prot.allocate_flow(1, props);
+    FlowId id2 = prot.allocate_flow(2, props);
+    FlowId id3 = prot.allocate_flow(3, props);
+
+    // the later an SDU arrives, the more urgent it is, the pattern identifies the flow
+    prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, 1), id1);
+    prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, 2), id2, 10000);
+    prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, 3), id3, 5000);
+
+    std::vector<uint8_t> order;
+    while (prot.has_data_for_below(DEFAULT_BELOW_PORT_ID)) {
+        Data frame;
+        prot.get_data_for_below(DEFAULT_BELOW_PORT_ID, frame);
+        prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+        order.push_back(frame[0]); // binary frames start with the payload
+    }
+
+    // the SDU without deadline goes last
+    BOOST_REQUIRE(order.size() == 3);
+    BOOST_CHECK(order[0] == 3);
+    BOOST_CHECK(order[1] == 2);
+    BOOST_CHECK(order[2] == 1);
+}
+
+
+BOOST_AUTO_TEST_CASE(aggregate_scheduler_test)
+{
+    FlowProperties props;
+    props.set_transfer_mode(UNRELIABLE);
+
+    Gdtp prot;
+    prot.set_default_source_address(0);
+    prot.set_default_destination_address(1);
+    // only aggregating schedulers accept limits
+    BOOST_CHECK_THROW(prot.set_aggregation_limits(2 * PAYLOAD_SIZE_SHORT + 5), ParameterException);
+    prot.set_scheduler_type("aggregate");
+    prot.set_aggregation_limits(2 * PAYLOAD_SIZE_SHORT + 5);
+    prot.set_codec_type("binary"); // fixed size headers
+    prot.initialize();
+
+    const int num_flows = 5;
+    std::vector<FlowId> ids;
+    for (int i = 0; i < num_flows; i++) {
+        ids.push_back(prot.allocate_flow(i + 1, props));
+        prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, i), ids.back());
+    }
+
+    // two PDUs fit into the budget, the last one is sent alone
+    std::vector<size_t> sizes;
+    while (prot.has_data_for_below(DEFAULT_BELOW_PORT_ID)) {
+        Data frame;
+        prot.get_data_for_below(DEFAULT_BELOW_PORT_ID, frame);
+        prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+        sizes.push_back(frame.size());
+    }
+    BOOST_REQUIRE(sizes.size() == 3);
+    BOOST_CHECK(sizes[0] == sizes[1]);
+    BOOST_CHECK(sizes[2] < sizes[0]);
+
+    FlowStats stats = prot.get_stats(ids.front());
+    BOOST_CHECK(stats.encoder.frames_for_below == 3);
+    BOOST_CHECK(stats.encoder.pdus_for_below == num_flows);
+    BOOST_CHECK_CLOSE(stats.encoder.aggregation_factor, 5.0 / 3.0, 0.01);
+
+    // every flow got its PDU confirmed and accepts new SDUs
+    for (FlowId id : ids) {
+        prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, 0), id);
+        BOOST_CHECK(prot.get_stats(id).arq.pdus_for_below == 2);
+    }
+}
+
+
 BOOST_AUTO_TEST_CASE(implicitack_scheduler_test)
 {
     FlowProperties props;
@@ -78,4 +78,54 @@ BOOST_AUTO_TEST_CASE(BasicFer_test)
     BOOST_CHECK_CLOSE(stats.arq.fer, 0.2f, 0.01 );
 }
 
+BOOST_AUTO_TEST_CASE(Allocation_test)
+{
+    const int NUM_WARMUP_SDUS = 10;
+    const int NUM_SDUS = 100;
+    FlowProperties props;
+
+    Gdtp tx_prot;
+    tx_prot.set_default_source_address(1);
+    tx_prot.set_default_destination_address(2);
+    tx_prot.initialize();
+
+    Gdtp rx_prot;
+    rx_prot.set_default_source_address(2);
+    rx_prot.initialize();
+
+    FlowId tx_id = tx_prot.allocate_flow(DEFAULT_ID, props);
+    rx_prot.allocate_flow(DEFAULT_ID, props);
+
+    FlowStats warm_stats;
+    for (int i = 0; i < NUM_WARMUP_SDUS + NUM_SDUS; i++) {
+        if (i == NUM_WARMUP_SDUS)
+            warm_stats = rx_prot.get_stats(DEFAULT_ID);
+
+        std::shared_ptr<Data> sdu = make_shared<Data>(100, 0xff);
+        tx_prot.handle_data_from_above(sdu, tx_id);
+
+        // pass data frame to receiver and ACK back to transmitter
+        Data data, ack;
+        tx_prot.get_data_for_below(DEFAULT_BELOW_PORT_ID, data);
+        tx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+        rx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, data);
+        rx_prot.get_data_for_below(DEFAULT_BELOW_PORT_ID, ack);
+        rx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+        tx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, ack);
+
+        // consume and release the SDU
+        BOOST_CHECK(rx_prot.get_data_for_above(DEFAULT_ID)->size() == 100);
+    }
+
+    // in steady state, all payloads are served from the pool
+    FlowStats stats = rx_prot.get_stats(DEFAULT_ID);
+    BOOST_CHECK(stats.encoder.heap_allocations == warm_stats.encoder.heap_allocations);
+    BOOST_CHECK(stats.encoder.pool_allocations >= warm_stats.encoder.pool_allocations + 2 * NUM_SDUS);
+
+    // ACKs share an empty payload and don't allocate at all
+    FlowStats tx_stats = tx_prot.get_stats(tx_id);
+    BOOST_CHECK(tx_stats.encoder.heap_allocations == 0);
+    BOOST_CHECK(tx_stats.encoder.pool_allocations == 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -195,4 +195,37 @@ BOOST_AUTO_TEST_CASE(DualUnreliable_test)
     BOOST_CHECK(rx_prot.has_data_for_below(DEFAULT_BELOW_PORT_ID) == false);
 }
 
+BOOST_AUTO_TEST_CASE(LateDrop_test)
+{
+    const uint32_t timeout = 100;
+    FlowProperties props;
+    props.set_ack_timeout(timeout);
+    props.set_max_latency(timeout / 2);
+
+    Gdtp tx_prot;
+    tx_prot.set_default_source_address(1);
+    tx_prot.set_default_destination_address(2);
+    tx_prot.initialize();
+
+    FlowId id = tx_prot.allocate_flow(DEFAULT_ID, props);
+
+    // the first SDU is sent right away, the second one has to wait for it
+    tx_prot.handle_data_from_above(make_shared<Data>(10, 0xff), id);
+    tx_prot.handle_data_from_above(make_shared<Data>(10, 0xff), id, timeout / 10);
+
+    Data frame;
+    tx_prot.get_data_for_below(DEFAULT_BELOW_PORT_ID, frame);
+    tx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+
+    // the ACK never arrives, so the first SDU times out after its deadline, and the
+    // second SDU has expired while waiting. Neither of them may be transmitted again
+    boost::this_thread::sleep(boost::posix_time::milliseconds(2 * timeout));
+    BOOST_CHECK(tx_prot.has_data_for_below(DEFAULT_BELOW_PORT_ID) == false);
+
+    FlowStats stats = tx_prot.get_stats(id);
+    BOOST_CHECK(stats.arq.dropped_late == 2);
+    BOOST_CHECK(stats.arq.rtx_pdus == 0);
+    BOOST_CHECK(stats.arq.pdus_for_below == 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,106 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2015, André Puschmann <andre.puschmann@tu-ilmenau.de>
+ *
+ * This file is part of libgdtp.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#define BOOST_TEST_MODULE TokenBucket_test
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include "libgdtp.h"
+#include "token_bucket.h"
+
+using namespace std;
+using namespace libgdtp;
+
+using namespace boost;
+using namespace boost::unit_test;
+
+#define PAYLOAD_SIZE_SHORT 10
+
+BOOST_AUTO_TEST_SUITE(TokenBucket_test)
+
+BOOST_AUTO_TEST_CASE(Bucket_test)
+{
+    // unlimited buckets never wait
+    TokenBucket unlimited;
+    unlimited.consume(1000000);
+    BOOST_CHECK(unlimited.get_wait_time(1000000) == 0);
+
+    TokenBucket bucket(10000, 100);
+    BOOST_CHECK(bucket.get_wait_time(100) == 0);
+    bucket.consume(100);
+    const uint32_t wait = bucket.get_wait_time(50);
+    BOOST_CHECK(wait > 0 && wait <= 5);
+
+    // oversized frames only need a full bucket
+    boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+    BOOST_CHECK(bucket.get_wait_time(1000) == 0);
+    BOOST_CHECK_CLOSE(bucket.get_tokens(), 100.0, 0.01);
+    bucket.consume(1000);
+    BOOST_CHECK(bucket.get_tokens() < 0);
+}
+
+
+BOOST_AUTO_TEST_CASE(Shaping_test)
+{
+    Gdtp prot;
+    prot.set_default_source_address(0);
+    prot.set_default_destination_address(1);
+    prot.set_codec_type("binary");
+    prot.initialize();
+
+    FlowProperties props;
+    props.set_transfer_mode(UNRELIABLE);
+    FlowId fast = prot.allocate_flow(1, props);
+
+    // the limited flow may send two SDUs at once, then one every 100ms
+    props.set_rate(100);
+    props.set_burst(2 * PAYLOAD_SIZE_SHORT);
+    FlowId slow = prot.allocate_flow(2, props);
+
+    for (int i = 0; i < 3; i++) {
+        prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, 1), fast);
+        prot.handle_data_from_above(make_shared<Data>(PAYLOAD_SIZE_SHORT, 2), slow);
+    }
+
+    // the scheduler never waits for the limited flow
+    int frames[3] = { 0, 0, 0 };
+    while (prot.has_data_for_below(DEFAULT_BELOW_PORT_ID)) {
+        Data frame;
+        prot.get_data_for_below(DEFAULT_BELOW_PORT_ID, frame);
+        prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+        frames[frame[0]]++; // binary frames start with the payload
+    }
+    BOOST_CHECK(frames[1] == 3);
+    BOOST_CHECK(frames[2] == 2);
+    BOOST_CHECK(prot.get_stats(slow).arq.tokens < PAYLOAD_SIZE_SHORT);
+
+    // the deferred SDU is released once enough tokens are available
+    boost::this_thread::sleep(boost::posix_time::milliseconds(150));
+    BOOST_REQUIRE(prot.has_data_for_below(DEFAULT_BELOW_PORT_ID) == true);
+    Data frame;
+    prot.get_data_for_below(DEFAULT_BELOW_PORT_ID, frame);
+    prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+    BOOST_CHECK(frame[0] == 2);
+    BOOST_CHECK(prot.has_data_for_below(DEFAULT_BELOW_PORT_ID) == false);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
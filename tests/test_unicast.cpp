@@ -25,6 +25,7 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/thread.hpp>
 #include "libgdtp.h"
+#include "exceptions.h"
 
 using namespace std;
 using namespace libgdtp;
@@ -113,4 +114,128 @@ BOOST_AUTO_TEST_CASE(unreliable_test)
     BOOST_CHECK(stats.arq.bytes_from_above == PAYLOAD_SIZE);
 }
 
+BOOST_AUTO_TEST_CASE(batch_receive_test)
+{
+    const int NUM_SDUS = 5;
+    FlowProperties props(UNRELIABLE);
+
+    Gdtp tx_prot;
+    tx_prot.set_default_source_address(1);
+    tx_prot.set_default_destination_address(2);
+    tx_prot.initialize();
+
+    Gdtp rx_prot;
+    rx_prot.set_default_source_address(2);
+    rx_prot.initialize();
+
+    FlowId id = tx_prot.allocate_flow(DEFAULT_ID, props);
+    rx_prot.allocate_flow(DEFAULT_ID, props);
+
+    for (int i = 0; i < NUM_SDUS; i++) {
+        std::shared_ptr<Data> sdu = make_shared<Data>(PAYLOAD_SIZE, i);
+        tx_prot.handle_data_from_above(sdu, id);
+    }
+
+    // pass all frames to the receiver
+    for (int i = 0; i < NUM_SDUS; i++) {
+        Data frame;
+        tx_prot.get_data_for_below(DEFAULT_BELOW_PORT_ID, frame);
+        rx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, frame);
+        tx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+    }
+
+    // drain the burst with a single call
+    std::vector<std::shared_ptr<Data> > sdus;
+    BOOST_CHECK(rx_prot.get_data_for_above_batch(DEFAULT_ID, sdus, 2 * NUM_SDUS) == NUM_SDUS);
+    BOOST_REQUIRE(sdus.size() == NUM_SDUS);
+    for (int i = 0; i < NUM_SDUS; i++) {
+        BOOST_CHECK(sdus[i]->size() == PAYLOAD_SIZE);
+        BOOST_CHECK(sdus[i]->at(0) == i);
+    }
+    BOOST_CHECK(rx_prot.has_data_for_above(DEFAULT_ID) == false);
+}
+
+BOOST_AUTO_TEST_CASE(batch_submit_test)
+{
+    // more SDUs than fit into the ARQ buffer, but not more than buffer and window together
+    const int NUM_SDUS = 15;
+    FlowProperties props(UNRELIABLE);
+    props.set_arq_type(GO_BACK_N);
+    props.set_window_size(8);
+
+    Gdtp tx_prot;
+    tx_prot.set_codec_type("binary");
+    tx_prot.set_default_source_address(1);
+    tx_prot.set_default_destination_address(2);
+    tx_prot.initialize();
+
+    Gdtp rx_prot;
+    rx_prot.set_codec_type("binary");
+    rx_prot.set_default_source_address(2);
+    rx_prot.initialize();
+
+    FlowId id = tx_prot.allocate_flow(DEFAULT_ID, props);
+    rx_prot.allocate_flow(DEFAULT_ID, props);
+
+    std::vector<std::shared_ptr<Data> > sdus;
+    for (int i = 0; i < NUM_SDUS; i++) {
+        sdus.push_back(make_shared<Data>(PAYLOAD_SIZE, i));
+    }
+    tx_prot.handle_data_from_above_batch(std::move(sdus), id);
+    BOOST_CHECK(sdus.empty());
+
+    for (int i = 0; i < NUM_SDUS; i++) {
+        Data frame;
+        tx_prot.get_data_for_below(DEFAULT_BELOW_PORT_ID, frame);
+        rx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, frame);
+        tx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+
+        // SDUs arrive in submission order
+        BOOST_REQUIRE(rx_prot.has_data_for_above(DEFAULT_ID));
+        BOOST_CHECK(rx_prot.get_data_for_above(DEFAULT_ID)->at(0) == i);
+    }
+    FlowStats stats = tx_prot.get_stats(id);
+    BOOST_CHECK(stats.arq.sdus_from_above == NUM_SDUS);
+    BOOST_CHECK(stats.arq.bytes_from_above == NUM_SDUS * PAYLOAD_SIZE);
+    BOOST_CHECK(stats.encoder.bytes_from_above == NUM_SDUS * PAYLOAD_SIZE);
+
+    // SDUs can't be sent on the inbound flow at the receiver
+    sdus.push_back(make_shared<Data>(PAYLOAD_SIZE, 0));
+    BOOST_CHECK_THROW(rx_prot.handle_data_from_above_batch(std::move(sdus), id), GdtpException);
+}
+
+BOOST_AUTO_TEST_CASE(zero_copy_receive_test)
+{
+    FlowProperties props(UNRELIABLE);
+
+    Gdtp tx_prot;
+    tx_prot.set_codec_type("binary");
+    tx_prot.set_default_source_address(1);
+    tx_prot.set_default_destination_address(2);
+    tx_prot.initialize();
+
+    Gdtp rx_prot;
+    rx_prot.set_codec_type("binary");
+    rx_prot.set_default_source_address(2);
+    rx_prot.initialize();
+
+    FlowId id = tx_prot.allocate_flow(DEFAULT_ID, props);
+    rx_prot.allocate_flow(DEFAULT_ID, props);
+
+    // send a jumbo SDU
+    std::shared_ptr<Data> sdu = make_shared<Data>(9000, 0xaa);
+    tx_prot.handle_data_from_above(sdu, id);
+
+    std::shared_ptr<Data> frame = make_shared<Data>();
+    tx_prot.get_data_for_below(DEFAULT_BELOW_PORT_ID, *frame);
+    tx_prot.set_data_transmitted(DEFAULT_BELOW_PORT_ID);
+    const uint8_t* frame_data = frame->data();
+
+    // hand over the received frame, the SDU has to be delivered without copying it
+    rx_prot.handle_data_from_below(DEFAULT_BELOW_PORT_ID, frame);
+    std::shared_ptr<Data> sdu_for_above = rx_prot.get_data_for_above(DEFAULT_ID);
+    BOOST_CHECK(sdu_for_above->data() == frame_data);
+    BOOST_CHECK(*sdu_for_above == *sdu);
+}
+
 BOOST_AUTO_TEST_SUITE_END()